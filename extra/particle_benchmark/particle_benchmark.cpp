@@ -0,0 +1,248 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Headless particle benchmark: loads .particles files, scales up the
+// particle counts and reports the time spent in ParticleSystem::update()
+// and in the vertex generation of the drawers, in ns per particle.
+// No window or OpenGL context is created, so systems using a
+// deform-drawer are skipped.
+
+#include <boost/shared_ptr.hpp>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <stdlib.h>
+#include <vector>
+
+#include "display/surface_manager.hpp"
+#include "math/random.hpp"
+#include "particles/particle_system.hpp"
+#include "particles/surface_drawer.hpp"
+#include "util/command_line.hpp"
+#include "util/directory.hpp"
+#include "util/file_reader.hpp"
+#include "util/pathname.hpp"
+#include "util/profiler.hpp"
+
+namespace {
+
+struct Timing
+{
+  Timing() :
+    update_ns(0),
+    update_particles(0),
+    draw_ns(0),
+    draw_particles(0)
+  {}
+
+  int64_t update_ns;
+  int64_t update_particles;
+  int64_t draw_ns;
+  int64_t draw_particles;
+
+  void add(const Timing& other)
+  {
+    update_ns        += other.update_ns;
+    update_particles += other.update_particles;
+    draw_ns          += other.draw_ns;
+    draw_particles   += other.draw_particles;
+  }
+};
+
+double ns_per_particle(int64_t ns, int64_t particles)
+{
+  if (particles == 0)
+    return 0.0;
+  else
+    return static_cast<double>(ns) / static_cast<double>(particles);
+}
+
+void print_timing(const std::string& name, const Timing& timing)
+{
+  std::cout << std::left << std::setw(32) << name << std::right
+            << "  update: " << std::fixed << std::setprecision(2) << std::setw(8)
+            << ns_per_particle(timing.update_ns, timing.update_particles) << " ns/particle"
+            << "  draw-prep: " << std::setw(8)
+            << ns_per_particle(timing.draw_ns, timing.draw_particles) << " ns/particle"
+            << std::endl;
+}
+
+bool uses_deform_drawer(const FileReader& reader)
+{
+  FileReader drawer_reader;
+  if (reader.get("drawer", drawer_reader))
+  {
+    std::vector<FileReader> sections = drawer_reader.get_sections();
+    return !sections.empty() && sections.front().get_name() == "deform-drawer";
+  }
+  else
+  {
+    return false;
+  }
+}
+
+Timing run_benchmark(const Pathname& filename, int scale, int frames)
+{
+  FileReader root_reader = FileReader::parse(filename);
+  if (root_reader.get_name() != "particle-systems")
+  {
+    std::ostringstream msg;
+    msg << "'" << filename << "' is not a particle-system file";
+    throw std::runtime_error(msg.str());
+  }
+
+  std::vector<boost::shared_ptr<ParticleSystem> > systems;
+  std::vector<FileReader> sections = root_reader.get_sections();
+  for(std::vector<FileReader>::iterator i = sections.begin(); i != sections.end(); ++i)
+  {
+    if (i->get_name() == "particle-system")
+    {
+      if (uses_deform_drawer(*i))
+      {
+        std::cout << filename << ": skipping particle-system with deform-drawer, requires OpenGL" << std::endl;
+      }
+      else
+      {
+        boost::shared_ptr<ParticleSystem> psys(new ParticleSystem(*i));
+        psys->set_count(psys->get_count() * scale);
+        systems.push_back(psys);
+      }
+    }
+  }
+
+  std::vector<float> vertices;
+  std::vector<float> texcoords;
+  std::vector<unsigned char> colors;
+
+  Timing timing;
+  const float delta = 1.0f / 120.0f;
+  for(int frame = 0; frame < frames; ++frame)
+  {
+    for(std::vector<boost::shared_ptr<ParticleSystem> >::iterator i = systems.begin(); i != systems.end(); ++i)
+    {
+      ParticleSystem& psys = **i;
+
+      int64_t start = Profiler::get_time();
+      psys.update(delta);
+      timing.update_ns        += Profiler::get_time() - start;
+      timing.update_particles += psys.get_count();
+
+      const SurfaceDrawer* drawer = dynamic_cast<const SurfaceDrawer*>(psys.get_drawer());
+      if (drawer)
+      {
+        const size_t num_vertices = static_cast<size_t>(psys.get_active_count() * 4);
+        vertices.resize(num_vertices * 3);
+        texcoords.resize(num_vertices * 2);
+        colors.resize(num_vertices * 4);
+
+        if (num_vertices > 0)
+        {
+          start = Profiler::get_time();
+          drawer->generate_quads(psys, &vertices[0], &texcoords[0], &colors[0]);
+          timing.draw_ns        += Profiler::get_time() - start;
+          timing.draw_particles += psys.get_active_count();
+        }
+      }
+    }
+  }
+
+  return timing;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    std::string datadir = "data/";
+    int scale  = 10;
+    int frames = 300;
+    std::vector<Pathname> files;
+
+    CommandLine argp;
+    argp.add_usage("[OPTION]... [FILE]...");
+    argp.add_doc("Runs the given particle systems headless and reports the time per particle, "
+                 "all files in particlesystems/ are used when no FILE is given.");
+
+    argp.add_option('d', "datadir", "DIR",  "Load game data from DIR (default: data/)");
+    argp.add_option('s', "scale",   "NUM",  "Multiply the particle counts by NUM (default: 10)");
+    argp.add_option('n', "frames",  "NUM",  "Run NUM frames (default: 300)");
+    argp.add_option('h', "help",    "",     "Show this help");
+
+    argp.parse_args(argc, argv);
+
+    while (argp.next())
+    {
+      switch (argp.get_key())
+      {
+        case 'd':
+          datadir = argp.get_argument();
+          break;
+
+        case 's':
+          scale = atoi(argp.get_argument().c_str());
+          break;
+
+        case 'n':
+          frames = atoi(argp.get_argument().c_str());
+          break;
+
+        case 'h':
+          argp.print_help();
+          return EXIT_SUCCESS;
+
+        case CommandLine::REST_ARG:
+          files.push_back(Pathname(argp.get_argument(), Pathname::kSysPath));
+          break;
+      }
+    }
+
+    Pathname::set_datadir(datadir);
+    SurfaceManager surface_manager(true);
+
+    // keep the spawn positions identical between runs
+    Random::set_seed(5489);
+
+    if (files.empty())
+    {
+      files = Directory::read(Pathname("particlesystems"), ".particles");
+    }
+
+    std::cout << "scale: " << scale << "  frames: " << frames << std::endl;
+
+    Timing total;
+    for(std::vector<Pathname>::iterator i = files.begin(); i != files.end(); ++i)
+    {
+      Timing timing = run_benchmark(*i, scale, frames);
+      print_timing(i->get_raw_path(), timing);
+      total.add(timing);
+    }
+    print_timing("total", total);
+
+    return EXIT_SUCCESS;
+  }
+  catch(std::exception& err)
+  {
+    std::cerr << "Error: " << err.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+/* EOF */
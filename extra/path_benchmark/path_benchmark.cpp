@@ -0,0 +1,305 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Compares the HierarchicalPathFinder against the plain A* of the
+// PathFinder on a generated grid graph with random holes. Reports the
+// time per query for both and how much longer the hierarchical routes
+// are, the exit status is non-zero when the two disagree on whether a
+// path exists or a hierarchical route is cheaper than the A* one,
+// which A* being optimal rules out. Afterwards nodes are moved one at
+// a time to time the incremental update, the updated hierarchy has to
+// give the same routes as one built from scratch.
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "math/random.hpp"
+#include "navigation/edge_position.hpp"
+#include "navigation/hierarchical_path_finder.hpp"
+#include "navigation/navigation_graph.hpp"
+#include "navigation/node.hpp"
+#include "navigation/path_finder.hpp"
+#include "util/command_line.hpp"
+#include "util/profiler.hpp"
+
+namespace {
+
+const float kSpacing = 64.0f;
+
+/** Builds a \a size x \a size grid, each edge is left out with
+    probability \a holes, returns the node positions */
+std::vector<Vector2f> generate_graph(NavigationGraph& graph, int size, float holes, Random& random,
+                                     std::vector<NodeHandle>& nodes)
+{
+  std::vector<Vector2f> positions;
+  nodes.reserve(static_cast<size_t>(size * size));
+  for(int y = 0; y < size; ++y)
+  {
+    for(int x = 0; x < size; ++x)
+    {
+      // a bit of jitter, so that there are few ties between routes
+      Vector2f pos(static_cast<float>(x) * kSpacing + random.frand(-16.0f, 16.0f),
+                   static_cast<float>(y) * kSpacing + random.frand(-16.0f, 16.0f));
+      nodes.push_back(graph.add_node(pos));
+      positions.push_back(pos);
+    }
+  }
+
+  for(int y = 0; y < size; ++y)
+  {
+    for(int x = 0; x < size; ++x)
+    {
+      const size_t i = static_cast<size_t>(y * size + x);
+      if (x + 1 < size && random.frand() >= holes)
+        graph.add_edge(nodes[i], nodes[i + 1]);
+      if (y + 1 < size && random.frand() >= holes)
+        graph.add_edge(nodes[i], nodes[i + static_cast<size_t>(size)]);
+    }
+  }
+
+  return positions;
+}
+
+double us_per_query(int64_t ns, size_t queries)
+{
+  if (queries == 0)
+    return 0.0;
+  else
+    return static_cast<double>(ns) / 1000.0 / static_cast<double>(queries);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    int   size        = 128;
+    int   num_queries = 1000;
+    float region_size = 1024.0f;
+    float holes       = 0.2f;
+    int   cache_size  = 256;
+    int   num_moves   = 100;
+
+    CommandLine argp;
+    argp.add_usage("[OPTION]...");
+    argp.add_doc("Runs random path queries on a generated grid graph with the PathFinder and "
+                 "the HierarchicalPathFinder and compares their time and route cost.");
+
+    argp.add_option('s', "size",    "NUM",  "Use a grid of NUM x NUM nodes (default: 128)");
+    argp.add_option('n', "queries", "NUM",  "Run NUM queries (default: 1000)");
+    argp.add_option('r', "region",  "SIZE", "Use regions of SIZE x SIZE units (default: 1024)");
+    argp.add_option('o', "holes",   "FRAC", "Leave out FRAC of the edges (default: 0.2)");
+    argp.add_option('c', "cache",   "NUM",  "Remember NUM routes between regions (default: 256)");
+    argp.add_option('m', "moves",   "NUM",  "Move NUM nodes to time the updates (default: 100)");
+    argp.add_option('h', "help",    "",     "Show this help");
+
+    argp.parse_args(argc, argv);
+
+    while (argp.next())
+    {
+      switch (argp.get_key())
+      {
+        case 's':
+          size = atoi(argp.get_argument().c_str());
+          break;
+
+        case 'n':
+          num_queries = atoi(argp.get_argument().c_str());
+          break;
+
+        case 'r':
+          region_size = static_cast<float>(atof(argp.get_argument().c_str()));
+          break;
+
+        case 'o':
+          holes = static_cast<float>(atof(argp.get_argument().c_str()));
+          break;
+
+        case 'c':
+          cache_size = atoi(argp.get_argument().c_str());
+          break;
+
+        case 'm':
+          num_moves = atoi(argp.get_argument().c_str());
+          break;
+
+        case 'h':
+          argp.print_help();
+          return EXIT_SUCCESS;
+      }
+    }
+
+    // keep the graph and the queries identical between runs
+    Random random(5489UL);
+
+    NavigationGraph graph;
+    std::vector<NodeHandle> nodes;
+    std::vector<Vector2f> positions = generate_graph(graph, size, holes, random, nodes);
+
+    PathCost cost;
+
+    // snapped once, so that only the searches get timed
+    std::vector<std::pair<EdgePosition, EdgePosition> > queries;
+    for(int i = 0; i < num_queries; ++i)
+    {
+      const Vector2f& from = positions[static_cast<size_t>(random.rand(static_cast<long>(positions.size()) - 1))];
+      const Vector2f& to   = positions[static_cast<size_t>(random.rand(static_cast<long>(positions.size()) - 1))];
+      queries.push_back(std::make_pair(graph.find_closest_position(from, cost.snap_radius),
+                                       graph.find_closest_position(to,   cost.snap_radius)));
+    }
+
+    PathFinder path_finder(graph);
+    HierarchicalPathFinder hierarchical_path_finder(graph, cost, region_size,
+                                                    static_cast<unsigned int>(cache_size));
+
+    int64_t start = Profiler::get_time();
+    path_finder.update();
+    const int64_t flat_build_ns = Profiler::get_time() - start;
+
+    start = Profiler::get_time();
+    hierarchical_path_finder.update();
+    const int64_t hierarchy_build_ns = Profiler::get_time() - start;
+
+    std::vector<Path> flat_paths(queries.size());
+    std::vector<bool> flat_found(queries.size());
+    start = Profiler::get_time();
+    for(size_t i = 0; i < queries.size(); ++i)
+    {
+      flat_found[i] = path_finder.find_path(queries[i].first, queries[i].second, cost, flat_paths[i]);
+    }
+    const int64_t flat_ns = Profiler::get_time() - start;
+
+    // the second pass repeats the queries, so that the routes come
+    // from the cache
+    int64_t hierarchical_ns[2] = { 0, 0 };
+    int errors = 0;
+    int optimal = 0;
+    int found = 0;
+    double detour_sum = 0.0;
+    double detour_max = 0.0;
+    for(int pass = 0; pass < 2; ++pass)
+    {
+      Path path;
+      for(size_t i = 0; i < queries.size(); ++i)
+      {
+        start = Profiler::get_time();
+        const bool ok = hierarchical_path_finder.find_path(queries[i].first, queries[i].second, path);
+        hierarchical_ns[pass] += Profiler::get_time() - start;
+
+        if (ok != flat_found[i])
+        {
+          std::cout << "query " << i << ": A* " << (flat_found[i] ? "found" : "found no")
+                    << " path, hierarchical search " << (ok ? "found" : "found no") << " path" << std::endl;
+          errors += 1;
+        }
+        else if (ok && pass == 0)
+        {
+          const double flat_cost = flat_paths[i].cost;
+          const double detour = flat_cost > 0.0 ? path.cost / flat_cost - 1.0 : 0.0;
+          if (detour < -1.0e-4)
+          {
+            std::cout << "query " << i << ": hierarchical route costs " << path.cost
+                      << ", less than the A* route with " << flat_cost << std::endl;
+            errors += 1;
+          }
+
+          found += 1;
+          if (detour <= 1.0e-4)
+            optimal += 1;
+          detour_sum += std::max(0.0, detour);
+          detour_max  = std::max(detour_max, detour);
+        }
+      }
+    }
+
+    const RouteCacheStats stats = hierarchical_path_finder.get_cache_stats();
+
+    // move nodes by up to a quarter of the spacing, some end up in
+    // another region
+    int64_t update_ns = 0;
+    for(int i = 0; i < num_moves; ++i)
+    {
+      NodeHandle node = nodes[static_cast<size_t>(random.rand(static_cast<long>(nodes.size()) - 1))];
+      graph.move_node(node, node->get_pos() + Vector2f(random.frand(-16.0f, 16.0f),
+                                                       random.frand(-16.0f, 16.0f)));
+
+      start = Profiler::get_time();
+      hierarchical_path_finder.update();
+      update_ns += Profiler::get_time() - start;
+    }
+
+    if (num_moves > 0)
+    {
+      // with the same cache, both see the same cached routes
+      HierarchicalPathFinder rebuilt_path_finder(graph, cost, region_size,
+                                                 static_cast<unsigned int>(cache_size));
+      Path path;
+      Path rebuilt_path;
+      for(size_t i = 0; i < queries.size(); ++i)
+      {
+        const bool ok = hierarchical_path_finder.find_path(queries[i].first, queries[i].second, path);
+        const bool rebuilt_ok = rebuilt_path_finder.find_path(queries[i].first, queries[i].second, rebuilt_path);
+        if (ok != rebuilt_ok || (ok && fabsf(path.cost - rebuilt_path.cost) > 1.0e-3f * rebuilt_path.cost))
+        {
+          std::cout << "query " << i << ": updated hierarchy gives a different route than a rebuilt one" << std::endl;
+          errors += 1;
+        }
+      }
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "graph:         " << graph.get_nodes().size() << " nodes, "
+              << graph.get_edges().size() << " edges, "
+              << hierarchical_path_finder.get_num_regions() << " regions, "
+              << hierarchical_path_finder.get_num_portals() << " portals" << std::endl
+              << "build:         A* " << static_cast<double>(flat_build_ns) / 1.0e6 << " ms, "
+              << "hierarchy " << static_cast<double>(hierarchy_build_ns) / 1.0e6 << " ms, "
+              << "update " << us_per_query(update_ns, static_cast<size_t>(std::max(num_moves, 0)))
+              << " us/move" << std::endl
+              << "A*:            " << us_per_query(flat_ns, queries.size()) << " us/query" << std::endl
+              << "hierarchical:  " << us_per_query(hierarchical_ns[0], queries.size()) << " us/query, "
+              << us_per_query(hierarchical_ns[1], queries.size()) << " us/query cached "
+              << "(" << stats.hits << " hits, " << stats.misses << " misses)" << std::endl
+              << "routes:        " << optimal << " of " << found << " optimal, detour "
+              << 100.0 * (found ? detour_sum / found : 0.0) << "% average, "
+              << 100.0 * detour_max << "% max" << std::endl;
+
+    if (errors)
+    {
+      std::cout << errors << " queries failed" << std::endl;
+      return EXIT_FAILURE;
+    }
+    else
+    {
+      return EXIT_SUCCESS;
+    }
+  }
+  catch(std::exception& err)
+  {
+    std::cerr << "Error: " << err.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+/* EOF */
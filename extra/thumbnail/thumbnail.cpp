@@ -0,0 +1,238 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Renders a contact sheet of images without a window or OpenGL
+// context: the images are loaded through a headless SurfaceManager and
+// drawn with the software Compositor backend. With --golden the result
+// is compared against a previously saved sheet, which makes the tool
+// usable as a regression test for the software rasterizer.
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "display/compositor.hpp"
+#include "display/graphic_context_state.hpp"
+#include "display/scene_context.hpp"
+#include "display/software_surface.hpp"
+#include "display/surface.hpp"
+#include "display/surface_drawing_parameters.hpp"
+#include "display/surface_manager.hpp"
+#include "display/texture_manager.hpp"
+#include "math/size.hpp"
+#include "util/command_line.hpp"
+#include "util/directory.hpp"
+#include "util/job_system.hpp"
+#include "util/pathname.hpp"
+
+namespace {
+
+void draw_sheet(DrawingContext& dc, const std::vector<Pathname>& files, int cell_size, int columns)
+{
+  const float cell = static_cast<float>(cell_size);
+
+  for(size_t i = 0; i < files.size(); ++i)
+  {
+    SurfacePtr surface = Surface::create(files[i]);
+
+    const float width  = surface->get_width();
+    const float height = surface->get_height();
+    const float scale  = std::min(1.0f, cell / std::max(width, height));
+
+    const int column = static_cast<int>(i) % columns;
+    const int row    = static_cast<int>(i) / columns;
+
+    // center the scaled image in its cell
+    const Vector2f pos(static_cast<float>(column) * cell + (cell - width  * scale) / 2.0f,
+                       static_cast<float>(row)    * cell + (cell - height * scale) / 2.0f);
+
+    dc.draw(surface, SurfaceDrawingParameters().set_pos(pos).set_scale(scale));
+  }
+}
+
+/** Returns the number of pixels that differ by more than \a tolerance
+    in any of the color channels */
+int compare(const SoftwareSurface& result, const SoftwareSurface& golden, int tolerance)
+{
+  if (result.get_width() != golden.get_width() ||
+      result.get_height() != golden.get_height())
+  {
+    std::ostringstream msg;
+    msg << "golden image is " << golden.get_width() << "x" << golden.get_height()
+        << ", the result is " << result.get_width() << "x" << result.get_height();
+    throw std::runtime_error(msg.str());
+  }
+
+  const int result_bpp = result.get_bytes_per_pixel();
+  const int golden_bpp = golden.get_bytes_per_pixel();
+
+  int mismatches = 0;
+  for(int y = 0; y < result.get_height(); ++y)
+  {
+    const uint8_t* result_row = static_cast<const uint8_t*>(result.get_pixels()) + y * result.get_pitch();
+    const uint8_t* golden_row = static_cast<const uint8_t*>(golden.get_pixels()) + y * golden.get_pitch();
+
+    for(int x = 0; x < result.get_width(); ++x)
+    {
+      for(int c = 0; c < 3; ++c)
+      {
+        if (abs(result_row[x * result_bpp + c] - golden_row[x * golden_bpp + c]) > tolerance)
+        {
+          mismatches += 1;
+          break;
+        }
+      }
+    }
+  }
+
+  return mismatches;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    std::string datadir = "data/";
+    std::string output  = "thumbnail.png";
+    std::string golden;
+    int cell_size = 128;
+    int columns   = 8;
+    int tolerance = 2;
+    std::vector<Pathname> files;
+
+    CommandLine argp;
+    argp.add_usage("[OPTION]... [FILE]...");
+    argp.add_doc("Renders the given images into a contact sheet with the software compositor, "
+                 "all images in images/ are used when no FILE is given.");
+
+    argp.add_option('d', "datadir",   "DIR",  "Load game data from DIR (default: data/)");
+    argp.add_option('o', "output",    "FILE", "Save the sheet to FILE (default: thumbnail.png)");
+    argp.add_option('s', "size",      "NUM",  "Fit each image into NUM x NUM pixels (default: 128)");
+    argp.add_option('c', "columns",   "NUM",  "Place NUM images in a row (default: 8)");
+    argp.add_option('g', "golden",    "FILE", "Compare the sheet against FILE, fail when they differ");
+    argp.add_option('t', "tolerance", "NUM",  "Accept color differences up to NUM (default: 2)");
+    argp.add_option('h', "help",      "",     "Show this help");
+
+    argp.parse_args(argc, argv);
+
+    while (argp.next())
+    {
+      switch (argp.get_key())
+      {
+        case 'd':
+          datadir = argp.get_argument();
+          break;
+
+        case 'o':
+          output = argp.get_argument();
+          break;
+
+        case 's':
+          cell_size = atoi(argp.get_argument().c_str());
+          break;
+
+        case 'c':
+          columns = atoi(argp.get_argument().c_str());
+          break;
+
+        case 'g':
+          golden = argp.get_argument();
+          break;
+
+        case 't':
+          tolerance = atoi(argp.get_argument().c_str());
+          break;
+
+        case 'h':
+          argp.print_help();
+          return EXIT_SUCCESS;
+
+        case CommandLine::REST_ARG:
+          files.push_back(Pathname(argp.get_argument(), Pathname::kSysPath));
+          break;
+      }
+    }
+
+    if (cell_size <= 0 || columns <= 0)
+    {
+      throw std::runtime_error("size and columns must be greater than zero");
+    }
+
+    Pathname::set_datadir(datadir);
+    SurfaceManager surface_manager(true);
+    TextureManager texture_manager(true);
+    JobSystem job_system;
+
+    if (files.empty())
+    {
+      files = Directory::read(Pathname("images"), ".png");
+      std::sort(files.begin(), files.end());
+    }
+
+    if (files.empty())
+    {
+      throw std::runtime_error("no images given");
+    }
+
+    const int rows = (static_cast<int>(files.size()) + columns - 1) / columns;
+    const Size size(std::min(columns, static_cast<int>(files.size())) * cell_size, rows * cell_size);
+
+    Compositor compositor(size, size, Compositor::kSoftware);
+    GraphicContextState state(size.width, size.height);
+    SceneContext sc;
+    sc.set_render_mask(SceneContext::COLORMAP);
+
+    draw_sheet(sc.color(), files, cell_size, columns);
+    compositor.render(sc, 0, state);
+
+    SoftwareSurfacePtr result = compositor.get_software_surface();
+    result->save_png(output);
+    std::cout << output << ": " << files.size() << " images, "
+              << size.width << "x" << size.height << std::endl;
+
+    if (!golden.empty())
+    {
+      SoftwareSurfacePtr golden_surface = SoftwareSurface::create(Pathname(golden, Pathname::kSysPath));
+      const int mismatches = compare(*result, *golden_surface, tolerance);
+      if (mismatches)
+      {
+        std::cout << mismatches << " pixels differ from " << golden << std::endl;
+        return EXIT_FAILURE;
+      }
+      else
+      {
+        std::cout << "matches " << golden << std::endl;
+      }
+    }
+
+    return EXIT_SUCCESS;
+  }
+  catch(std::exception& err)
+  {
+    std::cerr << "Error: " << err.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+/* EOF */
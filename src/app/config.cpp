@@ -39,6 +39,13 @@ Config::Config()
   add(new ConfigValue<int> ("anti-aliasing",  _("Use NUMx Anti-Aliasing"), true, 0));
   add(new ConfigValue<bool>("fullscreen",     _("Use fullscreen"),         true, false));
   add(new ConfigValue<bool>("show-fps",       _("Show frames per second"), true, true));
+  add(new ConfigValue<bool>("show-profiler",  _("Show the frame profiler overlay"), false, false));
+
+  add(new ConfigValue<int>("update-rate",      _("Number of simulation steps per second"), true, 120));
+  add(new ConfigValue<int>("max-update-steps", _("Maximum number of simulation steps per frame"), true, 8));
+  add(new ConfigValue<bool>("vsync",           _("Synchronize with the vertical retrace"), true, false));
+  add(new ConfigValue<int>("worker-threads",   _("Number of threads updating objects in parallel, -1 for one per CPU"), true, -1));
+  add(new ConfigValue<int>("max-fps",          _("Limit the number of frames per second, 0 for no limit"), true, 60));
 
   add(new ConfigValue<bool>("music",          _("Enable Music"), true, true));
   add(new ConfigValue<bool>("sound",          _("Enable Sound"), true, true));
@@ -59,6 +66,7 @@ Config::Config()
 
   add(new ConfigValue<std::string>("recorder-file",   _("File to which demos are recorded"), false));
   add(new ConfigValue<std::string>("playback-file",   _("File from which a demo is played"), false));
+  add(new ConfigValue<int>("random-seed",     _("Seed of the random number generators"), false, 5489));
 
   add(new ConfigValue<int>("master-volume",  _("Master Volume"), true, 100));
   add(new ConfigValue<int>("music-volume",   _("Music Volume"),  true, 100));
@@ -66,6 +74,12 @@ Config::Config()
   add(new ConfigValue<int>("voice-volume",   _("Voice Volume"),  true, 100));
 
   add(new ConfigValue<bool>("wiimote", _("Try to connect to Wiimote on startup"), true, false));
+
+  add(new ConfigValue<bool>("image-cache", _("Keep decoded images in the user directory for faster loading"), true, true));
+  add(new ConfigValue<bool>("data-cache", _("Keep parsed data files in the user directory for faster loading"), true, true));
+  add(new ConfigValue<int>("texture-cache-size", _("Memory budget for unused textures in MiB"), true, 256));
+  add(new ConfigValue<int>("surface-cache-size", _("Memory budget for unused surfaces in MiB"), true, 256));
+  add(new ConfigValue<int>("framebuffer-pool-size", _("Memory budget for unused render targets in MiB"), true, 64));
 }
 
 Config::~Config()
@@ -139,6 +153,7 @@ Config::parse_args(int argc, char** argv)
   CommandLine argp;
 
   const int secondary_controller_file = 261;
+  const int random_seed = 262;
     
   argp.set_help_indent(24);
   argp.add_usage ("[LEVELFILE]");
@@ -171,6 +186,7 @@ Config::parse_args(int argc, char** argv)
   argp.add_option('r', "record",      "FILE", "Record input events to FILE");
   //argp.add_option('x', "record-video","DIR",  "Record a gameplay video to DIR");
   argp.add_option('p', "play",        "FILE", "Playback input events from FILE");
+  argp.add_option(random_seed, "seed", "NUM", "Seed the random number generators with NUM");
 
   argp.parse_args(argc, argv);
 
@@ -198,6 +214,20 @@ Config::parse_args(int argc, char** argv)
         get<std::string>("screenshot-dir") = argp.get_argument();
         break;
 
+      case random_seed:
+      {
+        int seed;
+        if (sscanf(argp.get_argument().c_str(), "%d", &seed) != 1)
+        {
+          throw std::runtime_error("Seed option '--seed' requires argument of type {NUM}");
+        }
+        else
+        {
+          get<int>("random-seed") = seed;
+        }
+      }
+      break;
+
       case 'p':
         get<std::string>("playback-file") = argp.get_argument();
         break;
@@ -388,6 +418,7 @@ Config::save()
     
     writer.end_list("windstille-config");
     writer.write_comment(";; EOF ;;");
+    writer.commit();
   } catch(std::exception& e) {
     std::cerr << "Couldn't write config file: " << e.what() << "\n";
   }
@@ -17,17 +17,21 @@
 */
 
 #include <SDL_image.h>
+#include <algorithm>
 #include <sstream>
 #include <boost/filesystem.hpp>
 
 #include "app/config.hpp"
 #include "app/console.hpp"
+#include "display/framebuffer_pool.hpp"
 #include "display/opengl_window.hpp"
+#include "display/software_surface_cache.hpp"
 #include "display/surface_manager.hpp"
 #include "display/texture_manager.hpp"
 #include "engine/script_manager.hpp"
 #include "font/fonts.hpp"
 #include "input/input_manager_sdl.hpp"
+#include "math/random.hpp"
 #include "screen/game_session.hpp"
 #include "screen/particle_viewer.hpp"
 #include "screen/screen_manager.hpp"
@@ -37,6 +41,8 @@
 #include "sound/sound_manager.hpp"
 #include "sprite3d/manager.hpp"
 #include "tile/tile_factory.hpp"
+#include "util/job_system.hpp"
+#include "util/sexpr_cache.hpp"
 #include "util/system.hpp"
 #include "app/windstille_main.hpp"
 
@@ -64,20 +70,30 @@ WindstilleMain::main(int argc, char** argv)
     
     config.parse_args(argc, argv);
 
+    SoftwareSurfaceCache::set_enabled(config.get_bool("image-cache"));
+    SExprCache::set_enabled(config.get_bool("data-cache"));
+
     {
       OpenGLWindow      window("Windstille",
                                Size(config.get_int("screen-width"), config.get_int("screen-height")),
                                Size(config.get_int("aspect-width"), config.get_int("aspect-height")),
                                config.get_bool("fullscreen"), config.get_int("anti-aliasing"));
+      if (config.get_bool("vsync") && !window.set_vsync(true))
+      {
+        std::cout << "Warning: vsync not supported" << std::endl;
+      }
+
       TTFFontManager    ttffont_manager;
       Fonts             fonts;
       Console           console;
       SoundManager      sound_manager;
       TextureManager    texture_manager;
       SurfaceManager    surface_manager;
+      FramebufferPool   framebuffer_pool;
       SpriteManager     sprite_manager;
       sprite3d::Manager sprite3d_manager;
       ScriptManager     script_manager;
+      JobSystem         job_system(config.get_int("worker-threads"));
       WindstilleControllerDescription controller_description;
       InputManagerSDL   input_manager(controller_description);
       ScreenManager     screen_manager;
@@ -149,6 +165,16 @@ WindstilleMain::run()
 void
 WindstilleMain::init_modules()
 {
+  Random::set_seed(static_cast<uint64_t>(static_cast<unsigned int>(config.get_int("random-seed"))));
+
+  TextureManager::current()->set_memory_budget(static_cast<size_t>(config.get_int("texture-cache-size")) * 1024 * 1024);
+  SurfaceManager::current()->set_memory_budget(static_cast<size_t>(config.get_int("surface-cache-size")) * 1024 * 1024);
+  FramebufferPool::current()->set_idle_budget(static_cast<size_t>(config.get_int("framebuffer-pool-size")) * 1024 * 1024);
+
+  ScreenManager::current()->set_update_rate(static_cast<float>(std::max(1, config.get_int("update-rate"))));
+  ScreenManager::current()->set_max_update_steps(config.get_int("max-update-steps"));
+  ScreenManager::current()->get_frame_pacer().set_max_fps(config.get_int("max-fps"));
+
   SoundManager::current()->set_gain(static_cast<float>(config.get_int("master-volume"))/100.0f);
   SoundManager::current()->enable_sound(config.get_bool("sound"));
   SoundManager::current()->enable_music(config.get_bool("music"));
@@ -20,6 +20,7 @@
 #include "collision/collision_test.hpp"
 #include "collision/collision_engine.hpp"
 #include "tile/tile_map.hpp"
+#include "util/profiler.hpp"
 
 std::vector<Rectf> tilemap_collision_list(TileMap *tilemap, const Rectf &r, bool is_ground);
 
@@ -284,6 +285,8 @@ CollisionEngine::unstuck_rect_rect(CollisionObject& a, CollisionObject& b, float
 void
 CollisionEngine::update(float delta)
 {
+  ProfileScope profile_scope("CollisionEngine::update");
+
   if (objects.empty())
     return; 
 
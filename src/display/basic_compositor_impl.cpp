@@ -25,6 +25,7 @@
 #include "display/opengl_state.hpp"
 #include "display/scene_context.hpp"
 #include "scenegraph/scene_graph.hpp"
+#include "util/profiler.hpp"
 
 static const int LIGHTMAP_DIV = 4;
 
@@ -38,6 +39,8 @@ BasicCompositorImpl::BasicCompositorImpl(const Size& window, const Size& viewpor
 void
 BasicCompositorImpl::render(SceneContext& sc, SceneGraph* sg, const GraphicContextState& gc_state)
 {
+  ProfileScope profile_scope("Compositor::render");
+
   // Resize Lightmap, only needed in the editor, FIXME: move this into a 'set_size()' call
   if (m_lightmap->get_width()  != m_window.width /LIGHTMAP_DIV ||
       m_lightmap->get_height() != m_window.height/LIGHTMAP_DIV)
@@ -47,6 +50,7 @@ BasicCompositorImpl::render(SceneContext& sc, SceneGraph* sg, const GraphicConte
 
   if (sc.get_render_mask() & SceneContext::LIGHTMAPSCREEN)
   {
+    ProfileScope pass_scope("Compositor::lightmap");
     // Render the lightmap to the framebuffers->lightmap
     glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -83,6 +87,7 @@ BasicCompositorImpl::render(SceneContext& sc, SceneGraph* sg, const GraphicConte
 
   if (sc.get_render_mask() & SceneContext::COLORMAP)
   {
+    ProfileScope pass_scope("Compositor::colormap");
     // Render the colormap to the framebuffers->screen
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -100,6 +105,7 @@ BasicCompositorImpl::render(SceneContext& sc, SceneGraph* sg, const GraphicConte
 
   if (sc.get_render_mask() & SceneContext::LIGHTMAP)
   { // Renders the lightmap to the screen     
+    ProfileScope pass_scope("Compositor::lightmap multiply");
     OpenGLState state;
 
     state.bind_texture(m_lightmap->get_texture());
@@ -127,6 +133,7 @@ BasicCompositorImpl::render(SceneContext& sc, SceneGraph* sg, const GraphicConte
 
   if (sc.get_render_mask() & SceneContext::HIGHLIGHTMAP)
   {
+    ProfileScope pass_scope("Compositor::highlightmap");
     sc.highlight().render();
 
     if (sg)
@@ -140,6 +147,7 @@ BasicCompositorImpl::render(SceneContext& sc, SceneGraph* sg, const GraphicConte
 
   if (sc.get_render_mask() & SceneContext::CONTROLMAP)
   {
+    ProfileScope pass_scope("Compositor::controlmap");
     sc.control().render();
 
     if (sg)
@@ -22,13 +22,18 @@
 
 #include "display/framebuffer_compositor_impl.hpp"
 #include "display/basic_compositor_impl.hpp"
+#include "display/software_compositor_impl.hpp"
 
 #pragma GCC diagnostic ignored "-Wold-style-cast"
 
-Compositor::Compositor(const Size& window, const Size& viewport) :
+Compositor::Compositor(const Size& window, const Size& viewport, Backend backend) :
   impl()
 {
-  if (GLEW_ARB_framebuffer_object)
+  if (backend == kSoftware)
+  {
+    impl.reset(new SoftwareCompositorImpl(window, viewport));
+  }
+  else if (GLEW_ARB_framebuffer_object)
   {
     std::cout  << "Display:: framebuffer_object extension is supported" << std::endl;
     impl.reset(new FramebufferCompositorImpl(window, viewport));
@@ -50,4 +55,10 @@ Compositor::render(SceneContext& sc, SceneGraph* sg, const GraphicContextState&
   impl->render(sc, sg, state);
 }
 
+SoftwareSurfacePtr
+Compositor::get_software_surface() const
+{
+  return impl->get_software_surface();
+}
+
 /* EOF */
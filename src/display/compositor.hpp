@@ -21,6 +21,8 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "display/software_surface.hpp"
+
 class CompositorImpl;
 class GraphicContextState;
 class SceneContext;
@@ -30,11 +32,26 @@ class Size;
 class Compositor
 {
 public:
-  Compositor(const Size& window, const Size& viewport);
+  enum Backend {
+    /** render to the screen, with framebuffer objects when available */
+    kOpenGL,
+
+    /** render on the CPU into a SoftwareSurface, see
+        get_software_surface(), works without an OpenGL context when
+        the surfaces come from a headless SurfaceManager */
+    kSoftware
+  };
+
+public:
+  Compositor(const Size& window, const Size& viewport, Backend backend = kOpenGL);
   ~Compositor();
 
   void render(SceneContext& sc, SceneGraph* sg, const GraphicContextState& state);
 
+  /** Returns the result of the last render() for the kSoftware
+      backend, an empty pointer for kOpenGL */
+  SoftwareSurfacePtr get_software_surface() const;
+
 private:
   boost::scoped_ptr<CompositorImpl> impl;
 };
@@ -19,6 +19,7 @@
 #ifndef HEADER_WINDSTILLE_DISPLAY_COMPOSITOR_IMPL_HPP
 #define HEADER_WINDSTILLE_DISPLAY_COMPOSITOR_IMPL_HPP
 
+#include "display/software_surface.hpp"
 #include "math/size.hpp"
 
 class SceneContext;
@@ -41,6 +42,10 @@ public:
   {}
 
   virtual void render(SceneContext& sc, SceneGraph* sg, const GraphicContextState& state) =0;
+
+  /** Returns the rendered image for compositors that don't render to
+      the screen, an empty pointer otherwise */
+  virtual SoftwareSurfacePtr get_software_surface() const { return SoftwareSurfacePtr(); }
 };
 
 #endif
@@ -31,6 +31,7 @@
 #include "math/vector3.hpp"
 #include "math/line.hpp"
 #include "sprite2d/sprite.hpp"
+#include "util/profiler.hpp"
 
 #include "scenegraph/control_drawable.hpp"
 #include "scenegraph/fill_screen_drawable.hpp"
@@ -63,6 +64,8 @@ DrawingContext::~DrawingContext()
 void
 DrawingContext::render()
 {
+  ProfileScope profile_scope("DrawingContext::render");
+
   std::stable_sort(drawingrequests.begin(), drawingrequests.end(), DrawablesSorter());
   
   for(Drawables::iterator i = drawingrequests.begin(); i != drawingrequests.end(); ++i)
@@ -71,6 +74,17 @@ DrawingContext::render()
   }
 }
 
+void
+DrawingContext::rasterize(SoftwareRasterizer& rasterizer)
+{
+  std::stable_sort(drawingrequests.begin(), drawingrequests.end(), DrawablesSorter());
+  
+  for(Drawables::iterator i = drawingrequests.begin(); i != drawingrequests.end(); ++i)
+  {
+    (*i)->rasterize(rasterizer, ~0u);
+  }
+}
+
 void
 DrawingContext::clear()
 {
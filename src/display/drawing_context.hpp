@@ -34,6 +34,7 @@ class Quad;
 class Line;
 class Color;
 class Compositor;
+class SoftwareRasterizer;
 
 /** The DrawingContext collects all Drawables and allows you to
     flush them all down to the graphics card in one run, this has the
@@ -56,6 +57,10 @@ public:
   /** Draws everything in the drawing context to the screen */
   void render();
 
+  /** Draws everything in the drawing context with the software
+      rasterizer, skipping Drawables that don't support it */
+  void rasterize(SoftwareRasterizer& rasterizer);
+
   /** Empties the drawing context */
   void clear();
 
@@ -21,17 +21,19 @@
 #include <glm/ext.hpp>
 
 #include "display/display.hpp"
+#include "display/framebuffer_pool.hpp"
 #include "display/graphic_context_state.hpp"
 #include "display/opengl_state.hpp"
 #include "display/scene_context.hpp"
 #include "scenegraph/scene_graph.hpp"
+#include "util/profiler.hpp"
 
 static const int LIGHTMAP_DIV = 4;
 
 FramebufferCompositorImpl::FramebufferCompositorImpl(const Size& window, const Size& viewport) :
   CompositorImpl(window, viewport),
-  m_screen  (Framebuffer::create_with_texture(GL_TEXTURE_2D, window.width, window.height)),
-  m_lightmap(Framebuffer::create_with_texture(GL_TEXTURE_2D, window.width / LIGHTMAP_DIV, window.height / LIGHTMAP_DIV))
+  m_screen  (FramebufferPool::current()->get(FramebufferPool::kTexture, window)),
+  m_lightmap(FramebufferPool::current()->get(FramebufferPool::kTexture, Size(window.width / LIGHTMAP_DIV, window.height / LIGHTMAP_DIV)))
 {
 }
 
@@ -66,8 +68,11 @@ FramebufferCompositorImpl::render_lightmap(SceneContext& /*sc*/, SceneGraph* /*s
 void
 FramebufferCompositorImpl::render(SceneContext& sc, SceneGraph* sg, const GraphicContextState& gc_state)
 {
+  ProfileScope profile_scope("Compositor::render");
+
   if (sc.get_render_mask() & SceneContext::LIGHTMAPSCREEN)
   {
+    ProfileScope pass_scope("Compositor::lightmap");
     // Render the lightmap to framebuffers->lightmap
     Display::push_framebuffer(m_lightmap);
 
@@ -98,6 +103,7 @@ FramebufferCompositorImpl::render(SceneContext& sc, SceneGraph* sg, const Graphi
 
     if (sc.get_render_mask() & SceneContext::COLORMAP)
     {
+      ProfileScope pass_scope("Compositor::colormap");
       // Render the colormap to framebuffers->screen
       glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
       glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -115,11 +121,13 @@ FramebufferCompositorImpl::render(SceneContext& sc, SceneGraph* sg, const Graphi
 
     if (sc.get_render_mask() & SceneContext::LIGHTMAP)
     { // Renders the lightmap to the screen
+      ProfileScope pass_scope("Compositor::lightmap multiply");
       render_lightmap(sc, sg);
     }
 
     if (sc.get_render_mask() & SceneContext::HIGHLIGHTMAP)
     {
+      ProfileScope pass_scope("Compositor::highlightmap");
       sc.highlight().render();
 
       if (sg)
@@ -133,6 +141,7 @@ FramebufferCompositorImpl::render(SceneContext& sc, SceneGraph* sg, const Graphi
 
     if (sc.get_render_mask() & SceneContext::CONTROLMAP)
     {
+      ProfileScope pass_scope("Compositor::controlmap");
       sc.control().render();
 
       if (sg)
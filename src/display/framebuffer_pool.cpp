@@ -0,0 +1,205 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "display/framebuffer_pool.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+FramebufferPool::FramebufferPool() :
+  m_contexts(),
+  m_context(0),
+  m_idle_budget(64 * 1024 * 1024),
+  m_use_counter(0),
+  m_hits(0),
+  m_misses(0),
+  m_evictions(0)
+{
+}
+
+FramebufferPool::~FramebufferPool()
+{
+}
+
+FramebufferPtr
+FramebufferPool::get(Format format, const Size& size, int multisample)
+{
+  m_use_counter += 1;
+
+  Entries& entries = get_entries();
+  for(Entries::iterator i = entries.begin(); i != entries.end(); ++i)
+  {
+    if (i->framebuffer.use_count() == 1 &&
+        i->format      == format &&
+        i->size        == size &&
+        i->multisample == multisample)
+    {
+      m_hits += 1;
+      i->last_use = m_use_counter;
+      return i->framebuffer;
+    }
+  }
+
+  m_misses += 1;
+
+  // make room before allocating, so the old targets are gone from
+  // GPU memory by the time the new one gets created
+  evict(m_idle_budget);
+
+  Entry entry;
+  entry.format      = format;
+  entry.size        = size;
+  entry.multisample = multisample;
+  entry.bytes       = estimate_bytes(format, size, multisample);
+  entry.last_use    = m_use_counter;
+
+  switch(format)
+  {
+    case kTexture:
+      entry.framebuffer = Framebuffer::create_with_texture(GL_TEXTURE_2D, size.width, size.height, multisample);
+      break;
+
+    case kRGB8:
+      entry.framebuffer = Framebuffer::create(size.width, size.height, multisample);
+      break;
+
+    case kRGBA16F:
+      entry.framebuffer = Framebuffer::create_hdr(size.width, size.height, multisample);
+      break;
+  }
+
+  entries.push_back(entry);
+  return entry.framebuffer;
+}
+
+void
+FramebufferPool::cleanup()
+{
+  evict(0);
+}
+
+void
+FramebufferPool::set_context(const void* context)
+{
+  m_context = context;
+}
+
+void
+FramebufferPool::release_context(const void* context)
+{
+  m_contexts.erase(context);
+}
+
+void
+FramebufferPool::set_idle_budget(size_t bytes)
+{
+  m_idle_budget = bytes;
+  evict(m_idle_budget);
+}
+
+FramebufferPoolStats
+FramebufferPool::get_stats() const
+{
+  FramebufferPoolStats stats;
+
+  for(Contexts::const_iterator c = m_contexts.begin(); c != m_contexts.end(); ++c)
+  {
+    for(Entries::const_iterator i = c->second.begin(); i != c->second.end(); ++i)
+    {
+      if (i->framebuffer.use_count() == 1)
+      {
+        stats.idle       += 1;
+        stats.bytes_idle += i->bytes;
+      }
+      else
+      {
+        stats.live       += 1;
+        stats.bytes_live += i->bytes;
+      }
+    }
+  }
+
+  stats.idle_budget = m_idle_budget;
+  stats.hits      = m_hits;
+  stats.misses    = m_misses;
+  stats.evictions = m_evictions;
+
+  return stats;
+}
+
+void
+FramebufferPool::reset_stats()
+{
+  m_hits      = 0;
+  m_misses    = 0;
+  m_evictions = 0;
+}
+
+void
+FramebufferPool::evict(size_t budget)
+{
+  // only the current context, deleting a framebuffer object of
+  // another one would hit whatever has the same name in this one
+  Entries& entries = get_entries();
+
+  size_t bytes_idle = 0;
+  for(Entries::iterator i = entries.begin(); i != entries.end(); ++i)
+  {
+    if (i->framebuffer.use_count() == 1)
+    {
+      bytes_idle += i->bytes;
+    }
+  }
+
+  while(bytes_idle > budget)
+  {
+    Entries::iterator oldest = entries.end();
+    for(Entries::iterator i = entries.begin(); i != entries.end(); ++i)
+    {
+      if (i->framebuffer.use_count() == 1 &&
+          (oldest == entries.end() || i->last_use < oldest->last_use))
+      {
+        oldest = i;
+      }
+    }
+
+    assert(oldest != entries.end());
+
+    bytes_idle  -= oldest->bytes;
+    m_evictions += 1;
+    entries.erase(oldest);
+  }
+}
+
+size_t
+FramebufferPool::estimate_bytes(Format format, const Size& size, int multisample)
+{
+  size_t color_bpp = 4;
+  if (format == kRGBA16F)
+  {
+    color_bpp = 8;
+  }
+
+  // plus the GL_DEPTH24_STENCIL8 buffer every Framebuffer has
+  const size_t bpp = color_bpp + 4;
+
+  return static_cast<size_t>(size.width) * static_cast<size_t>(size.height) * bpp *
+    static_cast<size_t>(std::max(1, multisample));
+}
+
+/* EOF */
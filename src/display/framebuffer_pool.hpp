@@ -0,0 +1,170 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_DISPLAY_FRAMEBUFFER_POOL_HPP
+#define HEADER_WINDSTILLE_DISPLAY_FRAMEBUFFER_POOL_HPP
+
+#include <map>
+#include <ostream>
+#include <vector>
+
+#include "display/framebuffer.hpp"
+#include "math/size.hpp"
+#include "util/currenton.hpp"
+
+struct FramebufferPoolStats
+{
+  FramebufferPoolStats() :
+    live(0),
+    idle(0),
+    bytes_live(0),
+    bytes_idle(0),
+    idle_budget(0),
+    hits(0),
+    misses(0),
+    evictions(0)
+  {}
+
+  /** targets currently handed out */
+  unsigned int live;
+
+  /** targets kept around for reuse */
+  unsigned int idle;
+
+  size_t bytes_live;
+  size_t bytes_idle;
+  size_t idle_budget;
+
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int evictions;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const FramebufferPoolStats& stats)
+{
+  return os << "live: " << stats.live << " (" << stats.bytes_live / 1024 << "KiB)"
+            << "  idle: " << stats.idle << " (" << stats.bytes_idle / 1024 << "KiB)"
+            << "  budget: " << stats.idle_budget / 1024 << "KiB"
+            << "  hits: " << stats.hits
+            << "  misses: " << stats.misses
+            << "  evictions: " << stats.evictions;
+}
+
+/**
+ * Hands out render targets keyed by format and size. A target is in
+ * use as long as somebody besides the pool holds a reference to it,
+ * once released it gets handed out again to the next request with
+ * the same key, so passes and frames share their targets instead of
+ * allocating new ones. Idle targets are destroyed in least recently
+ * used order when they exceed the idle budget.
+ *
+ * Framebuffer objects are not shared between GL contexts, so each
+ * context, see set_context(), gets its own set of targets and its own
+ * idle budget.
+ */
+class FramebufferPool : public Currenton<FramebufferPool>
+{
+public:
+  enum Format {
+    /** GL_RGBA texture as color buffer, see Framebuffer::create_with_texture() */
+    kTexture,
+
+    /** GL_RGB8 renderbuffer, see Framebuffer::create() */
+    kRGB8,
+
+    /** GL_RGBA16F renderbuffer, see Framebuffer::create_hdr() */
+    kRGBA16F
+  };
+
+private:
+  struct Entry
+  {
+    Entry() :
+      framebuffer(),
+      format(kTexture),
+      size(),
+      multisample(0),
+      bytes(0),
+      last_use(0)
+    {}
+
+    FramebufferPtr framebuffer;
+    Format format;
+    Size   size;
+    int    multisample;
+    size_t bytes;
+    unsigned int last_use;
+  };
+
+  typedef std::vector<Entry> Entries;
+  typedef std::map<const void*, Entries> Contexts;
+  Contexts m_contexts;
+
+  /** key of the current GL context, 0 when there is only one */
+  const void* m_context;
+
+  size_t m_idle_budget;
+  unsigned int m_use_counter;
+
+  unsigned int m_hits;
+  unsigned int m_misses;
+  unsigned int m_evictions;
+
+public:
+  FramebufferPool();
+  ~FramebufferPool();
+
+  /** Returns a framebuffer not used by anybody else, its content is
+      undefined. It returns to the pool once the last reference to it
+      is dropped. */
+  FramebufferPtr get(Format format, const Size& size, int multisample = 0);
+
+  /** Destroys all idle framebuffers of the current context */
+  void cleanup();
+
+  /** Tells the pool which GL context is current, \a context is any
+      pointer unique to it. Has to be called whenever another context
+      is made current, a program with a single context can ignore it. */
+  void set_context(const void* context);
+
+  /** Drops all framebuffers of \a context, to be called while it is
+      still current, before it gets destroyed */
+  void release_context(const void* context);
+
+  void set_idle_budget(size_t bytes);
+
+  FramebufferPoolStats get_stats() const;
+  void reset_stats();
+
+private:
+  /** Destroys idle framebuffers of the current context, oldest
+      first, until they fit into \a budget */
+  void evict(size_t budget);
+
+  Entries& get_entries() { return m_contexts[m_context]; }
+
+  static size_t estimate_bytes(Format format, const Size& size, int multisample);
+
+private:
+  FramebufferPool(const FramebufferPool&);
+  FramebufferPool& operator=(const FramebufferPool&);
+};
+
+#endif
+
+/* EOF */
@@ -27,6 +27,7 @@
 #include "display/display.hpp"
 #include "display/assert_gl.hpp"
 #include "app/config.hpp"
+#include "util/profiler.hpp"
 
 class OpenGLWindowImpl
 {
@@ -48,7 +49,6 @@ OpenGLWindow::OpenGLWindow(const std::string& title,
 {
   m_impl->m_size = size;
 
-  //SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL, 1); // vsync
   SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1); 
 
   // FIXME: Should make this configurable, as Matrox G450 can't do it,
@@ -171,9 +171,17 @@ OpenGLWindow::set_gamma(float r, float g, float b)
   }
 }
 
+bool
+OpenGLWindow::set_vsync(bool vsync)
+{
+  return SDL_GL_SetSwapInterval(vsync ? 1 : 0) == 0;
+}
+
 void
 OpenGLWindow::swap_buffers()
 {
+  ProfileScope profile_scope("OpenGLWindow::swap_buffers");
+
   SDL_GL_SwapWindow(m_impl->m_window);
 }
 
@@ -41,6 +41,10 @@ public:
   void set_fullscreen(bool fullscreen);
   void set_gamma(float r, float g, float b);
 
+  /** Synchronizes swap_buffers() with the vertical retrace, returns
+      false if the driver doesn't support it */
+  bool set_vsync(bool vsync);
+
   void swap_buffers();
 
 private:
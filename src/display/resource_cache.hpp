@@ -0,0 +1,218 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_DISPLAY_RESOURCE_CACHE_HPP
+#define HEADER_WINDSTILLE_DISPLAY_RESOURCE_CACHE_HPP
+
+#include <assert.h>
+#include <boost/shared_ptr.hpp>
+#include <list>
+#include <map>
+#include <ostream>
+
+#include "util/pathname.hpp"
+
+struct ResourceCacheStats
+{
+  ResourceCacheStats() :
+    hits(0),
+    misses(0),
+    evictions(0),
+    entries(0),
+    bytes_resident(0),
+    memory_budget(0)
+  {}
+
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int evictions;
+  unsigned int entries;
+  size_t bytes_resident;
+  size_t memory_budget;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const ResourceCacheStats& stats)
+{
+  return os << "entries: " << stats.entries
+            << "  resident: " << stats.bytes_resident / 1024 << "KiB"
+            << "  budget: " << stats.memory_budget / 1024 << "KiB"
+            << "  hits: " << stats.hits
+            << "  misses: " << stats.misses
+            << "  evictions: " << stats.evictions;
+}
+
+/**
+ * Maps filenames to refcounted resources and keeps track of the
+ * memory they occupy. When the resident size exceeds the memory
+ * budget, the least recently used resources that are no longer
+ * referenced outside of the cache get dropped. Resources still in
+ * use are never evicted, so the budget is a soft limit.
+ */
+template<class T>
+class ResourceCache
+{
+public:
+  typedef boost::shared_ptr<T> ResourcePtr;
+
+private:
+  typedef std::list<Pathname> LRUList;
+
+  struct Entry
+  {
+    Entry() : resource(), bytes(0), lru() {}
+
+    ResourcePtr resource;
+    size_t bytes;
+    typename LRUList::iterator lru;
+  };
+
+  typedef std::map<Pathname, Entry> Entries;
+
+  Entries m_entries;
+
+  /** most recently used entries are at the front */
+  LRUList m_lru;
+
+  ResourceCacheStats m_stats;
+
+public:
+  ResourceCache(size_t memory_budget) :
+    m_entries(),
+    m_lru(),
+    m_stats()
+  {
+    m_stats.memory_budget = memory_budget;
+  }
+
+  /** Returns the resource cached for \a filename or an empty pointer
+      when there is none, hits and misses are counted */
+  ResourcePtr find(const Pathname& filename)
+  {
+    typename Entries::iterator it = m_entries.find(filename);
+    if (it == m_entries.end())
+    {
+      m_stats.misses += 1;
+      return ResourcePtr();
+    }
+    else
+    {
+      m_stats.hits += 1;
+      m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+      return it->second.resource;
+    }
+  }
+
+  /** Returns true if \a filename is cached, without counting it as a
+      hit or use */
+  bool contains(const Pathname& filename) const
+  {
+    return m_entries.find(filename) != m_entries.end();
+  }
+
+  /** Adds \a resource occupying \a bytes to the cache, evicting
+      unused resources if the memory budget is exceeded */
+  void insert(const Pathname& filename, ResourcePtr resource, size_t bytes)
+  {
+    typename Entries::iterator it = m_entries.find(filename);
+    if (it != m_entries.end())
+    {
+      erase(it);
+    }
+
+    Entry& entry = m_entries[filename];
+    entry.resource = resource;
+    entry.bytes    = bytes;
+    entry.lru      = m_lru.insert(m_lru.begin(), filename);
+
+    m_stats.entries        += 1;
+    m_stats.bytes_resident += bytes;
+
+    evict(m_stats.memory_budget);
+  }
+
+  /** Drops all resources that are no longer referenced outside of
+      the cache, regardless of the memory budget */
+  void evict_unused()
+  {
+    evict(0);
+  }
+
+  void clear()
+  {
+    m_entries.clear();
+    m_lru.clear();
+    m_stats.entries        = 0;
+    m_stats.bytes_resident = 0;
+  }
+
+  void set_memory_budget(size_t memory_budget)
+  {
+    m_stats.memory_budget = memory_budget;
+    evict(m_stats.memory_budget);
+  }
+
+  size_t get_memory_budget() const { return m_stats.memory_budget; }
+
+  const ResourceCacheStats& get_stats() const { return m_stats; }
+
+  void reset_stats()
+  {
+    m_stats.hits      = 0;
+    m_stats.misses    = 0;
+    m_stats.evictions = 0;
+  }
+
+private:
+  void evict(size_t budget)
+  {
+    typename LRUList::iterator i = m_lru.end();
+    while(m_stats.bytes_resident > budget && i != m_lru.begin())
+    {
+      --i;
+      typename Entries::iterator it = m_entries.find(*i);
+      assert(it != m_entries.end());
+
+      if (it->second.resource.use_count() == 1)
+      {
+        // erase() invalidates the list node 'i' points to, so step
+        // past it first
+        typename LRUList::iterator next = i;
+        ++next;
+        erase(it);
+        m_stats.evictions += 1;
+        i = next;
+      }
+    }
+  }
+
+  void erase(typename Entries::iterator it)
+  {
+    m_stats.entries        -= 1;
+    m_stats.bytes_resident -= it->second.bytes;
+    m_lru.erase(it->second.lru);
+    m_entries.erase(it);
+  }
+
+private:
+  ResourceCache(const ResourceCache&);
+  ResourceCache& operator=(const ResourceCache&);
+};
+
+#endif
+
+/* EOF */
@@ -33,6 +33,7 @@ public:
   DrawingContext control; 
 
   unsigned int   render_mask;
+  float          interpolation;
 
   SceneContextImpl() 
     : color(),
@@ -43,7 +44,8 @@ public:
                   SceneContext::LIGHTMAP | 
                   SceneContext::HIGHLIGHTMAP | 
                   SceneContext::CONTROLMAP | 
-                  SceneContext::LIGHTMAPSCREEN)
+                  SceneContext::LIGHTMAPSCREEN),
+      interpolation(1.0f)
   {
   }
 
@@ -206,4 +208,16 @@ SceneContext::get_render_mask()
   return impl->render_mask;
 }
 
+void
+SceneContext::set_interpolation(float alpha)
+{
+  impl->interpolation = alpha;
+}
+
+float
+SceneContext::get_interpolation() const
+{
+  return impl->interpolation;
+}
+
 /* EOF */
@@ -89,6 +89,12 @@ public:
       debugging. */
   void set_render_mask(unsigned int mask);
   unsigned int get_render_mask();
+
+  /** Fraction of an update step that has passed since the last one,
+      objects that move smoothly draw themselves that far between
+      their previous and their current position */
+  void set_interpolation(float alpha);
+  float get_interpolation() const;
   
 private:
   boost::scoped_ptr<SceneContextImpl> impl;
@@ -0,0 +1,125 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "display/software_compositor_impl.hpp"
+
+#include <glm/ext.hpp>
+
+#include "display/graphic_context_state.hpp"
+#include "display/scene_context.hpp"
+#include "display/software_rasterizer.hpp"
+#include "display/texture.hpp"
+#include "scenegraph/scene_graph.hpp"
+#include "util/profiler.hpp"
+
+static const int LIGHTMAP_DIV = 4;
+
+SoftwareCompositorImpl::SoftwareCompositorImpl(const Size& window, const Size& viewport) :
+  CompositorImpl(window, viewport),
+  m_screen  (SoftwareSurface::create(window.width, window.height)),
+  m_lightmap(SoftwareSurface::create(window.width / LIGHTMAP_DIV, window.height / LIGHTMAP_DIV)),
+  m_keep_software_surfaces(Texture::get_keep_software_surfaces())
+{
+  // textures created from now on keep their pixels, so the rasterizer
+  // doesn't have to read them back from OpenGL
+  Texture::set_keep_software_surfaces(true);
+}
+
+SoftwareCompositorImpl::~SoftwareCompositorImpl()
+{
+  Texture::set_keep_software_surfaces(m_keep_software_surfaces);
+}
+
+void
+SoftwareCompositorImpl::render_layer(SoftwareRasterizer& rasterizer, DrawingContext& dc,
+                                     SceneGraph* sg, const Matrix& sg_matrix, unsigned int mask)
+{
+  dc.rasterize(rasterizer);
+
+  if (sg)
+  {
+    Matrix matrix = rasterizer.get_matrix();
+    rasterizer.set_matrix(matrix * sg_matrix);
+    sg->rasterize(rasterizer, mask);
+    rasterizer.set_matrix(matrix);
+  }
+}
+
+void
+SoftwareCompositorImpl::render(SceneContext& sc, SceneGraph* sg, const GraphicContextState& gc_state)
+{
+  ProfileScope profile_scope("Compositor::render");
+
+  // maps viewport coordinates to the pixels of the screen surface
+  const Matrix screen_matrix = glm::scale(glm::mat4(1.0f),
+                                          glm::vec3(static_cast<float>(m_window.width)  / static_cast<float>(m_viewport.width),
+                                                    static_cast<float>(m_window.height) / static_cast<float>(m_viewport.height),
+                                                    1.0f));
+  const Matrix sg_matrix = gc_state.get_matrix();
+
+  if (sc.get_render_mask() & SceneContext::LIGHTMAPSCREEN)
+  {
+    ProfileScope pass_scope("Compositor::lightmap");
+    SoftwareRasterizer rasterizer(m_lightmap);
+    rasterizer.set_matrix(glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / LIGHTMAP_DIV, 1.0f / LIGHTMAP_DIV, 1.0f)) * screen_matrix);
+
+    rasterizer.clear(Color(0.0f, 0.0f, 0.0f, 1.0f));
+    render_layer(rasterizer, sc.light(), sg, sg_matrix, SceneContext::LIGHTMAP);
+    rasterizer.execute();
+  }
+
+  { // Render the main screen
+    SoftwareRasterizer rasterizer(m_screen);
+    rasterizer.set_matrix(screen_matrix);
+
+    if (sc.get_render_mask() & SceneContext::COLORMAP)
+    {
+      ProfileScope pass_scope("Compositor::colormap");
+      rasterizer.clear(Color(0.0f, 0.0f, 0.0f, 1.0f));
+      render_layer(rasterizer, sc.color(), sg, sg_matrix, SceneContext::COLORMAP);
+    }
+
+    if (sc.get_render_mask() & SceneContext::LIGHTMAP)
+    {
+      ProfileScope pass_scope("Compositor::lightmap multiply");
+      rasterizer.multiply(m_lightmap);
+    }
+
+    if (sc.get_render_mask() & SceneContext::HIGHLIGHTMAP)
+    {
+      ProfileScope pass_scope("Compositor::highlightmap");
+      render_layer(rasterizer, sc.highlight(), sg, sg_matrix, SceneContext::HIGHLIGHTMAP);
+    }
+
+    if (sc.get_render_mask() & SceneContext::CONTROLMAP)
+    {
+      ProfileScope pass_scope("Compositor::controlmap");
+      render_layer(rasterizer, sc.control(), sg, sg_matrix, SceneContext::CONTROLMAP);
+    }
+
+    rasterizer.execute();
+  }
+
+  // Clear all DrawingContexts
+  sc.color().clear();
+  sc.light().clear();
+  sc.highlight().clear();
+  sc.control().clear();
+}
+
+/* EOF */
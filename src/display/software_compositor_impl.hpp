@@ -0,0 +1,63 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_DISPLAY_SOFTWARE_COMPOSITOR_IMPL_HPP
+#define HEADER_WINDSTILLE_DISPLAY_SOFTWARE_COMPOSITOR_IMPL_HPP
+
+#include "display/compositor_impl.hpp"
+#include "display/software_surface.hpp"
+#include "math/matrix.hpp"
+
+class DrawingContext;
+class SoftwareRasterizer;
+
+/**
+ * Compositor that renders on the CPU into a SoftwareSurface instead
+ * of the screen, the result is available via get_software_surface()
+ * after render().
+ */
+class SoftwareCompositorImpl : public CompositorImpl
+{
+private:
+  SoftwareSurfacePtr m_screen;
+  SoftwareSurfacePtr m_lightmap;
+
+  /** Texture::set_keep_software_surfaces() from before, restored on
+      destruction */
+  bool m_keep_software_surfaces;
+
+public:
+  SoftwareCompositorImpl(const Size& window, const Size& viewport);
+  ~SoftwareCompositorImpl();
+
+  void render(SceneContext& sc, SceneGraph* sg, const GraphicContextState& state);
+
+  SoftwareSurfacePtr get_software_surface() const { return m_screen; }
+
+private:
+  void render_layer(SoftwareRasterizer& rasterizer, DrawingContext& dc,
+                    SceneGraph* sg, const Matrix& sg_matrix, unsigned int mask);
+
+private:
+  SoftwareCompositorImpl(const SoftwareCompositorImpl&);
+  SoftwareCompositorImpl& operator=(const SoftwareCompositorImpl&);
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,414 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "display/software_rasterizer.hpp"
+
+#include <assert.h>
+#include <boost/shared_ptr.hpp>
+#include <math.h>
+#include <stdexcept>
+#include <stdint.h>
+
+#include "math/math.hpp"
+#include "math/quad.hpp"
+#include "util/job_system.hpp"
+
+namespace {
+
+inline float edge(float ax, float ay, float bx, float by, float px, float py)
+{
+  return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+/** Pixels exactly on an edge belong to only one of the two triangles
+    sharing it, as the shared edge is walked in opposite directions */
+inline bool is_inclusive_edge(float ax, float ay, float bx, float by)
+{
+  return (by > ay) || (by == ay && bx < ax);
+}
+
+inline float to_float(uint8_t v)
+{
+  return static_cast<float>(v) / 255.0f;
+}
+
+inline uint8_t to_byte(float v)
+{
+  return static_cast<uint8_t>(math::mid(0.0f, v, 1.0f) * 255.0f + 0.5f);
+}
+
+/** Returns the GL blend factor for \a channel, unknown factors are
+    treated as GL_ONE */
+inline float blend_factor(GLenum factor, const float* src, const float* dst, int channel)
+{
+  switch(factor)
+  {
+    case GL_ZERO:                return 0.0f;
+    case GL_ONE:                 return 1.0f;
+    case GL_SRC_COLOR:           return src[channel];
+    case GL_ONE_MINUS_SRC_COLOR: return 1.0f - src[channel];
+    case GL_DST_COLOR:           return dst[channel];
+    case GL_ONE_MINUS_DST_COLOR: return 1.0f - dst[channel];
+    case GL_SRC_ALPHA:           return src[3];
+    case GL_ONE_MINUS_SRC_ALPHA: return 1.0f - src[3];
+    case GL_DST_ALPHA:           return dst[3];
+    case GL_ONE_MINUS_DST_ALPHA: return 1.0f - dst[3];
+    default:                     return 1.0f;
+  }
+}
+
+} // namespace
+
+class SoftwareRasterizer::BandJob : public Job
+{
+public:
+  BandJob() : rasterizer(0), y_begin(0), y_end(0) {}
+
+  void run() { rasterizer->execute_band(y_begin, y_end); }
+
+  const SoftwareRasterizer* rasterizer;
+  int y_begin;
+  int y_end;
+
+private:
+  BandJob(const BandJob&);
+  BandJob& operator=(const BandJob&);
+};
+
+SoftwareRasterizer::SoftwareRasterizer(SoftwareSurfacePtr target) :
+  m_target(target),
+  m_matrix(1.0f),
+  m_commands(),
+  m_vertices(),
+  m_textures()
+{
+  if (m_target->get_bytes_per_pixel() != 4)
+  {
+    throw std::runtime_error("SoftwareRasterizer: target must be a RGBA surface");
+  }
+}
+
+void
+SoftwareRasterizer::clear(const Color& color)
+{
+  Command cmd;
+  cmd.type  = kClear;
+  cmd.color = color;
+  m_commands.push_back(cmd);
+}
+
+void
+SoftwareRasterizer::draw_triangles(const SoftwareVertex* vertices, int num_vertices,
+                                   TexturePtr texture, GLenum sfactor, GLenum dfactor,
+                                   const Matrix& modelview)
+{
+  Command cmd;
+  cmd.type    = kTriangles;
+  cmd.texture = get_pixels(texture);
+  cmd.sfactor = sfactor;
+  cmd.dfactor = dfactor;
+  cmd.begin   = static_cast<int>(m_vertices.size());
+
+  const Matrix matrix = m_matrix * modelview;
+  for(int i = 0; i < num_vertices - num_vertices % 3; ++i)
+  {
+    glm::vec4 p = matrix * glm::vec4(vertices[i].x, vertices[i].y, 0.0f, 1.0f);
+    m_vertices.push_back(SoftwareVertex(p.x, p.y, vertices[i].u, vertices[i].v, vertices[i].color));
+  }
+
+  cmd.end = static_cast<int>(m_vertices.size());
+  m_commands.push_back(cmd);
+}
+
+void
+SoftwareRasterizer::draw_quad(const Quad& quad, const Rectf& uv, const Color& color,
+                              TexturePtr texture, GLenum sfactor, GLenum dfactor,
+                              const Matrix& modelview)
+{
+  SoftwareVertex vertices[6];
+
+  vertices[0] = SoftwareVertex(quad.p1.x, quad.p1.y, uv.left,  uv.top,    color);
+  vertices[1] = SoftwareVertex(quad.p2.x, quad.p2.y, uv.right, uv.top,    color);
+  vertices[2] = SoftwareVertex(quad.p3.x, quad.p3.y, uv.right, uv.bottom, color);
+
+  vertices[3] = vertices[0];
+  vertices[4] = vertices[2];
+  vertices[5] = SoftwareVertex(quad.p4.x, quad.p4.y, uv.left,  uv.bottom, color);
+
+  draw_triangles(vertices, 6, texture, sfactor, dfactor, modelview);
+}
+
+void
+SoftwareRasterizer::multiply(SoftwareSurfacePtr lightmap)
+{
+  Command cmd;
+  cmd.type    = kMultiply;
+  cmd.texture = lightmap;
+  m_commands.push_back(cmd);
+}
+
+void
+SoftwareRasterizer::execute()
+{
+  const int height = m_target->get_height();
+
+  // one band per thread of the JobSystem, the calling thread included
+  JobSystem* job_system = JobSystem::current();
+  const int num_bands = math::mid(1, job_system ? job_system->get_num_threads() + 1 : 1,
+                                  math::max(1, height));
+
+  if (num_bands == 1)
+  {
+    execute_band(0, height);
+  }
+  else
+  {
+    std::vector<boost::shared_ptr<BandJob> > jobs;
+    for(int i = 0; i < num_bands; ++i)
+    {
+      boost::shared_ptr<BandJob> job(new BandJob());
+      job->rasterizer = this;
+      job->y_begin = height * i / num_bands;
+      job->y_end   = height * (i + 1) / num_bands;
+      jobs.push_back(job);
+
+      job_system->push(job.get());
+    }
+    job_system->wait();
+  }
+
+  m_commands.clear();
+  m_vertices.clear();
+}
+
+SoftwareSurfacePtr
+SoftwareRasterizer::get_pixels(TexturePtr texture)
+{
+  if (!texture)
+  {
+    return SoftwareSurfacePtr();
+  }
+  else
+  {
+    TextureCache::iterator it = m_textures.find(texture);
+    if (it != m_textures.end())
+    {
+      return it->second;
+    }
+    else
+    {
+      SoftwareSurfacePtr pixels = texture->get_software_surface();
+      m_textures[texture] = pixels;
+      return pixels;
+    }
+  }
+}
+
+void
+SoftwareRasterizer::execute_band(int y_begin, int y_end) const
+{
+  for(Commands::const_iterator cmd = m_commands.begin(); cmd != m_commands.end(); ++cmd)
+  {
+    switch(cmd->type)
+    {
+      case kClear:
+        clear_band(*cmd, y_begin, y_end);
+        break;
+
+      case kMultiply:
+        multiply_band(*cmd, y_begin, y_end);
+        break;
+
+      case kTriangles:
+        for(int i = cmd->begin; i < cmd->end; i += 3)
+        {
+          triangle_band(*cmd, m_vertices[i], m_vertices[i+1], m_vertices[i+2], y_begin, y_end);
+        }
+        break;
+    }
+  }
+}
+
+void
+SoftwareRasterizer::clear_band(const Command& cmd, int y_begin, int y_end) const
+{
+  const uint8_t pixel[4] = { to_byte(cmd.color.r), to_byte(cmd.color.g),
+                             to_byte(cmd.color.b), to_byte(cmd.color.a) };
+
+  uint8_t* pixels = static_cast<uint8_t*>(m_target->get_pixels());
+  const int pitch = m_target->get_pitch();
+  const int width = m_target->get_width();
+
+  for(int y = y_begin; y < y_end; ++y)
+  {
+    uint8_t* row = pixels + y * pitch;
+    for(int x = 0; x < width; ++x)
+    {
+      row[4*x + 0] = pixel[0];
+      row[4*x + 1] = pixel[1];
+      row[4*x + 2] = pixel[2];
+      row[4*x + 3] = pixel[3];
+    }
+  }
+}
+
+void
+SoftwareRasterizer::multiply_band(const Command& cmd, int y_begin, int y_end) const
+{
+  const SoftwareSurface& lightmap = *cmd.texture;
+  const uint8_t* light  = static_cast<const uint8_t*>(lightmap.get_pixels());
+  const int light_bpp   = lightmap.get_bytes_per_pixel();
+  const int light_pitch = lightmap.get_pitch();
+  const int light_w     = lightmap.get_width();
+  const int light_h     = lightmap.get_height();
+
+  uint8_t* pixels = static_cast<uint8_t*>(m_target->get_pixels());
+  const int pitch  = m_target->get_pitch();
+  const int width  = m_target->get_width();
+  const int height = m_target->get_height();
+
+  for(int y = y_begin; y < y_end; ++y)
+  {
+    uint8_t* row = pixels + y * pitch;
+    const uint8_t* light_row = light + (y * light_h / height) * light_pitch;
+
+    for(int x = 0; x < width; ++x)
+    {
+      const uint8_t* l = light_row + (x * light_w / width) * light_bpp;
+      row[4*x + 0] = static_cast<uint8_t>(row[4*x + 0] * l[0] / 255);
+      row[4*x + 1] = static_cast<uint8_t>(row[4*x + 1] * l[1] / 255);
+      row[4*x + 2] = static_cast<uint8_t>(row[4*x + 2] * l[2] / 255);
+      if (light_bpp == 4)
+      {
+        row[4*x + 3] = static_cast<uint8_t>(row[4*x + 3] * l[3] / 255);
+      }
+    }
+  }
+}
+
+void
+SoftwareRasterizer::triangle_band(const Command& cmd,
+                                  const SoftwareVertex& v0, const SoftwareVertex& v1_,
+                                  const SoftwareVertex& v2_,
+                                  int y_begin, int y_end) const
+{
+  float area = edge(v0.x, v0.y, v1_.x, v1_.y, v2_.x, v2_.y);
+  if (fabsf(area) < 1.0e-6f)
+  {
+    return;
+  }
+
+  // bring the triangle into a consistent winding order
+  const bool flip = (area < 0.0f);
+  const SoftwareVertex& v1 = flip ? v2_ : v1_;
+  const SoftwareVertex& v2 = flip ? v1_ : v2_;
+  area = fabsf(area);
+
+  const int width = m_target->get_width();
+
+  const int x_min = math::max(0, static_cast<int>(floorf(math::min(v0.x, math::min(v1.x, v2.x)))));
+  const int x_max = math::min(width - 1, static_cast<int>(ceilf(math::max(v0.x, math::max(v1.x, v2.x)))));
+  const int y_min = math::max(y_begin, static_cast<int>(floorf(math::min(v0.y, math::min(v1.y, v2.y)))));
+  const int y_max = math::min(y_end - 1, static_cast<int>(ceilf(math::max(v0.y, math::max(v1.y, v2.y)))));
+
+  if (x_min > x_max || y_min > y_max)
+  {
+    return;
+  }
+
+  const bool inclusive0 = is_inclusive_edge(v1.x, v1.y, v2.x, v2.y);
+  const bool inclusive1 = is_inclusive_edge(v2.x, v2.y, v0.x, v0.y);
+  const bool inclusive2 = is_inclusive_edge(v0.x, v0.y, v1.x, v1.y);
+
+  const uint8_t* tex = 0;
+  int tex_bpp   = 0;
+  int tex_pitch = 0;
+  int tex_w     = 0;
+  int tex_h     = 0;
+  if (cmd.texture)
+  {
+    tex       = static_cast<const uint8_t*>(cmd.texture->get_pixels());
+    tex_bpp   = cmd.texture->get_bytes_per_pixel();
+    tex_pitch = cmd.texture->get_pitch();
+    tex_w     = cmd.texture->get_width();
+    tex_h     = cmd.texture->get_height();
+  }
+
+  uint8_t* pixels = static_cast<uint8_t*>(m_target->get_pixels());
+  const int pitch = m_target->get_pitch();
+
+  for(int y = y_min; y <= y_max; ++y)
+  {
+    const float py = static_cast<float>(y) + 0.5f;
+    uint8_t* row = pixels + y * pitch;
+
+    for(int x = x_min; x <= x_max; ++x)
+    {
+      const float px = static_cast<float>(x) + 0.5f;
+
+      const float w0 = edge(v1.x, v1.y, v2.x, v2.y, px, py);
+      const float w1 = edge(v2.x, v2.y, v0.x, v0.y, px, py);
+      const float w2 = edge(v0.x, v0.y, v1.x, v1.y, px, py);
+
+      if ((w0 > 0.0f || (w0 == 0.0f && inclusive0)) &&
+          (w1 > 0.0f || (w1 == 0.0f && inclusive1)) &&
+          (w2 > 0.0f || (w2 == 0.0f && inclusive2)))
+      {
+        const float b0 = w0 / area;
+        const float b1 = w1 / area;
+        const float b2 = w2 / area;
+
+        float src[4] = {
+          b0 * v0.color.r + b1 * v1.color.r + b2 * v2.color.r,
+          b0 * v0.color.g + b1 * v1.color.g + b2 * v2.color.g,
+          b0 * v0.color.b + b1 * v1.color.b + b2 * v2.color.b,
+          b0 * v0.color.a + b1 * v1.color.a + b2 * v2.color.a
+        };
+
+        if (tex)
+        {
+          const float u = b0 * v0.u + b1 * v1.u + b2 * v2.u;
+          const float v = b0 * v0.v + b1 * v1.v + b2 * v2.v;
+
+          const int tx = math::mid(0, static_cast<int>(u * static_cast<float>(tex_w)), tex_w - 1);
+          const int ty = math::mid(0, static_cast<int>(v * static_cast<float>(tex_h)), tex_h - 1);
+          const uint8_t* texel = tex + ty * tex_pitch + tx * tex_bpp;
+
+          src[0] *= to_float(texel[0]);
+          src[1] *= to_float(texel[1]);
+          src[2] *= to_float(texel[2]);
+          if (tex_bpp == 4)
+          {
+            src[3] *= to_float(texel[3]);
+          }
+        }
+
+        uint8_t* out = row + 4 * x;
+        const float dst[4] = { to_float(out[0]), to_float(out[1]), to_float(out[2]), to_float(out[3]) };
+
+        for(int c = 0; c < 4; ++c)
+        {
+          out[c] = to_byte(src[c] * blend_factor(cmd.sfactor, src, dst, c) +
+                           dst[c] * blend_factor(cmd.dfactor, src, dst, c));
+        }
+      }
+    }
+  }
+}
+
+/* EOF */
@@ -0,0 +1,153 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_DISPLAY_SOFTWARE_RASTERIZER_HPP
+#define HEADER_WINDSTILLE_DISPLAY_SOFTWARE_RASTERIZER_HPP
+
+#include <GL/glew.h>
+#include <map>
+#include <vector>
+
+#include "display/color.hpp"
+#include "display/software_surface.hpp"
+#include "display/texture.hpp"
+#include "math/matrix.hpp"
+#include "math/rect.hpp"
+
+class Quad;
+
+struct SoftwareVertex
+{
+  SoftwareVertex() :
+    x(0.0f), y(0.0f), u(0.0f), v(0.0f), color()
+  {}
+
+  SoftwareVertex(float x_, float y_, float u_, float v_, const Color& color_) :
+    x(x_), y(y_), u(u_), v(v_), color(color_)
+  {}
+
+  float x;
+  float y;
+  float u;
+  float v;
+  Color color;
+};
+
+/**
+ * Renders textured and colored triangles into a RGBA SoftwareSurface
+ * without touching OpenGL. Drawing calls are only recorded, with
+ * vertices already transformed into target pixel coordinates, the
+ * actual rasterization happens in execute(), which splits the target
+ * into horizontal bands and renders them as jobs on the JobSystem.
+ *
+ * Texture pixels are taken from Texture::get_software_surface(), the
+ * lookup is cached for the lifetime of the rasterizer, which thus
+ * should not outlive a single frame.
+ */
+class SoftwareRasterizer
+{
+private:
+  class BandJob;
+
+  enum CommandType { kClear, kTriangles, kMultiply };
+
+  struct Command
+  {
+    Command() :
+      type(kClear),
+      color(),
+      texture(),
+      sfactor(GL_ONE),
+      dfactor(GL_ZERO),
+      begin(0),
+      end(0)
+    {}
+
+    CommandType type;
+    Color color;
+
+    /** source texture for kTriangles, lightmap for kMultiply */
+    SoftwareSurfacePtr texture;
+    GLenum sfactor;
+    GLenum dfactor;
+
+    /** range of vertices in m_vertices, three per triangle */
+    int begin;
+    int end;
+  };
+
+  typedef std::vector<Command> Commands;
+  typedef std::map<TexturePtr, SoftwareSurfacePtr> TextureCache;
+
+  SoftwareSurfacePtr m_target;
+  Matrix m_matrix;
+  Commands m_commands;
+  std::vector<SoftwareVertex> m_vertices;
+  TextureCache m_textures;
+
+public:
+  /** \a target must be a RGBA surface */
+  SoftwareRasterizer(SoftwareSurfacePtr target);
+
+  SoftwareSurfacePtr get_target() const { return m_target; }
+
+  /** Transformation from drawing coordinates to target pixels,
+      applied on top of the modelview passed to the draw calls */
+  void set_matrix(const Matrix& matrix) { m_matrix = matrix; }
+  Matrix get_matrix() const { return m_matrix; }
+
+  void clear(const Color& color);
+
+  /** Draws \a num_vertices / 3 triangles, \a texture may be empty for
+      untextured geometry */
+  void draw_triangles(const SoftwareVertex* vertices, int num_vertices,
+                      TexturePtr texture, GLenum sfactor, GLenum dfactor,
+                      const Matrix& modelview);
+
+  /** Draws \a quad with the texture region \a uv, the corners of the
+      quad map to left/top, right/top, right/bottom, left/bottom */
+  void draw_quad(const Quad& quad, const Rectf& uv, const Color& color,
+                 TexturePtr texture, GLenum sfactor, GLenum dfactor,
+                 const Matrix& modelview);
+
+  /** Multiplies the target with \a lightmap stretched over the whole
+      target, same as blending it with GL_DST_COLOR, GL_ZERO */
+  void multiply(SoftwareSurfacePtr lightmap);
+
+  /** Rasterizes all recorded commands and empties the command list,
+      the bands are spread over the threads of JobSystem::current(),
+      without one everything is done by the calling thread */
+  void execute();
+
+private:
+  SoftwareSurfacePtr get_pixels(TexturePtr texture);
+
+  void execute_band(int y_begin, int y_end) const;
+  void clear_band(const Command& cmd, int y_begin, int y_end) const;
+  void multiply_band(const Command& cmd, int y_begin, int y_end) const;
+  void triangle_band(const Command& cmd, const SoftwareVertex& v0, const SoftwareVertex& v1,
+                     const SoftwareVertex& v2, int y_begin, int y_end) const;
+
+private:
+  SoftwareRasterizer(const SoftwareRasterizer&);
+  SoftwareRasterizer& operator=(const SoftwareRasterizer&);
+};
+
+#endif
+
+/* EOF */
@@ -25,13 +25,35 @@
 #include <SDL_image.h>
 
 #include "display/software_surface.hpp"
+#include "display/software_surface_cache.hpp"
+#include "display/surface_prefetcher.hpp"
 #include "math/rect.hpp"
 #include "util/util.hpp"
 
 SoftwareSurfacePtr
 SoftwareSurface::create(const Pathname& filename)
 {
-  return SoftwareSurfacePtr(new SoftwareSurface(filename));
+  if (SurfacePrefetcher::current())
+  {
+    SoftwareSurfacePtr surface = SurfacePrefetcher::current()->take(filename);
+    if (surface)
+      return surface;
+  }
+
+  if (SoftwareSurfaceCache::is_enabled())
+  {
+    SoftwareSurfacePtr surface = SoftwareSurfaceCache::load(filename);
+    if (!surface)
+    {
+      surface.reset(new SoftwareSurface(filename));
+      SoftwareSurfaceCache::store(filename, surface);
+    }
+    return surface;
+  }
+  else
+  {
+    return SoftwareSurfacePtr(new SoftwareSurface(filename));
+  }
 }
 
 SoftwareSurfacePtr
@@ -42,7 +64,8 @@ SoftwareSurface::create(int width, int height, Format format)
 
 SoftwareSurface::SoftwareSurface(const Pathname& filename) :
   m_surface(0),
-  m_format(RGBA)
+  m_format(RGBA),
+  m_mapping()
 {
   m_surface = IMG_Load(filename.get_sys_path().c_str());
 
@@ -154,7 +177,8 @@ SoftwareSurface::SoftwareSurface(const Pathname& filename) :
 
 SoftwareSurface::SoftwareSurface(int width, int height, Format format) :
   m_surface(0),
-  m_format(format)
+  m_format(format),
+  m_mapping()
 {
   assert(format == RGBA);
 
@@ -174,8 +198,17 @@ SoftwareSurface::SoftwareSurface(int width, int height, Format format) :
   assert(!SDL_MUSTLOCK(m_surface));
 }
 
+SoftwareSurface::SoftwareSurface(SDL_Surface* surface, Format format, MappedFilePtr mapping) :
+  m_surface(surface),
+  m_format(format),
+  m_mapping(mapping)
+{
+  assert(!SDL_MUSTLOCK(m_surface));
+}
+
 SoftwareSurface::~SoftwareSurface()
 {
+  // m_mapping is released after this, so the pixels stay valid
   SDL_FreeSurface(m_surface);
 }
 
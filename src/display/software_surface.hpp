@@ -21,6 +21,7 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include "util/mapped_file.hpp"
 #include "util/pathname.hpp"
 #include "math/size.hpp"
 
@@ -33,6 +34,8 @@ typedef boost::shared_ptr<SoftwareSurface> SoftwareSurfacePtr;
 
 class SoftwareSurface
 {
+  friend class SoftwareSurfaceCache;
+
 public:
   enum Format {
     RGB,
@@ -47,6 +50,9 @@ private:
   explicit SoftwareSurface(const Pathname& filename);
   SoftwareSurface(int width, int height, Format format = RGBA);
 
+  /** Takes ownership of \a surface, whose pixels point into \a mapping */
+  SoftwareSurface(SDL_Surface* surface, Format format, MappedFilePtr mapping);
+
 public:
   ~SoftwareSurface();
 
@@ -73,6 +79,9 @@ private:
   SDL_Surface* m_surface;
   Format m_format;
 
+  /** Memory backing m_surface when it was loaded from the cache */
+  MappedFilePtr m_mapping;
+
 private:
   SoftwareSurface(const SoftwareSurface&);
   SoftwareSurface& operator=(const SoftwareSurface&);
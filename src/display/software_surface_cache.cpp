@@ -0,0 +1,288 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "display/software_surface_cache.hpp"
+
+#include <boost/filesystem.hpp>
+#include <errno.h>
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <SDL.h>
+
+#include "util/mapped_file.hpp"
+#include "util/system.hpp"
+#include "util/util.hpp"
+
+namespace {
+
+const char     cache_magic[8]    = { 'W', 'S', 'T', 'S', 'U', 'R', 'F', '\0' };
+const uint32_t cache_version     = 1;
+const uint32_t cache_byte_order  = 0x01020304;
+
+struct CacheHeader
+{
+  char     magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+
+  uint32_t width;
+  uint32_t height;
+  uint32_t pitch;
+  uint32_t bytes_per_pixel;
+
+  int64_t  source_mtime;
+  uint64_t source_size;
+
+  /** length of the source path that follows the header */
+  uint32_t path_length;
+
+  /** offset of the pixel data from the start of the file */
+  uint32_t data_offset;
+};
+
+bool get_source_stat(const std::string& sys_path, int64_t* mtime, uint64_t* size)
+{
+  try
+  {
+    *mtime = static_cast<int64_t>(boost::filesystem::last_write_time(sys_path));
+    *size  = static_cast<uint64_t>(boost::filesystem::file_size(sys_path));
+    return true;
+  }
+  catch(const std::exception&)
+  {
+    return false;
+  }
+}
+
+} // namespace
+
+bool SoftwareSurfaceCache::s_enabled = false;
+
+void
+SoftwareSurfaceCache::set_enabled(bool enabled)
+{
+  s_enabled = enabled;
+}
+
+bool
+SoftwareSurfaceCache::is_enabled()
+{
+  return s_enabled;
+}
+
+Pathname
+SoftwareSurfaceCache::get_cache_filename(const Pathname& filename)
+{
+  std::string name;
+  switch(filename.get_type())
+  {
+    case Pathname::kDataPath: name = "data"; break;
+    case Pathname::kUserPath: name = "user"; break;
+    default:                  name = "sys";  break;
+  }
+
+  name += System::flatten_path(filename.get_raw_path());
+
+  return Pathname("cache/surfaces/" + name + ".surface", Pathname::kUserPath);
+}
+
+SoftwareSurfacePtr
+SoftwareSurfaceCache::load(const Pathname& filename)
+{
+  const std::string source_path = filename.get_sys_path();
+
+  int64_t  mtime;
+  uint64_t size;
+  if (!get_source_stat(source_path, &mtime, &size))
+  {
+    return SoftwareSurfacePtr();
+  }
+  else
+  {
+    const Pathname cache_filename = get_cache_filename(filename);
+    if (!cache_filename.exists())
+    {
+      return SoftwareSurfacePtr();
+    }
+    else
+    {
+      MappedFilePtr mapping;
+      try
+      {
+        mapping = MappedFile::open(cache_filename.get_sys_path());
+      }
+      catch(const std::exception& err)
+      {
+        std::cout << "SoftwareSurfaceCache: " << err.what() << std::endl;
+        return SoftwareSurfacePtr();
+      }
+
+      if (mapping->get_size() < sizeof(CacheHeader))
+      {
+        return SoftwareSurfacePtr();
+      }
+      else
+      {
+        CacheHeader header;
+        memcpy(&header, mapping->get_data(), sizeof(header));
+
+        const size_t data_size = static_cast<size_t>(header.pitch) * header.height;
+
+        if (memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 ||
+            header.version      != cache_version ||
+            header.byte_order   != cache_byte_order ||
+            header.source_mtime != mtime ||
+            header.source_size  != size ||
+            (header.bytes_per_pixel != 3 && header.bytes_per_pixel != 4) ||
+            header.data_offset < sizeof(header) + header.path_length ||
+            mapping->get_size() < header.data_offset + data_size ||
+            source_path.compare(0, std::string::npos,
+                                mapping->get_data() + sizeof(header), header.path_length) != 0)
+        { // stale, or written for another file whose path flattens to
+          // the same cache name, the stored source path tells them apart
+          return SoftwareSurfacePtr();
+        }
+        else
+        {
+          SDL_Surface* surface;
+          const int width  = static_cast<int>(header.width);
+          const int height = static_cast<int>(header.height);
+          const int pitch  = static_cast<int>(header.pitch);
+          void* pixels     = mapping->get_data() + header.data_offset;
+
+          if (header.bytes_per_pixel == 4)
+          {
+            if (is_little_endian())
+            {
+              surface = SDL_CreateRGBSurfaceFrom(pixels, width, height, 32, pitch,
+                                                 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+            }
+            else
+            {
+              surface = SDL_CreateRGBSurfaceFrom(pixels, width, height, 32, pitch,
+                                                 0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff);
+            }
+          }
+          else
+          {
+            if (is_little_endian())
+            {
+              surface = SDL_CreateRGBSurfaceFrom(pixels, width, height, 24, pitch,
+                                                 0x0000ff, 0x00ff00, 0xff0000, 0);
+            }
+            else
+            {
+              surface = SDL_CreateRGBSurfaceFrom(pixels, width, height, 24, pitch,
+                                                 0xff0000, 0x00ff00, 0x0000ff, 0);
+            }
+          }
+
+          if (!surface)
+          {
+            return SoftwareSurfacePtr();
+          }
+          else
+          {
+            SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+            return SoftwareSurfacePtr(new SoftwareSurface(surface,
+                                                          (header.bytes_per_pixel == 4)
+                                                          ? SoftwareSurface::RGBA
+                                                          : SoftwareSurface::RGB,
+                                                          mapping));
+          }
+        }
+      }
+    }
+  }
+}
+
+void
+SoftwareSurfaceCache::store(const Pathname& filename, SoftwareSurfacePtr surface)
+{
+  const std::string source_path = filename.get_sys_path();
+
+  CacheHeader header;
+  memset(&header, 0, sizeof(header));
+
+  if (!get_source_stat(source_path, &header.source_mtime, &header.source_size))
+  {
+    return;
+  }
+  else
+  {
+    memcpy(header.magic, cache_magic, sizeof(cache_magic));
+    header.version         = cache_version;
+    header.byte_order      = cache_byte_order;
+    header.width           = static_cast<uint32_t>(surface->get_width());
+    header.height          = static_cast<uint32_t>(surface->get_height());
+    header.pitch           = static_cast<uint32_t>(surface->get_pitch());
+    header.bytes_per_pixel = static_cast<uint32_t>(surface->get_bytes_per_pixel());
+    header.path_length     = static_cast<uint32_t>(source_path.size());
+    // keep the pixel data 16 byte aligned
+    header.data_offset     = static_cast<uint32_t>((sizeof(header) + source_path.size() + 15) & ~15u);
+
+    const std::string cache_path = get_cache_filename(filename).get_sys_path();
+    std::string tmp_path;
+
+    try
+    {
+      boost::filesystem::create_directories(boost::filesystem::path(cache_path).parent_path());
+    }
+    catch(const std::exception& err)
+    {
+      std::cout << "SoftwareSurfaceCache: " << err.what() << std::endl;
+      return;
+    }
+
+    // writers of the same entry each get their own temp file, the
+    // last rename() wins
+    FILE* fp = System::create_temp_file(cache_path, tmp_path);
+    if (!fp)
+    {
+      std::cout << "SoftwareSurfaceCache: couldn't write " << cache_path << ": " << strerror(errno) << std::endl;
+      return;
+    }
+    else
+    {
+      const char padding[16] = { 0 };
+      const uint8_t* pixels  = static_cast<const uint8_t*>(surface->get_pixels());
+
+      bool success = 
+        fwrite(&header, sizeof(header), 1, fp) == 1 &&
+        fwrite(source_path.data(), 1, source_path.size(), fp) == source_path.size() &&
+        fwrite(padding, 1, header.data_offset - sizeof(header) - source_path.size(), fp) == 
+        header.data_offset - sizeof(header) - source_path.size() &&
+        fwrite(pixels, header.pitch, header.height, fp) == header.height;
+
+      success = (fclose(fp) == 0) && success;
+
+#ifdef _WIN32
+      remove(cache_path.c_str());
+#endif
+      if (!success || rename(tmp_path.c_str(), cache_path.c_str()) != 0)
+      {
+        std::cout << "SoftwareSurfaceCache: couldn't write " << cache_path << std::endl;
+        remove(tmp_path.c_str());
+      }
+    }
+  }
+}
+
+/* EOF */
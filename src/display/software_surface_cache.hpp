@@ -0,0 +1,59 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_DISPLAY_SOFTWARE_SURFACE_CACHE_HPP
+#define HEADER_WINDSTILLE_DISPLAY_SOFTWARE_SURFACE_CACHE_HPP
+
+#include "display/software_surface.hpp"
+
+/**
+ * Keeps decoded images in the user directory, already converted to
+ * the canonical RGB/RGBA byte order, so that later runs can map them
+ * straight into memory instead of decoding the PNG/JPEG again. A
+ * cache entry is only used when it was written for the same source
+ * path and the modification time and size of the source file still
+ * match.
+ */
+class SoftwareSurfaceCache
+{
+public:
+  static void set_enabled(bool enabled);
+  static bool is_enabled();
+
+  /** Returns the cached surface for \a filename or an empty pointer
+      when there is no valid cache entry */
+  static SoftwareSurfacePtr load(const Pathname& filename);
+
+  /** Writes \a surface to the cache, errors are reported but not
+      thrown as the cache is only an optimization */
+  static void store(const Pathname& filename, SoftwareSurfacePtr surface);
+
+private:
+  static bool s_enabled;
+
+  static Pathname get_cache_filename(const Pathname& filename);
+
+private:
+  SoftwareSurfaceCache();
+  SoftwareSurfaceCache(const SoftwareSurfaceCache&);
+  SoftwareSurfaceCache& operator=(const SoftwareSurfaceCache&);
+};
+
+#endif
+
+/* EOF */
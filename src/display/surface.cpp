@@ -19,6 +19,7 @@
 #include "display/surface.hpp"
 
 #include "display/opengl_state.hpp"
+#include "display/software_rasterizer.hpp"
 #include "math/quad.hpp"
 #include "display/surface_drawing_parameters.hpp"
 #include "display/surface_manager.hpp"
@@ -165,5 +166,28 @@ Surface::draw(const SurfaceDrawingParameters& params) const
 
   glEnd(); 
 }
+
+void
+Surface::rasterize(SoftwareRasterizer& rasterizer, const SurfaceDrawingParameters& params,
+                   const Matrix& modelview) const
+{
+  Rectf uv = m_uv;
+
+  if (params.hflip)
+    std::swap(uv.left, uv.right);
+
+  if (params.vflip)
+    std::swap(uv.top, uv.bottom);
+
+  Quad quad(params.pos.x, 
+            params.pos.y,
+            params.pos.x + m_size.width  * params.scale.x, 
+            params.pos.y + m_size.height * params.scale.y);
+
+  quad.rotate(params.angle);
+
+  rasterizer.draw_quad(quad, uv, params.color, m_texture,
+                       params.blendfunc_src, params.blendfunc_dst, modelview);
+}
 
 /* EOF */
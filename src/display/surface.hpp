@@ -20,9 +20,11 @@
 #define HEADER_WINDSTILLE_DISPLAY_SURFACE_HPP
 
 #include "display/texture.hpp"
+#include "math/matrix.hpp"
 #include "math/rect.hpp"
 #include "util/pathname.hpp"
 
+class SoftwareRasterizer;
 class SurfaceDrawingParameters;
 class Surface;
 typedef boost::shared_ptr<Surface> SurfacePtr;
@@ -67,6 +69,10 @@ public:
   void draw(const Vector2f& pos) const;
   void draw(const SurfaceDrawingParameters& params) const;
 
+  /** Software counterpart of draw() */
+  void rasterize(SoftwareRasterizer& rasterizer, const SurfaceDrawingParameters& params,
+                 const Matrix& modelview) const;
+
 private:
   /**
    * Texture on which the surface is located
@@ -26,14 +26,15 @@
 
 #pragma GCC diagnostic ignored "-Wold-style-cast"
 
-SurfaceManager::SurfaceManager() :
+SurfaceManager::SurfaceManager(bool headless) :
   texture_packer(0),
-  surfaces()
+  m_cache(256 * 1024 * 1024),
+  m_headless(headless)
 {
   // NPOV should be ok with OpenGL2.0 in theory, but in practice there
   // is hardware that does OpenGL2.0, but not NPOV, see:
   // http://www.opengl.org/wiki/NPOT_Texture
-  if (!GLEW_ARB_texture_non_power_of_two)
+  if (!m_headless && !GLEW_ARB_texture_non_power_of_two)
   {
     texture_packer.reset(new TexturePacker(Size(2048, 2048)));
   }
@@ -41,35 +42,27 @@ SurfaceManager::SurfaceManager() :
 
 SurfaceManager::~SurfaceManager()
 {
-#if 0 
-  if (debug)
-  {
-    for(Surfaces::iterator i = surfaces.begin(); i != surfaces.end(); ++i)
-    {
-      //      if (i->second.use_count() > 1)
-      std::cerr << "Warning: Surface '" << i->first << "' not released.\n";
-    }
-  }
-#endif
 }
 
 SurfacePtr
 SurfaceManager::get(const Pathname& filename)
 {
-  Surfaces::iterator i = surfaces.find(filename);
+  SurfacePtr surface = m_cache.find(filename);
 
-  if(i != surfaces.end())
+  if (surface)
   { // Surface in cache, return it
-    return i->second;
+    return surface;
   }
   else
   {
     SoftwareSurfacePtr software_surface = SoftwareSurface::create(filename);
+    const size_t bytes = static_cast<size_t>(software_surface->get_width() * software_surface->get_height() *
+                                             software_surface->get_bytes_per_pixel());
 
     if (texture_packer)
     {
       SurfacePtr result = texture_packer->upload(software_surface);
-      surfaces.insert(std::make_pair(filename, result));
+      m_cache.insert(filename, result, bytes);
       return result;              
     }
     else
@@ -92,12 +85,18 @@ SurfaceManager::get(const Pathname& filename)
       SurfacePtr result = Surface::create(texture, Rectf(0.0f, 0.0f, maxu, maxv),
                                           Sizef(static_cast<float>(software_surface->get_width()),
                                                 static_cast<float>(software_surface->get_height())));
-      surfaces.insert(std::make_pair(filename, result));
+      m_cache.insert(filename, result, bytes);
       return result;
     }
   }
 }
 
+bool
+SurfaceManager::is_loaded(const Pathname& filename) const
+{
+  return m_cache.contains(filename);
+}
+
 void
 SurfaceManager::load_grid(const Pathname& filename,
                           std::vector<SurfacePtr>& out_surfaces,
@@ -140,6 +139,13 @@ TexturePtr
 SurfaceManager::create_texture(SoftwareSurfacePtr image,
                                float* maxu, float* maxv)
 {
+  if (m_headless)
+  {
+    *maxu = 1.0f;
+    *maxv = 1.0f;
+    return Texture::create_software(image);
+  }
+
   // OpenGL2.0 should be fine with non-power-of-two, but some
   // implementations aren't
   if (GLEW_ARB_texture_non_power_of_two)
@@ -169,15 +175,19 @@ SurfaceManager::create_texture(SoftwareSurfacePtr image,
 void
 SurfaceManager::cleanup()
 {
-  //std::cout << "SurfaceManager: size: " << surfaces.size() << std::endl;
-  for(Surfaces::iterator i = surfaces.begin(); i != surfaces.end(); ++i)
-  {
-    if (i->second.use_count() == 1)
-    {
-      //std::cout << "SurfaceManager: erasing a surface" << std::endl;
-      surfaces.erase(i);
-    }
-  }
+  m_cache.evict_unused();
+}
+
+void
+SurfaceManager::set_memory_budget(size_t bytes)
+{
+  m_cache.set_memory_budget(bytes);
+}
+
+const ResourceCacheStats&
+SurfaceManager::get_stats() const
+{
+  return m_cache.get_stats();
 }
 
 void
@@ -26,6 +26,7 @@
 
 #include "util/pathname.hpp"
 #include "util/currenton.hpp"
+#include "display/resource_cache.hpp"
 #include "display/texture.hpp"
 #include "display/surface.hpp"
 
@@ -38,17 +39,22 @@ class SurfaceManager : public Currenton<SurfaceManager>
 {
 private:
   boost::scoped_ptr<TexturePacker> texture_packer;
-  
-  typedef std::map<Pathname, SurfacePtr> Surfaces;
-  Surfaces surfaces;
+  ResourceCache<Surface> m_cache;
+  bool m_headless;
 
 public:
-  SurfaceManager();
+  /** A \a headless SurfaceManager works without an OpenGL context,
+      the surfaces it returns use Texture::create_software() and can
+      only be drawn with the Compositor::kSoftware backend */
+  SurfaceManager(bool headless = false);
   ~SurfaceManager();
 
   /** returns a surface containing the image specified with filename */
   SurfacePtr get(const Pathname& filename);
 
+  /** Returns true if get() can return \a filename without loading it */
+  bool is_loaded(const Pathname& filename) const;
+
   /**
    * Loads an image and splits it into several Surfaces sized width and height.
    * The created surfaces will be added to the surfaces vector.
@@ -59,10 +65,22 @@ public:
   TexturePtr create_texture(SoftwareSurfacePtr image,
                             float* maxu, float* maxv);
 
-  /** Removes all cached Sprites that are no longer in use */
+  /** Removes all cached Surfaces that are no longer in use */
   void cleanup();
 
+  /**
+   * Unused surfaces are evicted in least recently used order once
+   * the surfaces held by the manager exceed \a bytes
+   */
+  void set_memory_budget(size_t bytes);
+
+  const ResourceCacheStats& get_stats() const;
+
   void save_all_as_png() const;
+
+private:
+  SurfaceManager(const SurfaceManager&);
+  SurfaceManager& operator=(const SurfaceManager&);
 };
 
 #endif
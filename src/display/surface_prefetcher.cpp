@@ -0,0 +1,53 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "display/surface_prefetcher.hpp"
+
+SurfacePrefetcher::SurfacePrefetcher() :
+  m_surfaces()
+{
+}
+
+SurfacePrefetcher::~SurfacePrefetcher()
+{
+}
+
+void
+SurfacePrefetcher::add(const Pathname& filename, SoftwareSurfacePtr surface)
+{
+  m_surfaces[filename] = surface;
+}
+
+SoftwareSurfacePtr
+SurfacePrefetcher::take(const Pathname& filename)
+{
+  Surfaces::iterator it = m_surfaces.find(filename);
+  if (it == m_surfaces.end())
+  {
+    return SoftwareSurfacePtr();
+  }
+  else
+  {
+    SoftwareSurfacePtr surface = it->second;
+    m_surfaces.erase(it);
+    return surface;
+  }
+}
+
+/* EOF */
@@ -0,0 +1,63 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef HEADER_WINDSTILLE_DISPLAY_SURFACE_PREFETCHER_HPP
+#define HEADER_WINDSTILLE_DISPLAY_SURFACE_PREFETCHER_HPP
+
+#include <map>
+
+#include "display/software_surface.hpp"
+#include "util/currenton.hpp"
+#include "util/pathname.hpp"
+
+/**
+ * Holds images that were decoded ahead of time, usually by worker
+ * threads. While a SurfacePrefetcher is current, SoftwareSurface::create()
+ * takes the images from it instead of decoding them again, which
+ * leaves only the texture upload to the main thread.
+ *
+ * The SurfacePrefetcher itself must only be used from the main
+ * thread, images that were never taken are dropped with it.
+ */
+class SurfacePrefetcher : public Currenton<SurfacePrefetcher>
+{
+private:
+  typedef std::map<Pathname, SoftwareSurfacePtr> Surfaces;
+  Surfaces m_surfaces;
+
+public:
+  SurfacePrefetcher();
+  ~SurfacePrefetcher();
+
+  void add(const Pathname& filename, SoftwareSurfacePtr surface);
+
+  /** Returns and forgets the image for \a filename, or an empty
+      pointer if there is none */
+  SoftwareSurfacePtr take(const Pathname& filename);
+
+  size_t size() const { return m_surfaces.size(); }
+
+private:
+  SurfacePrefetcher(const SurfacePrefetcher&);
+  SurfacePrefetcher& operator=(const SurfacePrefetcher&);
+};
+
+#endif
+
+/* EOF */
@@ -31,6 +31,14 @@
 #include "util/util.hpp"
 
 #pragma GCC diagnostic ignored "-Wold-style-cast"
+
+bool Texture::s_keep_software_surfaces = false;
+
+void
+Texture::set_keep_software_surfaces(bool keep)
+{
+  s_keep_software_surfaces = keep;
+}
 
 TexturePtr
 Texture::create(const Pathname& filename)
@@ -49,12 +57,19 @@ Texture::create(GLenum target, int width, int height, GLint format)
 {
   return TexturePtr(new Texture(target, width, height, format));
 }
+
+TexturePtr
+Texture::create_software(SoftwareSurfacePtr image)
+{
+  return TexturePtr(new Texture(image));
+}
 
 Texture::Texture() :
   m_target(0),
   m_handle(0),
   m_width(0),
-  m_height(0)
+  m_height(0),
+  m_software_surface()
 {
   glGenTextures(1, &m_handle);
   assert_gl("Texture::Texture()"); 
@@ -64,7 +79,8 @@ Texture::Texture(GLenum target, int width, int height, GLint format) :
   m_target(target),
   m_handle(0),
   m_width(width),
-  m_height(height)
+  m_height(height),
+  m_software_surface()
 {
   if (!GLEW_ARB_texture_non_power_of_two)
   {
@@ -98,7 +114,8 @@ Texture::Texture(SoftwareSurfacePtr image, GLint glformat) :
   m_target(GL_TEXTURE_2D),
   m_handle(0),
   m_width(image->get_width()),
-  m_height(image->get_height())
+  m_height(image->get_height()),
+  m_software_surface()
 {
   glGenTextures(1, &m_handle);
   assert_gl("Texture::Texture()"); 
@@ -183,11 +200,28 @@ Texture::Texture(SoftwareSurfacePtr image, GLint glformat) :
   {
     throw;
   }
+
+  if (s_keep_software_surfaces)
+  {
+    m_software_surface = image;
+  }
+}
+
+Texture::Texture(SoftwareSurfacePtr image) :
+  m_target(GL_TEXTURE_2D),
+  m_handle(0),
+  m_width(image->get_width()),
+  m_height(image->get_height()),
+  m_software_surface(image)
+{
 }
 
 Texture::~Texture()
 {
-  glDeleteTextures(1, &m_handle);
+  if (m_handle)
+  {
+    glDeleteTextures(1, &m_handle);
+  }
 }
 
 int
@@ -226,6 +260,15 @@ Texture::put(SoftwareSurfacePtr image, const Rect& srcrect, int x, int y)
     throw std::runtime_error("Texture: SoftwareSurface format not supported");
   }
 
+  if (!m_handle)
+  { // software only texture, the image is the texture content
+    image->blit(srcrect, m_software_surface, x, y);
+    return;
+  }
+
+  // the kept image no longer matches the texture content
+  m_software_surface.reset();
+
   glBindTexture(GL_TEXTURE_2D, m_handle);
 
   // FIXME: Add some checks here to make sure image has the right format 
@@ -249,32 +292,45 @@ Texture::put(SoftwareSurfacePtr image, int x, int y)
 void
 Texture::set_wrap(GLenum mode)
 {
-  glBindTexture(GL_TEXTURE_2D, m_handle);
+  if (m_handle)
+  {
+    glBindTexture(GL_TEXTURE_2D, m_handle);
 
-  glTexParameteri(m_target, GL_TEXTURE_WRAP_S, mode);
-  glTexParameteri(m_target, GL_TEXTURE_WRAP_T, mode);
-  glTexParameteri(m_target, GL_TEXTURE_WRAP_R, mode); // FIXME: only good for 3d textures?!
+    glTexParameteri(m_target, GL_TEXTURE_WRAP_S, mode);
+    glTexParameteri(m_target, GL_TEXTURE_WRAP_T, mode);
+    glTexParameteri(m_target, GL_TEXTURE_WRAP_R, mode); // FIXME: only good for 3d textures?!
+  }
 }
 
 void
 Texture::set_filter(GLenum mode)
 {
-  glBindTexture(GL_TEXTURE_2D, m_handle);
+  if (m_handle)
+  {
+    glBindTexture(GL_TEXTURE_2D, m_handle);
 
-  glTexParameteri(m_target, GL_TEXTURE_MIN_FILTER, mode);
-  glTexParameteri(m_target, GL_TEXTURE_MAG_FILTER, mode);
+    glTexParameteri(m_target, GL_TEXTURE_MIN_FILTER, mode);
+    glTexParameteri(m_target, GL_TEXTURE_MAG_FILTER, mode);
+  }
 }
 
 SoftwareSurfacePtr
 Texture::get_software_surface() const
 {
-  glBindTexture(GL_TEXTURE_2D, m_handle);
+  if (m_software_surface)
+  {
+    return m_software_surface;
+  }
+  else
+  {
+    glBindTexture(GL_TEXTURE_2D, m_handle);
 
-  SoftwareSurfacePtr surface = SoftwareSurface::create(m_width, m_height);
+    SoftwareSurfacePtr surface = SoftwareSurface::create(m_width, m_height);
 
-  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, surface->get_pixels());
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, surface->get_pixels());
 
-  return surface;
+    return surface;
+  }
 }
 
 GLenum
@@ -45,10 +45,22 @@ public:
   
   /** Create an empty Texture with the given dimensions */
   static TexturePtr create(GLenum target, int width, int height, GLint format = GL_RGBA);
+
+  /** Create a Texture that only holds \a image in memory and never
+      touches OpenGL, so it works without a GL context. Such textures
+      can only be drawn by the Compositor::kSoftware backend. */
+  static TexturePtr create_software(SoftwareSurfacePtr image);
+
+  /** When enabled, textures created from a SoftwareSurface keep it
+      around, so that get_software_surface() doesn't have to read the
+      pixels back from OpenGL, used by the SoftwareRasterizer */
+  static void set_keep_software_surfaces(bool keep);
+  static bool get_keep_software_surfaces() { return s_keep_software_surfaces; }
   
 private:
   Texture();
-  Texture(SoftwareSurfacePtr image, GLint format = GL_RGBA);
+  Texture(SoftwareSurfacePtr image, GLint format);
+  explicit Texture(SoftwareSurfacePtr image);
   Texture(GLenum target, int width, int height, GLint format = GL_RGBA);
 
 public:
@@ -71,6 +83,8 @@ public:
       coordinates */
   void put(SoftwareSurfacePtr image, const Rect& srcrect, int x, int y);
 
+  /** Returns the OpenGL texture object, 0 for textures created with
+      create_software() */
   GLuint get_handle() const;
   
   /**
@@ -85,6 +99,13 @@ private:
   GLuint m_handle;
   int    m_width;
   int    m_height;
+
+  /** The image the texture was created from, only kept when
+      set_keep_software_surfaces() is enabled or when the texture was
+      created with create_software() */
+  SoftwareSurfacePtr m_software_surface;
+
+  static bool s_keep_software_surfaces;
 };
 
 #endif
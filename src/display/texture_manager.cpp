@@ -21,39 +21,41 @@
 #include "display/texture.hpp"
 #include "display/software_surface.hpp"
 
-TextureManager::TextureManager() :
-  textures()
+TextureManager::TextureManager(bool headless) :
+  m_cache(256 * 1024 * 1024),
+  m_headless(headless)
 {
 }
 
 TextureManager::~TextureManager()
 {
-#if 0
-  if(debug)
-  {
-    for(Textures::iterator i = textures.begin(); i != textures.end(); ++i) {
-      std::cerr << "Warning: Texture '" << i->first << "' not released.\n";
-    }
-  }
-#endif
 }
 
 TexturePtr
 TextureManager::get(const Pathname& filename)
 {
-  Textures::iterator i = textures.find(filename);
-  if(i != textures.end())
+  TexturePtr texture = m_cache.find(filename);
+  if (texture)
   {
-    return i->second;
+    return texture;
   }
   else
   {
     try 
     {
       SoftwareSurfacePtr image = SoftwareSurface::create(filename);
-      TexturePtr texture = Texture::create(image);
+      if (m_headless)
+      {
+        texture = Texture::create_software(image);
+      }
+      else
+      {
+        texture = Texture::create(image);
+      }
 
-      textures.insert(std::make_pair(filename, texture));
+      m_cache.insert(filename, texture,
+                     static_cast<size_t>(image->get_width() * image->get_height() *
+                                         image->get_bytes_per_pixel()));
 
       return texture;
     } 
@@ -68,16 +70,19 @@ TextureManager::get(const Pathname& filename)
 void
 TextureManager::cleanup()
 {
-  //std::cout << "TextureManager: size: " << textures.size() << std::endl;
-  for(Textures::iterator i = textures.begin(); i != textures.end(); ++i)
-  {
-    std::cout << "TextureManager: use count: " << i->second.use_count() << std::endl;
-    if (i->second.use_count() == 1)
-    {
-      //std::cout << "TextureManager: erasing a texture" << std::endl;
-      textures.erase(i);
-    }
-  }
+  m_cache.evict_unused();
+}
+
+void
+TextureManager::set_memory_budget(size_t bytes)
+{
+  m_cache.set_memory_budget(bytes);
+}
+
+const ResourceCacheStats&
+TextureManager::get_stats() const
+{
+  return m_cache.get_stats();
 }
 
 /* EOF */
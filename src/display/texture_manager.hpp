@@ -23,6 +23,7 @@
 #include <map>
 #include <GL/glew.h>
 
+#include "display/resource_cache.hpp"
 #include "display/texture.hpp"
 #include "util/currenton.hpp"
 #include "util/pathname.hpp"
@@ -33,7 +34,9 @@
 class TextureManager : public Currenton<TextureManager>
 {
 public:
-  TextureManager();
+  /** A \a headless TextureManager works without an OpenGL context and
+      returns textures created with Texture::create_software() */
+  TextureManager(bool headless = false);
   ~TextureManager();
 
   /**
@@ -46,11 +49,24 @@ public:
    */
   TexturePtr get(const Pathname& filename);
 
+  /** Removes all cached Textures that are no longer in use */
   void cleanup();
 
+  /**
+   * Unused textures are evicted in least recently used order once
+   * the textures held by the manager exceed \a bytes
+   */
+  void set_memory_budget(size_t bytes);
+
+  const ResourceCacheStats& get_stats() const;
+
+private:
+  ResourceCache<Texture> m_cache;
+  bool m_headless;
+
 private:
-  typedef std::map<Pathname, TexturePtr> Textures;
-  Textures textures;
+  TextureManager(const TextureManager&);
+  TextureManager& operator=(const TextureManager&);
 };
 
 #endif
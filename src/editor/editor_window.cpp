@@ -18,7 +18,7 @@
 
 #include "editor/editor_window.hpp"
 
-#include <fstream>
+#include <boost/filesystem.hpp>
 #include <iostream>
 #include <gdkmm/pixbuf.h>
 #include <glibmm/miscutils.h>
@@ -53,6 +53,8 @@
 #include "editor/timeline_object.hpp"
 #include "editor/timeline_sound_object.hpp"
 #include "editor/timeline_widget.hpp"
+#include "util/file_writer.hpp"
+#include "util/pathname.hpp"
 
 EditorWindow::EditorWindow(const Glib::RefPtr<const Gdk::GL::Config>& glconfig_) :
   vbox(),
@@ -390,6 +392,8 @@ EditorWindow::EditorWindow(const Glib::RefPtr<const Gdk::GL::Config>& glconfig_)
 
   notebook.signal_switch_page().connect(sigc::mem_fun(*this, &EditorWindow::on_switch_page));
 
+  Glib::signal_timeout().connect_seconds(sigc::mem_fun(*this, &EditorWindow::on_autosave), 60);
+
   // Disable unimplemented stuff:
   action_group->get_action("Undo")->set_sensitive(false);
   action_group->get_action("Redo")->set_sensitive(false);
@@ -556,10 +560,17 @@ EditorWindow::on_save()
     }
     else
     {
-      std::ofstream out(wst->get_filename().c_str());
-      FileWriter writer(out);
-      wst->get_document().get_sector_model().write(writer);
-      print("Wrote: " + wst->get_filename());
+      try
+      {
+        FileWriter writer(wst->get_filename());
+        wst->get_document().get_sector_model().write(writer);
+        writer.commit();
+        print("Wrote: " + wst->get_filename());
+      }
+      catch(const std::exception& err)
+      {
+        print(err.what());
+      }
     }
   }
 }
@@ -591,10 +602,17 @@ EditorWindow::on_save_as()
         //          << std::endl;
 
         std::string filename = dialog.get_filename();
-        std::ofstream out(filename.c_str());
-        FileWriter writer(out);
-
-        wst->get_document().get_sector_model().write(writer);
+        try
+        {
+          FileWriter writer(filename);
+          wst->get_document().get_sector_model().write(writer);
+          writer.commit();
+        }
+        catch(const std::exception& err)
+        {
+          print(err.what());
+          break;
+        }
         wst->set_filename(filename);
 
         int page = notebook.get_current_page();
@@ -997,6 +1015,35 @@ EditorWindow::on_timeout()
   return true;
 }
 
+bool
+EditorWindow::on_autosave()
+{
+  for(int page = 0; page < notebook.get_n_pages(); ++page)
+  {
+    Gtk::VPaned* paned = dynamic_cast<Gtk::VPaned*>(notebook.get_nth_page(page));
+    WindstilleWidget* wst = paned ? dynamic_cast<WindstilleWidget*>(paned->get_child1()) : 0;
+    if (wst && wst->needs_autosave())
+    {
+      const std::string filename = Pathname("autosave/" + wst->get_autosave_name(),
+                                            Pathname::kUserPath).get_sys_path();
+      try
+      {
+        boost::filesystem::create_directories(boost::filesystem::path(filename).parent_path());
+
+        FileWriter writer(filename);
+        wst->get_document().get_sector_model().write(writer);
+        writer.commit();
+        wst->set_autosaved();
+      }
+      catch(const std::exception& err)
+      {
+        print(std::string("Autosave failed: ") + err.what());
+      }
+    }
+  }
+  return true;
+}
+
 void
 EditorWindow::on_layer_toggle(int layer, bool status_)
 {
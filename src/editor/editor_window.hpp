@@ -114,6 +114,10 @@ public:
   bool on_timeout();
   void on_play();
 
+  /** Writes every document changed since the last autosave to the
+      autosave/ directory in the user path */
+  bool on_autosave();
+
   void on_about_clicked();
   void on_quit();
 
@@ -30,6 +30,7 @@
 #include "sprite2d/manager.hpp"
 #include "display/texture_manager.hpp"
 #include "display/surface_manager.hpp"
+#include "display/framebuffer_pool.hpp"
 #include "editor/editor_window.hpp"
 #include "editor/main.hpp"
 #include "util/log.hpp"
@@ -93,6 +94,7 @@ WindstilleEditor::main(int argc, char** argv)
 
     TextureManager texture_manager;
     SurfaceManager surface_manager;
+    FramebufferPool framebuffer_pool;
     SpriteManager  sprite2d_manager;
 
     Glib::RefPtr<Gtk::IconTheme> icon_theme = Gtk::IconTheme::get_default();
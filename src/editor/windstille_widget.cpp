@@ -21,9 +21,11 @@
 #include <GL/glu.h>
 #include <gtkmm.h>
 #include <boost/bind.hpp>
+#include <sstream>
 
 #include "display/compositor.hpp"
 #include "display/display.hpp"
+#include "display/framebuffer_pool.hpp"
 #include "display/opengl_state.hpp"
 #include "display/surface.hpp"
 #include "display/surface_manager.hpp"
@@ -39,8 +41,15 @@
 #include "scenegraph/scene_graph.hpp"
 #include "sprite2d/sprite.hpp"
 #include "util/pathname.hpp"
+#include "util/system.hpp"
 
 bool lib_init = false;
+
+namespace {
+
+int next_autosave_id = 1;
+
+} // namespace
 
 WindstilleWidget::WindstilleWidget(EditorWindow& editor_,
                                    const Glib::RefPtr<const Gdk::GL::Config>&  glconfig,
@@ -49,6 +58,8 @@ WindstilleWidget::WindstilleWidget(EditorWindow& editor_,
   m_document(new Document),
   m_scene_graph(new SceneGraph()),
   m_rebuild_scene_graph(true),
+  m_autosave_needed(false),
+  m_autosave_id(next_autosave_id++),
   filename(),
   state(),
   compositor(),
@@ -140,6 +151,9 @@ WindstilleWidget::on_realize()
 
   if (glwindow->gl_begin(get_gl_context()))
   {
+    // each widget has a GL context of its own
+    FramebufferPool::current()->set_context(this);
+
     if (!lib_init)
     {
       lib_init = true;
@@ -176,6 +190,25 @@ WindstilleWidget::on_realize()
   }
 }
 
+void
+WindstilleWidget::on_unrealize()
+{
+  Glib::RefPtr<Gdk::GL::Window> glwindow = get_gl_window();
+
+  if (glwindow->gl_begin(get_gl_context()))
+  {
+    // framebuffers are not shared between contexts, so they go
+    // together with this one
+    compositor.reset();
+    sc.reset();
+    FramebufferPool::current()->release_context(this);
+
+    glwindow->gl_end();
+  }
+
+  Gtk::DrawingArea::on_unrealize();
+}
+
 bool
 WindstilleWidget::on_configure_event(GdkEventConfigure* ev)
 {
@@ -193,6 +226,8 @@ WindstilleWidget::on_configure_event(GdkEventConfigure* ev)
   }
   else
   {
+    FramebufferPool::current()->set_context(this);
+
     if (compositor.get())
     {
       compositor.reset(new Compositor(Size(ev->width, ev->height),
@@ -224,6 +259,7 @@ WindstilleWidget::on_expose_event(GdkEventExpose* /*event*/)
   }
   else
   {
+    FramebufferPool::current()->set_context(this);
     draw();
 
     // Swap buffers.
@@ -583,10 +619,27 @@ void
 WindstilleWidget::on_document_change()
 {
   m_rebuild_scene_graph = true;
+  m_autosave_needed = true;
   EditorWindow::current()->update_undo_state();
   queue_draw();
 }
 
+std::string
+WindstilleWidget::get_autosave_name() const
+{
+  std::ostringstream name;
+  if (filename.empty())
+  {
+    name << "unsaved-sector-" << m_autosave_id << ".wst";
+  }
+  else
+  { // the whole path goes into the name, so that files of the same
+    // name in different directories don't overwrite each other
+    name << System::flatten_path(filename);
+  }
+  return name.str();
+}
+
 void
 WindstilleWidget::save_screenshot(const std::string& filename_)
 {
@@ -61,6 +61,12 @@ private:
   boost::scoped_ptr<SceneGraph> m_scene_graph;
   bool m_rebuild_scene_graph;
 
+  /** set when the document changed since the last autosave */
+  bool m_autosave_needed;
+
+  /** tells apart the autosaves of unsaved documents */
+  int m_autosave_id;
+
   std::string filename;
 
   GraphicContextState   state;
@@ -82,6 +88,7 @@ public:
   GraphicContextState& get_state() { return state; }
 
   virtual void on_realize();
+  virtual void on_unrealize();
   virtual bool on_timeout();
   virtual bool on_configure_event(GdkEventConfigure* event);
   virtual bool on_expose_event(GdkEventExpose* event);
@@ -129,6 +136,13 @@ public:
   std::string get_filename() const { return filename; }
   void set_filename(const std::string& filename_) { filename = filename_; }
 
+  bool needs_autosave() const { return m_autosave_needed; }
+  void set_autosaved() { m_autosave_needed = false; }
+
+  /** Filename for the autosave of the document, unique among the open
+      documents */
+  std::string get_autosave_name() const;
+
   void save_screenshot(const std::string& filename);
 
 private:
@@ -64,6 +64,9 @@ Camera::Camera() :
   mode(CAMERA_FOLLOW_PLAYER),
   pos(0, 0), 
   zoom(1.0f),
+  last_pos(0, 0),
+  last_zoom(1.0f),
+  path(),
   path_pos(0)
 {  
 }
@@ -122,6 +125,25 @@ Camera::update(float delta)
   }
 }
 
+void
+Camera::begin_step()
+{
+  last_pos  = pos;
+  last_zoom = zoom;
+}
+
+Vector2f
+Camera::get_interpolated_pos(float alpha) const
+{
+  return last_pos + (pos - last_pos) * alpha;
+}
+
+float
+Camera::get_interpolated_zoom(float alpha) const
+{
+  return last_zoom + (zoom - last_zoom) * alpha;
+}
+
 void
 Camera::set_pos(float x, float y)
 {
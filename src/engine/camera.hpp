@@ -63,6 +63,10 @@ private:
    */
   float  zoom;
 
+  /** position and zoom before the last update step */
+  Vector2f last_pos;
+  float    last_zoom;
+
   std::vector<PathPoint> path;
   float path_pos;
 
@@ -72,6 +76,15 @@ public:
   void   update(float delta);
 
   Vector2f get_pos() const { return pos; }
+
+  /** Remembers the current position and zoom, to be called before
+      each update step */
+  void   begin_step();
+
+  /** Position and zoom between the last and the current step, \a
+      alpha is the fraction of a step passed since the last one */
+  Vector2f get_interpolated_pos(float alpha) const;
+  float  get_interpolated_zoom(float alpha) const;
   void   set_pos(float x, float y);
 
   void   set_zoom(float zoom_);
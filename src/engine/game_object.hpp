@@ -104,6 +104,21 @@ public:
    * between 2 draw() calls or multiple draw() calls between 2 updates
    */
   virtual void update (float delta) {}
+
+  /**
+   * Return true if update() only touches the object's own state, so
+   * that it can run in parallel to the update() of other objects.
+   * Objects that are accessed by scripts, move through the collision
+   * engine or add and remove other objects must return false.
+   */
+  virtual bool is_thread_safe() const { return false; }
+
+  /**
+   * Called on the main thread right before update() for objects that
+   * are thread-safe, so that they can sample input, the view or other
+   * shared state there and hand it to update().
+   */
+  virtual void prepare_update() {}
     
   virtual void set_parent(GameObjectHandle parent) {}
 
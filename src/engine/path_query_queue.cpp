@@ -0,0 +1,196 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "engine/path_query_queue.hpp"
+
+#include "navigation/navigation_graph.hpp"
+
+void
+PathQueryQueue::BatchJob::run()
+{
+  for(std::vector<PathQuery*>::iterator i = queries.begin(); i != queries.end(); ++i)
+  {
+    PathQuery& query = **i;
+    query.found = search.find_path(*graph, query.from_end, query.to_end, query.cost, query.path);
+  }
+}
+
+PathQueryQueue::PathQueryQueue(NavigationGraph& graph) :
+  m_graph(graph),
+  m_path_finder(graph),
+  m_queries(),
+  m_queued(),
+  m_running(),
+  m_path_graph(),
+  m_jobs(),
+  m_job_system(0)
+{
+}
+
+PathQueryQueue::~PathQueryQueue()
+{
+  // the workers must be done with the queries before they get deleted
+  collect();
+}
+
+PathQueryHandle
+PathQueryQueue::request(const Vector2f& from, const Vector2f& to, const PathCost& cost)
+{
+  PathQueryHandle handle = m_queries.acquire(new PathQuery(from, to, cost));
+  m_queued.push_back(handle);
+  return handle;
+}
+
+bool
+PathQueryQueue::is_done(const PathQueryHandle& handle) const
+{
+  const PathQuery* query = m_queries.dereference(handle);
+  return query && !query->released && query->status == PathQuery::kDone;
+}
+
+bool
+PathQueryQueue::get_path(const PathQueryHandle& handle, Path& path) const
+{
+  if (is_done(handle) && handle->found)
+  {
+    path = handle->path;
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+void
+PathQueryQueue::release(const PathQueryHandle& handle)
+{
+  PathQuery* query = m_queries.dereference(handle);
+  if (query)
+  {
+    if (query->status == PathQuery::kRunning)
+    {
+      // a worker might still write to it, collect() deletes it
+      query->released = true;
+    }
+    else
+    {
+      m_queries.release(handle);
+    }
+  }
+}
+
+void
+PathQueryQueue::dispatch()
+{
+  if (m_queued.empty())
+    return;
+
+  // the jobs get reused, so the previous batch has to be finished
+  collect();
+
+  m_path_graph = m_path_finder.get_path_graph();
+
+  JobSystem* job_system = JobSystem::current();
+  const size_t num_jobs = job_system ? static_cast<size_t>(job_system->get_num_threads()) + 1 : 1;
+  while(m_jobs.size() < num_jobs)
+  {
+    m_jobs.push_back(boost::shared_ptr<BatchJob>(new BatchJob));
+  }
+
+  for(std::vector<boost::shared_ptr<BatchJob> >::iterator i = m_jobs.begin(); i != m_jobs.end(); ++i)
+  {
+    (*i)->graph = m_path_graph.get();
+    (*i)->queries.clear();
+  }
+
+  size_t next_job = 0;
+  for(std::vector<PathQueryHandle>::iterator i = m_queued.begin(); i != m_queued.end(); ++i)
+  {
+    PathQuery* query = m_queries.dereference(*i);
+    if (!query)
+      continue; // released before it got dispatched
+
+    // snapping reads the NavigationGraph, so it has to happen here and
+    // not in the workers
+    const EdgePosition from = m_graph.find_closest_position(query->from, query->cost.snap_radius);
+    const EdgePosition to   = m_graph.find_closest_position(query->to,   query->cost.snap_radius);
+
+    query->status   = PathQuery::kRunning;
+    query->revision = m_path_graph->get_revision();
+    query->found    = false;
+    query->path.clear();
+
+    if (m_path_graph->get_end(from, query->cost, query->from_end) &&
+        m_path_graph->get_end(to,   query->cost, query->to_end))
+    {
+      // round robin, so that the jobs get about the same amount of work
+      m_jobs[next_job]->queries.push_back(query);
+      next_job = (next_job + 1) % num_jobs;
+    }
+
+    m_running.push_back(*i);
+  }
+  m_queued.clear();
+
+  if (job_system)
+  {
+    for(size_t i = 0; i < num_jobs; ++i)
+    {
+      if (!m_jobs[i]->queries.empty())
+        job_system->push(m_jobs[i].get());
+    }
+    m_job_system = job_system;
+  }
+  else
+  {
+    m_jobs[0]->run();
+  }
+}
+
+void
+PathQueryQueue::collect()
+{
+  if (m_job_system)
+  {
+    m_job_system->wait();
+    m_job_system = 0;
+  }
+
+  for(std::vector<PathQueryHandle>::iterator i = m_running.begin(); i != m_running.end(); ++i)
+  {
+    PathQuery* query = m_queries.dereference(*i);
+    if (query)
+    {
+      query->status = PathQuery::kDone;
+      if (query->released)
+      {
+        m_queries.release(*i);
+      }
+    }
+  }
+  m_running.clear();
+
+  for(std::vector<boost::shared_ptr<BatchJob> >::iterator i = m_jobs.begin(); i != m_jobs.end(); ++i)
+  {
+    (*i)->queries.clear();
+  }
+  m_path_graph.reset();
+}
+
+/* EOF */
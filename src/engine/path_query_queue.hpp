@@ -0,0 +1,166 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_ENGINE_PATH_QUERY_QUEUE_HPP
+#define HEADER_WINDSTILLE_ENGINE_PATH_QUERY_QUEUE_HPP
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+#include "math/vector2f.hpp"
+#include "navigation/path_finder.hpp"
+#include "util/handle.hpp"
+#include "util/job_system.hpp"
+
+class NavigationGraph;
+
+struct PathQuery
+{
+  enum Status { kQueued, kRunning, kDone };
+
+  PathQuery(const Vector2f& from_, const Vector2f& to_, const PathCost& cost_) :
+    from(from_),
+    to(to_),
+    cost(cost_),
+    status(kQueued),
+    found(false),
+    path(),
+    revision(-1),
+    released(false),
+    from_end(),
+    to_end()
+  {}
+
+  Vector2f from;
+  Vector2f to;
+  PathCost cost;
+
+  Status status;
+
+  /** The result, only valid once the status is kDone */
+  bool found;
+  Path path;
+
+  /** Revision of the graph the path was searched in, if the graph has
+      changed since, the nodes of the path might be gone */
+  int revision;
+
+  /** The owner let go of the query while it was running */
+  bool released;
+
+  PathEnd from_end;
+  PathEnd to_end;
+};
+
+typedef Handle<PathQuery> PathQueryHandle;
+
+/**
+ * Runs path queries in batches on the JobSystem, so that a group of
+ * characters asking for a path in the same frame doesn't stall that
+ * frame. Queries are collected over a frame, dispatch() hands them to
+ * the workers together with a PathGraph copy of the NavigationGraph
+ * and collect() picks the results up in the next frame, the
+ * NavigationGraph can change freely in between.
+ *
+ * Each job keeps its own PathSearch, so the workers don't share any
+ * mutable state. Without a JobSystem the queries run serially in
+ * dispatch(), they are still reported as done only by collect().
+ *
+ * All functions must be called from the main thread.
+ */
+class PathQueryQueue
+{
+private:
+  class BatchJob : public Job
+  {
+  public:
+    BatchJob() : graph(0), queries(), search() {}
+
+    const PathGraph* graph;
+    std::vector<PathQuery*> queries;
+    PathSearch search;
+
+    void run();
+
+  private:
+    BatchJob(const BatchJob&);
+    BatchJob& operator=(const BatchJob&);
+  };
+
+  NavigationGraph& m_graph;
+  PathFinder m_path_finder;
+
+  HandleManager<PathQuery> m_queries;
+
+  /** queries waiting for the next dispatch() */
+  std::vector<PathQueryHandle> m_queued;
+
+  /** queries handed to the jobs, done with the next collect() */
+  std::vector<PathQueryHandle> m_running;
+
+  /** kept alive until the jobs using it are collected */
+  boost::shared_ptr<const PathGraph> m_path_graph;
+
+  /** one job per thread, kept for their search buffers */
+  std::vector<boost::shared_ptr<BatchJob> > m_jobs;
+
+  /** the JobSystem the jobs were pushed to, 0 if nothing is pending */
+  JobSystem* m_job_system;
+
+public:
+  PathQueryQueue(NavigationGraph& graph);
+  ~PathQueryQueue();
+
+  /** Queues a path query from \a from to \a to, both are moved onto
+      the graph within PathCost::snap_radius when the query gets
+      dispatched */
+  PathQueryHandle request(const Vector2f& from, const Vector2f& to,
+                          const PathCost& cost = PathCost());
+
+  /** Returns true once the result of \a query is available, a stale
+      handle is never done */
+  bool is_done(const PathQueryHandle& query) const;
+
+  /** Copies the result of \a query to \a path, returns false if there
+      is no result yet or no path was found */
+  bool get_path(const PathQueryHandle& query, Path& path) const;
+
+  /** Drops \a query, whether it is done or not, the handle becomes
+      stale */
+  void release(const PathQueryHandle& query);
+
+  /** Starts the work on all queued queries, to be called once per
+      frame after the game objects got updated */
+  void dispatch();
+
+  /** Waits for the queries of the last dispatch() and marks them as
+      done, to be called once per frame before the game objects get
+      updated */
+  void collect();
+
+  int get_num_queued()  const { return static_cast<int>(m_queued.size()); }
+  int get_num_running() const { return static_cast<int>(m_running.size()); }
+
+private:
+  PathQueryQueue(const PathQueryQueue&);
+  PathQueryQueue& operator=(const PathQueryQueue&);
+};
+
+#endif
+
+/* EOF */
@@ -30,6 +30,7 @@
 #include "app/console.hpp"
 #include "scripting/game_objects.hpp"
 #include "scripting/squirrel_error.hpp"
+#include "util/profiler.hpp"
 
 using Scripting::SquirrelError;
 
@@ -219,6 +220,8 @@ ScriptManager::run_script_file(const Pathname& filename, bool global)
 void
 ScriptManager::update()
 {
+  ProfileScope profile_scope("ScriptManager::update");
+
   for(SquirrelThreads::iterator i = squirrel_vms.begin(); i != squirrel_vms.end(); ++i)
   {
     (*i)->update();
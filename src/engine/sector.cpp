@@ -21,20 +21,50 @@
 #include <sstream>
 
 #include "collision/collision_engine.hpp"
+#include "engine/path_query_queue.hpp"
 #include "engine/sector_builder.hpp"
 #include "engine/squirrel_thread.hpp"
+#include "math/random.hpp"
 #include "navigation/navigation_graph.hpp"
 #include "objects/doll.hpp"
 #include "objects/player.hpp"
 #include "scenegraph/navigation_graph_drawable.hpp"
+#include "scenegraph/particle_batcher.hpp"
 #include "scenegraph/scene_graph.hpp"
 #include "sound/sound_manager.hpp"
 #include "tile/tile_map.hpp"
+#include "util/job_system.hpp"
+#include "util/profiler.hpp"
+
+namespace {
+
+class UpdateJob : public Job
+{
+private:
+  GameObject* m_object;
+  float m_delta;
+
+public:
+  UpdateJob(GameObject* object, float delta) :
+    m_object(object),
+    m_delta(delta)
+  {}
+
+  void run()
+  {
+    m_object->update(m_delta);
+  }
+};
+
+} // namespace
 
-Sector::Sector(const Pathname& arg_filename) :
+Sector::Sector(const Pathname& arg_filename,
+               const SectorBuilder::ProgressCallback& progress) :
   collision_engine(new CollisionEngine()),
   navigation_graph(new NavigationGraph()),
+  path_queries(new PathQueryQueue(*navigation_graph)),
   scene_graph(new SceneGraph()),
+  particle_batcher(new ParticleBatcher(*scene_graph)),
   filename(arg_filename),
   name(),
   music(),
@@ -47,7 +77,11 @@ Sector::Sector(const Pathname& arg_filename) :
   interactivebackground_tilemap(0),
   player()
 {
-  SectorBuilder(arg_filename, *this);
+  // the objects of the sector get their streams handed out anew, so
+  // that each load replays the same random sequences
+  Random::set_seed(Random::get_seed());
+
+  SectorBuilder(arg_filename, *this, progress);
 
   if (interactive_tilemap)
   {
@@ -114,17 +148,51 @@ void Sector::commit_adds()
 
 void Sector::update(float delta)
 {
+  ProfileScope profile_scope("Sector::update");
+
   commit_adds();
 
+  // the paths requested last frame were searched while it got drawn
+  path_queries->collect();
+
   collision_engine->update(delta);
 
+  for(Objects::iterator i = objects.begin(); i != objects.end(); ++i)
+  {
+    if ((*i)->is_active() && (*i)->is_thread_safe())
+      (*i)->prepare_update();
+  }
+
+  JobSystem* job_system = JobSystem::current();
+  if (job_system)
+  {
+    // thread-safe objects are updated first and all at once, the
+    // rest follows serially in their usual order
+    std::vector<UpdateJob> jobs;
+    for(Objects::iterator i = objects.begin(); i != objects.end(); ++i)
+    {
+      if ((*i)->is_active() && (*i)->is_thread_safe())
+        jobs.push_back(UpdateJob(i->get(), delta));
+    }
+
+    for(std::vector<UpdateJob>::iterator i = jobs.begin(); i != jobs.end(); ++i)
+    {
+      job_system->push(&*i);
+    }
+    job_system->wait();
+  }
+
   for(Objects::iterator i = objects.begin(); i != objects.end(); ++i) 
   {
-    if ((*i)->is_active())
+    if ((*i)->is_active() && !(job_system && (*i)->is_thread_safe()))
       (*i)->update(delta);
   }
 
   commit_removes();
+
+  // searched by the workers while the frame gets drawn, picked up by
+  // the collect() above in the next frame
+  path_queries->dispatch();
 }
 
 void
@@ -26,6 +26,7 @@
 
 #include "display/color.hpp"
 #include "engine/game_object_handle.hpp"
+#include "engine/sector_builder.hpp"
 #include "util/currenton.hpp"
 #include "util/pathname.hpp"
 
@@ -34,6 +35,8 @@ class Entity;
 class FileReader;
 class GameObject;
 class NavigationGraph;
+class ParticleBatcher;
+class PathQueryQueue;
 class Player;
 class SceneContext;
 class SpawnPoint;
@@ -47,7 +50,9 @@ class Sector : public Currenton<Sector>
 private:
   boost::scoped_ptr<CollisionEngine> collision_engine;
   boost::scoped_ptr<NavigationGraph> navigation_graph;
+  boost::scoped_ptr<PathQueryQueue>  path_queries;
   boost::scoped_ptr<SceneGraph>      scene_graph;
+  boost::scoped_ptr<ParticleBatcher> particle_batcher;
 
   Pathname filename;
   std::string name;
@@ -80,7 +85,9 @@ private:
   void commit_removes();
 
 public:
-  Sector(const Pathname& filename);
+  /** \a progress gets called while the sector loads, see SectorBuilder */
+  Sector(const Pathname& filename,
+         const SectorBuilder::ProgressCallback& progress = SectorBuilder::ProgressCallback());
   ~Sector();
 
   Pathname get_filename() const;
@@ -108,8 +115,12 @@ public:
 
   CollisionEngine* get_collision_engine() const { return collision_engine.get(); }
   SceneGraph& get_scene_graph() const { return *scene_graph; }
+  ParticleBatcher& get_particle_batcher() const { return *particle_batcher; }
   NavigationGraph& get_navigation_graph() const { return *navigation_graph; }
 
+  /** Path queries requested in one frame are answered in the next */
+  PathQueryQueue& get_path_queries() const { return *path_queries; }
+
   GameObject* get_object(const std::string& name) const;
 
   const std::vector<boost::shared_ptr<GameObject> >& get_objects() { return objects; }
@@ -18,6 +18,8 @@
 
 #include "engine/sector_builder.hpp"
 
+#include <algorithm>
+#include <set>
 #include <string>
 #include <iostream>
 #include <sstream>
@@ -25,18 +27,179 @@
 
 #include "app/globals.hpp"
 #include "display/color.hpp"
+#include "display/software_surface.hpp"
+#include "display/surface_manager.hpp"
+#include "display/surface_prefetcher.hpp"
 #include "engine/game_object.hpp"
 #include "engine/object_factory.hpp"
 #include "engine/sector.hpp"
 #include "navigation/navigation_graph.hpp"
 #include "tile/tile_map.hpp"
 #include "util/file_reader.hpp"
+#include "util/job_system.hpp"
+#include "util/util.hpp"
 
-SectorBuilder::SectorBuilder(const Pathname& filename, Sector& sector) :
+namespace {
+
+bool is_image(const std::string& filename)
+{
+  return has_suffix(filename, ".png") || has_suffix(filename, ".jpg");
+}
+
+} // namespace
+
+/** Finds the images and .sprite files an object refers to */
+class SectorBuilder::ScanJob : public Job
+{
+public:
+  /** \a reader_ must not be used by anybody else while the job runs */
+  ScanJob(const FileReader& reader_) :
+    reader(reader_),
+    images(),
+    sprites()
+  {}
+
+  void run()
+  {
+    try
+    {
+      std::vector<std::string> strings;
+      reader.collect_strings(strings);
+
+      for(std::vector<std::string>::const_iterator i = strings.begin(); i != strings.end(); ++i)
+      {
+        if (is_image(*i))
+        {
+          images.push_back(Pathname(*i));
+        }
+        else if (has_suffix(*i, ".sprite"))
+        {
+          sprites.push_back(Pathname(*i));
+        }
+      }
+    }
+    catch(const std::exception&)
+    {
+      // the object runs into the same error when it gets constructed
+      // and reports it then
+    }
+  }
+
+  FileReader reader;
+  std::vector<Pathname> images;
+
+  /** scanned afterwards by a SpriteJob each, so that a sprite used by
+      many objects only gets parsed once */
+  std::vector<Pathname> sprites;
+
+private:
+  ScanJob(const ScanJob&);
+  ScanJob& operator=(const ScanJob&);
+};
+
+/** Finds the images a .sprite file refers to */
+class SectorBuilder::SpriteJob : public Job
+{
+public:
+  SpriteJob(const Pathname& sprite_) :
+    sprite(sprite_),
+    images()
+  {}
+
+  void run()
+  {
+    try
+    {
+      if (sprite.exists())
+      {
+        std::vector<std::string> strings;
+        FileReader::parse(sprite).collect_strings(strings);
+        for(std::vector<std::string>::const_iterator i = strings.begin(); i != strings.end(); ++i)
+        {
+          if (is_image(*i))
+          {
+            // images of a sprite are relative to the sprite
+            Pathname path = sprite.get_dirname();
+            path.append_path(*i);
+            images.push_back(path);
+          }
+        }
+      }
+    }
+    catch(const std::exception&)
+    {
+      // reported when the sprite gets loaded for real
+    }
+  }
+
+  Pathname sprite;
+  std::vector<Pathname> images;
+};
+
+class SectorBuilder::DecodeJob : public Job
+{
+public:
+  DecodeJob(const Pathname& filename_) :
+    filename(filename_),
+    surface()
+  {}
+
+  void run()
+  {
+    try
+    {
+      surface = SoftwareSurface::create(filename);
+    }
+    catch(const std::exception&)
+    {
+      // reported when the image gets loaded for real
+    }
+  }
+
+  Pathname filename;
+  SoftwareSurfacePtr surface;
+};
+
+class SectorBuilder::NavgraphJob : public Job
+{
+public:
+  NavgraphJob(SectorBuilder& builder_, const FileReader& reader_) :
+    builder(builder_),
+    reader(reader_),
+    error()
+  {}
+
+  void run()
+  {
+    try
+    {
+      builder.parse_navgraph(reader);
+    }
+    catch(const std::exception& err)
+    {
+      error = err.what();
+    }
+  }
+
+  SectorBuilder& builder;
+  FileReader reader;
+
+  /** rethrown on the main thread */
+  std::string error;
+
+private:
+  NavgraphJob(const NavgraphJob&);
+  NavgraphJob& operator=(const NavgraphJob&);
+};
+
+SectorBuilder::SectorBuilder(const Pathname& filename, Sector& sector,
+                             const ProgressCallback& progress) :
   m_filename(filename),
   m_sector(sector),
+  m_progress(progress),
   id_table(),
-  parent_table()
+  parent_table(),
+  m_objects()
 {
   FileReader reader = FileReader::parse(m_filename);
   if(reader.get_name() != "windstille-sector") 
@@ -72,13 +235,139 @@ SectorBuilder::parse_body(const FileReader& reader)
   {
     m_sector.set_ambient_light(ambient_light);
   }
-    
-  parse_objects(reader);
-  parse_navgraph(reader);
+
+  collect_objects(reader);
+
+  // The jobs only get sections of their own, as a FileReader must not
+  // be used by two threads at once. The navigation graph isn't
+  // touched by anything else while loading, so it can be built right
+  // away.
+  FileReader navgraph_reader;
+  if (!reader.get("navigation", navgraph_reader))
+  {
+    // throw std::runtime_error("SectorBuilder: 'navigation' section missing");
+    std::cout << "SectorBuilder: 'navigation' section missing" << std::endl;
+  }
+  NavgraphJob navgraph_job(*this, navgraph_reader);
+
+  std::vector<boost::shared_ptr<ScanJob> > scan_jobs;
+  std::vector<Job*> jobs;
+  jobs.push_back(&navgraph_job);
+  for(std::vector<FileReader>::iterator i = m_objects.begin(); i != m_objects.end(); ++i)
+  {
+    scan_jobs.push_back(boost::shared_ptr<ScanJob>(new ScanJob(*i)));
+    jobs.push_back(scan_jobs.back().get());
+  }
+  run_jobs(jobs, 0.0f, 0.05f);
+
+  if (!navgraph_job.error.empty())
+  {
+    throw std::runtime_error(navgraph_job.error);
+  }
+
+  std::set<Pathname> sprites;
+  std::vector<Pathname> scanned_images;
+  for(std::vector<boost::shared_ptr<ScanJob> >::iterator i = scan_jobs.begin(); i != scan_jobs.end(); ++i)
+  {
+    sprites.insert((*i)->sprites.begin(), (*i)->sprites.end());
+    scanned_images.insert(scanned_images.end(), (*i)->images.begin(), (*i)->images.end());
+  }
+  scan_jobs.clear();
+
+  std::vector<boost::shared_ptr<SpriteJob> > sprite_jobs;
+  jobs.clear();
+  for(std::set<Pathname>::iterator i = sprites.begin(); i != sprites.end(); ++i)
+  {
+    sprite_jobs.push_back(boost::shared_ptr<SpriteJob>(new SpriteJob(*i)));
+    jobs.push_back(sprite_jobs.back().get());
+  }
+  run_jobs(jobs, 0.05f, 0.1f);
+
+  for(std::vector<boost::shared_ptr<SpriteJob> >::iterator i = sprite_jobs.begin(); i != sprite_jobs.end(); ++i)
+  {
+    scanned_images.insert(scanned_images.end(), (*i)->images.begin(), (*i)->images.end());
+  }
+  sprite_jobs.clear();
+
+  // every image gets decoded once, images that are still loaded from
+  // the last sector don't need decoding at all
+  std::set<Pathname> images;
+  for(std::vector<Pathname>::iterator i = scanned_images.begin(); i != scanned_images.end(); ++i)
+  {
+    if (!SurfaceManager::current() || !SurfaceManager::current()->is_loaded(*i))
+      images.insert(*i);
+  }
+
+  std::vector<boost::shared_ptr<DecodeJob> > decode_jobs;
+  jobs.clear();
+  for(std::set<Pathname>::iterator i = images.begin(); i != images.end(); ++i)
+  {
+    decode_jobs.push_back(boost::shared_ptr<DecodeJob>(new DecodeJob(*i)));
+    jobs.push_back(decode_jobs.back().get());
+  }
+  run_jobs(jobs, 0.1f, 0.6f);
+
+  // the objects need an OpenGL context and access the Sector, so they
+  // get constructed here, but only have to upload their images
+  SurfacePrefetcher prefetcher;
+  for(std::vector<boost::shared_ptr<DecodeJob> >::iterator i = decode_jobs.begin(); i != decode_jobs.end(); ++i)
+  {
+    if ((*i)->surface)
+      prefetcher.add((*i)->filename, (*i)->surface);
+  }
+  decode_jobs.clear();
+
+  for(size_t i = 0; i < m_objects.size(); ++i)
+  {
+    parse_object(m_objects[i]);
+    report_progress(0.6f, 1.0f, i + 1, m_objects.size());
+  }
+  m_objects.clear();
+
+  resolve_parents();
+}
+
+void
+SectorBuilder::run_jobs(const std::vector<Job*>& jobs, float begin, float end)
+{
+  JobSystem* job_system = JobSystem::current();
+  if (!job_system)
+  {
+    for(size_t i = 0; i < jobs.size(); ++i)
+    {
+      jobs[i]->run();
+      report_progress(begin, end, i + 1, jobs.size());
+    }
+  }
+  else
+  {
+    // the jobs go out in batches, so that the progress can be reported
+    // in between
+    const size_t batch_size = 4 * (static_cast<size_t>(job_system->get_num_threads()) + 1);
+    for(size_t i = 0; i < jobs.size(); i += batch_size)
+    {
+      const size_t batch_end = std::min(jobs.size(), i + batch_size);
+      for(size_t j = i; j < batch_end; ++j)
+      {
+        job_system->push(jobs[j]);
+      }
+      job_system->wait();
+      report_progress(begin, end, batch_end, jobs.size());
+    }
+  }
+}
+
+void
+SectorBuilder::report_progress(float begin, float end, size_t done, size_t total)
+{
+  if (m_progress)
+  {
+    m_progress(begin + (end - begin) * static_cast<float>(done) / static_cast<float>(total));
+  }
 }
 
 void
-SectorBuilder::parse_layer(const FileReader& reader)
+SectorBuilder::collect_layer(const FileReader& reader)
 {
   FileReader objects_reader;
 
@@ -88,16 +377,15 @@ SectorBuilder::parse_layer(const FileReader& reader)
   }
   else
   {
-    std::vector<FileReader> objects_readers = objects_reader.get_sections();
-    for(std::vector<FileReader>::iterator i = objects_readers.begin(); i != objects_readers.end(); ++i)
+    for(FileReader::SectionIterator i(objects_reader); i.next(); )
     {
-      parse_object(*i);
+      collect_object(*i);
     }
   }
 }
 
 void
-SectorBuilder::parse_objects(const FileReader& reader)
+SectorBuilder::collect_objects(const FileReader& reader)
 {
   FileReader objects_reader;
 
@@ -109,24 +397,41 @@ SectorBuilder::parse_objects(const FileReader& reader)
   }
   else
   {
-    std::vector<FileReader> objects_readers = objects_reader.get_sections();
-    for(std::vector<FileReader>::iterator i = objects_readers.begin(); i != objects_readers.end(); ++i)
+    for(FileReader::SectionIterator i(objects_reader); i.next(); )
     {
-      parse_object(*i);
+      collect_object(*i);
     }
+  }
+}
+
+void
+SectorBuilder::collect_object(const FileReader& reader)
+{
+  if (reader.get_name() == "layer")
+  {
+    collect_layer(reader);
+  }
+  else
+  {
+    // the copy keeps the SectionIterator from reusing the reader
+    m_objects.push_back(reader);
+  }
+}
 
-    // Set the parents properly
-    for(std::map<GameObjectHandle, std::string>::iterator i = parent_table.begin(); i != parent_table.end(); ++i)
+void
+SectorBuilder::resolve_parents()
+{
+  // Set the parents properly
+  for(std::map<GameObjectHandle, std::string>::iterator i = parent_table.begin(); i != parent_table.end(); ++i)
+  {
+    std::map<std::string, GameObjectHandle>::iterator j = id_table.find(i->second);
+    if (j == id_table.end())
     {
-      std::map<std::string, GameObjectHandle>::iterator j = id_table.find(i->second);
-      if (j == id_table.end())
-      {
-        std::cout << "Error: Couldn't resolve 'id': " << i->second << std::endl;
-      }
-      else
-      {
-        i->first->set_parent(j->second);
-      }
+      std::cout << "Error: Couldn't resolve 'id': " << i->second << std::endl;
+    }
+    else
+    {
+      i->first->set_parent(j->second);
     }
   }
 }
@@ -155,10 +460,6 @@ SectorBuilder::parse_object(const FileReader& reader)
   {
     // TODO
   }
-  else if(reader.get_name() == "layer")
-  {    
-    parse_layer(reader);
-  }
   else 
   {
     obj = ObjectFactory::create(reader);
@@ -188,68 +489,57 @@ SectorBuilder::parse_object(const FileReader& reader)
 }
 
 void
-SectorBuilder::parse_navgraph(const FileReader& reader)
+SectorBuilder::parse_navgraph(const FileReader& navgraph_reader)
 {
   std::map<std::string, NodeHandle> id_to_node;
 
-  FileReader navgraph_reader;
-  if (!reader.get("navigation", navgraph_reader))
-  {
-    // throw std::runtime_error("SectorBuilder: 'navigation' section missing");
-    std::cout << "SectorBuilder: 'navigation' section missing" << std::endl;
-  }
-  else
+  FileReader nodes_reader;
+  if (navgraph_reader.get("nodes", nodes_reader))
   {
-    FileReader nodes_reader;
-    if (navgraph_reader.get("nodes", nodes_reader))
+    for(FileReader::SectionIterator i(nodes_reader); i.next(); )
     {
-      const std::vector<FileReader>& nodes_readers = nodes_reader.get_sections();
-      for(std::vector<FileReader>::const_iterator i = nodes_readers.begin(); i != nodes_readers.end(); ++i)
+      if (i->get_name() != "navgraph-node")
       {
-        if (i->get_name() != "navgraph-node")
-        {
-          std::cout << "SectorBuilder::parse_navgraph(): Unknown nodes tag: " << i->get_name() << std::endl;
-        }
-        else
+        std::cout << "SectorBuilder::parse_navgraph(): Unknown nodes tag: " << i->get_name() << std::endl;
+      }
+      else
+      {
+        Vector2f pos;
+        if (i->get("pos", pos))
         {
-          Vector2f pos;
-          if (i->get("pos", pos))
+          NodeHandle node = m_sector.get_navigation_graph().add_node(pos);
+          std::string id;
+          if (i->get("id", id))
           {
-            NodeHandle node = m_sector.get_navigation_graph().add_node(pos);
-            std::string id;
-            if (i->get("id", id))
-            {
-              id_to_node[id] = node;
-            }
+            id_to_node[id] = node;
           }
         }
       }
     }
+  }
 
-    FileReader edges_reader;
-    if (navgraph_reader.get("edges", edges_reader))
+  FileReader edges_reader;
+  if (navgraph_reader.get("edges", edges_reader))
+  {
+    for(FileReader::SectionIterator i(edges_reader); i.next(); )
     {
-      const std::vector<FileReader>& edges_readers = edges_reader.get_sections();
-      for(std::vector<FileReader>::const_iterator i = edges_readers.begin(); i != edges_readers.end(); ++i)
+      if (i->get_name() != "navgraph-edge")
       {
-        if (i->get_name() != "navgraph-edge")
-        {
-          std::cout << "SectorBuilder::parse_navgraph(): Unknown edges tag: " << i->get_name() << std::endl;
-        }
-        else
+        std::cout << "SectorBuilder::parse_navgraph(): Unknown edges tag: " << i->get_name() << std::endl;
+      }
+      else
+      {
+        std::string lhs_node;
+        std::string rhs_node;
+        if (i->get("lhs-node", lhs_node) &&
+            i->get("rhs-node", rhs_node))
         {
-          std::string lhs_node;
-          std::string rhs_node;
-          if (i->get("lhs-node", lhs_node) &&
-              i->get("rhs-node", rhs_node))
+          std::map<std::string, NodeHandle>::iterator lhs = id_to_node.find(lhs_node);
+          std::map<std::string, NodeHandle>::iterator rhs = id_to_node.find(rhs_node);
+          if (lhs != id_to_node.end() &&
+              rhs != id_to_node.end())
           {
-            std::map<std::string, NodeHandle>::iterator lhs = id_to_node.find(lhs_node);
-            std::map<std::string, NodeHandle>::iterator rhs = id_to_node.find(rhs_node);
-            if (lhs != id_to_node.end() &&
-                rhs != id_to_node.end())
-            {
-              m_sector.get_navigation_graph().add_edge(lhs->second, rhs->second);
-            }
+            m_sector.get_navigation_graph().add_edge(lhs->second, rhs->second);
           }
         }
       }
@@ -19,33 +19,66 @@
 #ifndef HEADER_WINDSTILLE_ENGINE_SECTOR_BUILDER_HPP
 #define HEADER_WINDSTILLE_ENGINE_SECTOR_BUILDER_HPP
 
+#include <boost/function.hpp>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "engine/game_object_handle.hpp"
+#include "util/file_reader.hpp"
 
-class FileReader;
-class GameObject;
+class Job;
 class Pathname;
 class Sector;
 
+/**
+ * Builds a Sector from a .wst file. Loading runs as a small task
+ * graph: the file is parsed once, then the images used by the objects
+ * are looked up and decoded on the JobSystem, with the navigation
+ * graph being built alongside. Only the construction of the objects,
+ * which has to upload their textures, is left to the main thread and
+ * happens in file order once all images are decoded.
+ */
 class SectorBuilder
 {
+public:
+  /** Called on the main thread with the progress of loading, from 0
+      to 1, e.g. to draw a loading screen */
+  typedef boost::function<void (float)> ProgressCallback;
+
 private:
+  class ScanJob;
+  class SpriteJob;
+  class DecodeJob;
+  class NavgraphJob;
+
   const Pathname& m_filename;
   Sector&  m_sector;
+  ProgressCallback m_progress;
   std::map<std::string, GameObjectHandle> id_table;
   std::map<GameObjectHandle, std::string> parent_table;
 
+  /** the sections of the objects in file order, with the layers
+      flattened */
+  std::vector<FileReader> m_objects;
+
 public:
-  SectorBuilder(const Pathname& filename, Sector& sector);
+  SectorBuilder(const Pathname& filename, Sector& sector,
+                const ProgressCallback& progress = ProgressCallback());
   
 private:
   void parse_body(const FileReader& reader);
-  void parse_layer(const FileReader& reader);
-  void parse_objects(const FileReader& reader);
+  void collect_layer(const FileReader& reader);
+  void collect_objects(const FileReader& reader);
+  void collect_object(const FileReader& reader);
   void parse_object(const FileReader& reader);
   void parse_navgraph(const FileReader& reader);
+  void resolve_parents();
+
+  /** Runs \a jobs on the JobSystem, reporting the progress from \a
+      begin to \a end along the way */
+  void run_jobs(const std::vector<Job*>& jobs, float begin, float end);
+  void report_progress(float begin, float end, size_t done, size_t total);
 
 private:
   SectorBuilder(const SectorBuilder&);
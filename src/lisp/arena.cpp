@@ -0,0 +1,146 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "lisp/arena.hpp"
+
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
+
+namespace lisp
+{
+
+namespace {
+
+const size_t kMaxChunkSize = 1024 * 1024;
+
+/** FNV-1a */
+size_t hash_symbol(const char* str, size_t length)
+{
+  uint32_t hash = 2166136261U;
+  for(size_t i = 0; i < length; ++i)
+  {
+    hash ^= static_cast<unsigned char>(str[i]);
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+} // namespace
+
+Arena::Arena(size_t chunk_size) :
+  m_chunks(),
+  m_pos(0),
+  m_end(0),
+  m_chunk_size(chunk_size),
+  m_allocated(0),
+  m_symbols(),
+  m_num_symbols(0)
+{
+}
+
+Arena::~Arena()
+{
+  for(std::vector<char*>::iterator i = m_chunks.begin(); i != m_chunks.end(); ++i)
+  {
+    delete[] *i;
+  }
+}
+
+void*
+Arena::allocate_chunk(size_t size)
+{
+  // new[] returns memory aligned for any type, so the start of a chunk
+  // needs no padding
+  if (size > m_chunk_size / 4)
+  { // big allocations get a chunk of their own, so the rest of the
+    // current chunk isn't wasted
+    char* chunk = new char[size];
+    m_chunks.push_back(chunk);
+    m_allocated += size;
+    return chunk;
+  }
+  else
+  {
+    char* chunk = new char[m_chunk_size];
+    m_chunks.push_back(chunk);
+
+    m_pos = chunk + size;
+    m_end = chunk + m_chunk_size;
+    m_allocated += size;
+
+    m_chunk_size = std::min(m_chunk_size * 2, kMaxChunkSize);
+
+    return chunk;
+  }
+}
+
+size_t
+Arena::find_slot(const char* str, size_t length) const
+{
+  const size_t mask = m_symbols.size() - 1;
+  size_t slot = hash_symbol(str, length) & mask;
+  while(m_symbols[slot].str &&
+        !(m_symbols[slot].length == length && memcmp(m_symbols[slot].str, str, length) == 0))
+  {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+const char*
+Arena::intern(const char* str, size_t length)
+{
+  // keep the table at most half full, so that probe sequences stay short
+  if (2 * (m_num_symbols + 1) > m_symbols.size())
+  {
+    std::vector<Symbol> old_symbols(std::max(static_cast<size_t>(64), 2 * m_symbols.size()));
+    m_symbols.swap(old_symbols);
+    for(std::vector<Symbol>::iterator i = old_symbols.begin(); i != old_symbols.end(); ++i)
+    {
+      if (i->str)
+        m_symbols[find_slot(i->str, i->length)] = *i;
+    }
+  }
+
+  const size_t slot = find_slot(str, length);
+  if (!m_symbols[slot].str)
+  {
+    char* symbol = allocate_bytes(length + 1);
+    memcpy(symbol, str, length);
+    symbol[length] = '\0';
+
+    m_symbols[slot] = Symbol(symbol, length);
+    m_num_symbols += 1;
+  }
+
+  return m_symbols[slot].str;
+}
+
+const char*
+Arena::find_symbol(const char* str) const
+{
+  if (m_symbols.empty())
+    return 0;
+  else
+    return m_symbols[find_slot(str, strlen(str))].str;
+}
+
+} // namespace lisp
+
+/* EOF */
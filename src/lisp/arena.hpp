@@ -0,0 +1,126 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_LISP_ARENA_HPP
+#define HEADER_WINDSTILLE_LISP_ARENA_HPP
+
+#include <stddef.h>
+#include <vector>
+
+namespace lisp
+{
+
+/**
+ * Bump allocator for the nodes, list arrays and strings of a parsed
+ * document. Memory is taken from large chunks and only given back all
+ * at once when the Arena is destroyed, no destructors are run. A Lisp
+ * allocated from an Arena must therefore never be deleted.
+ *
+ * The Arena also interns the symbols of the document, each symbol is
+ * stored once and symbols can be compared by pointer.
+ */
+class Arena
+{
+private:
+  enum { kAlignment = 8 };
+
+  std::vector<char*> m_chunks;
+  char* m_pos;
+  char* m_end;
+
+  /** size of the next chunk, doubles with each chunk up to a limit */
+  size_t m_chunk_size;
+  size_t m_allocated;
+
+  struct Symbol
+  {
+    const char* str;
+    size_t length;
+
+    Symbol() : str(0), length(0) {}
+    Symbol(const char* str_, size_t length_) : str(str_), length(length_) {}
+  };
+
+  /** open addressing hash table of the interned symbols, the size is
+      a power of two, the length is compared first, so that memcmp()
+      never reads past the end of a shorter symbol */
+  std::vector<Symbol> m_symbols;
+  size_t m_num_symbols;
+
+public:
+  Arena(size_t chunk_size = 16384);
+  ~Arena();
+
+  /** Returns \a size bytes aligned for any of the Lisp members */
+  void* allocate(size_t size)
+  {
+    const size_t offset = static_cast<size_t>(-reinterpret_cast<ptrdiff_t>(m_pos)) & (kAlignment - 1);
+    if (static_cast<size_t>(m_end - m_pos) < offset + size)
+    {
+      return allocate_chunk(size);
+    }
+    else
+    {
+      void* ptr = m_pos + offset;
+      m_pos += offset + size;
+      m_allocated += size;
+      return ptr;
+    }
+  }
+
+  /** Returns \a size bytes without alignment, for strings */
+  char* allocate_bytes(size_t size)
+  {
+    if (static_cast<size_t>(m_end - m_pos) < size)
+    {
+      return static_cast<char*>(allocate_chunk(size));
+    }
+    else
+    {
+      char* ptr = m_pos;
+      m_pos += size;
+      m_allocated += size;
+      return ptr;
+    }
+  }
+
+  /** Returns the copy of the symbol \a str of \a length bytes, which
+      is the same for all equal symbols */
+  const char* intern(const char* str, size_t length);
+
+  /** Returns the interned copy of \a str or 0 if there is none, which
+      means that no symbol in the document equals \a str */
+  const char* find_symbol(const char* str) const;
+
+  /** Bytes handed out so far */
+  size_t get_allocated() const { return m_allocated; }
+
+private:
+  void* allocate_chunk(size_t size);
+  size_t find_slot(const char* str, size_t length) const;
+
+private:
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+};
+
+} // namespace lisp
+
+#endif
+
+/* EOF */
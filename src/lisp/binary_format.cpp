@@ -0,0 +1,346 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "lisp/binary_format.hpp"
+
+#include <map>
+#include <new>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "lisp/arena.hpp"
+#include "lisp/lisp.hpp"
+
+namespace lisp
+{
+
+namespace {
+
+/** deeper lists are considered malformed, the text parser would
+    likely have run out of stack long before */
+const int max_depth = 1024;
+
+class TreeWriter
+{
+private:
+  std::string& m_out;
+  std::map<std::string, uint32_t> m_index;
+  std::vector<const char*> m_strings;
+
+public:
+  TreeWriter(std::string& out) :
+    m_out(out),
+    m_index(),
+    m_strings()
+  {}
+
+  void write(const Lisp* root)
+  {
+    collect(root);
+
+    write_uint32(static_cast<uint32_t>(m_strings.size()));
+    for(std::vector<const char*>::const_iterator i = m_strings.begin(); i != m_strings.end(); ++i)
+    {
+      const size_t length = strlen(*i);
+      write_uint32(static_cast<uint32_t>(length));
+      m_out.append(*i, length + 1);
+    }
+
+    write_node(root);
+  }
+
+private:
+  void collect(const Lisp* lisp)
+  {
+    switch(lisp->get_type())
+    {
+      case Lisp::TYPE_LIST:
+        for(size_t i = 0; i < lisp->get_list_size(); ++i)
+          collect(lisp->get_list_elem(i));
+        break;
+
+      case Lisp::TYPE_SYMBOL:
+        add_string(lisp->get_symbol());
+        break;
+
+      case Lisp::TYPE_STRING:
+        add_string(lisp->get_string());
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  void add_string(const char* str)
+  {
+    if (m_index.insert(std::make_pair(std::string(str), static_cast<uint32_t>(m_strings.size()))).second)
+      m_strings.push_back(str);
+  }
+
+  void write_node(const Lisp* lisp)
+  {
+    m_out += static_cast<char>(lisp->get_type());
+    switch(lisp->get_type())
+    {
+      case Lisp::TYPE_LIST:
+        write_uint32(static_cast<uint32_t>(lisp->get_list_size()));
+        for(size_t i = 0; i < lisp->get_list_size(); ++i)
+          write_node(lisp->get_list_elem(i));
+        break;
+
+      case Lisp::TYPE_SYMBOL:
+        write_uint32(m_index[lisp->get_symbol()]);
+        break;
+
+      case Lisp::TYPE_STRING:
+        write_uint32(m_index[lisp->get_string()]);
+        break;
+
+      case Lisp::TYPE_INT:
+        write_raw(lisp->get_int());
+        break;
+
+      case Lisp::TYPE_FLOAT:
+        write_raw(lisp->get_float());
+        break;
+
+      case Lisp::TYPE_BOOL:
+        m_out += static_cast<char>(lisp->get_bool() ? 1 : 0);
+        break;
+    }
+  }
+
+  void write_uint32(uint32_t value)
+  {
+    write_raw(value);
+  }
+
+  template<class T>
+  void write_raw(T value)
+  {
+    m_out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+private:
+  TreeWriter(const TreeWriter&);
+  TreeWriter& operator=(const TreeWriter&);
+};
+
+} // namespace
+
+class BinaryFormat::TreeReader
+{
+private:
+  const char* m_pos;
+  const char* m_end;
+  Arena& m_arena;
+
+  std::vector<const char*> m_strings;
+  std::vector<size_t> m_lengths;
+
+  /** interned on first use as symbol */
+  std::vector<const char*> m_symbols;
+
+public:
+  TreeReader(const char* data, size_t size, Arena& arena) :
+    m_pos(data),
+    m_end(data + size),
+    m_arena(arena),
+    m_strings(),
+    m_lengths(),
+    m_symbols()
+  {}
+
+  Lisp* read()
+  {
+    if (!read_strings())
+      return 0;
+
+    Lisp* root = read_node(0);
+    if (m_pos != m_end)
+      return 0;
+    else
+      return root;
+  }
+
+private:
+  bool read_strings()
+  {
+    uint32_t num_strings;
+    if (!read_raw(num_strings) || num_strings > static_cast<size_t>(m_end - m_pos) / 5)
+      return false;
+
+    // find the end of the table first, so that the whole of it can be
+    // copied into the arena at once
+    const char* begin = m_pos;
+    for(uint32_t i = 0; i < num_strings; ++i)
+    {
+      uint32_t length;
+      if (!read_raw(length) || length >= static_cast<size_t>(m_end - m_pos) || m_pos[length] != '\0')
+        return false;
+      m_pos += length + 1;
+    }
+
+    if (num_strings == 0)
+      return true;
+
+    const size_t table_size = static_cast<size_t>(m_pos - begin);
+    char* table = m_arena.allocate_bytes(table_size);
+    memcpy(table, begin, table_size);
+
+    m_strings.resize(num_strings);
+    m_lengths.resize(num_strings);
+    m_symbols.resize(num_strings, 0);
+
+    const char* pos = table;
+    for(uint32_t i = 0; i < num_strings; ++i)
+    {
+      uint32_t length;
+      memcpy(&length, pos, sizeof(length));
+      m_strings[i] = pos + sizeof(length);
+      m_lengths[i] = length;
+      pos += sizeof(length) + length + 1;
+    }
+
+    return true;
+  }
+
+  Lisp* read_node(int depth)
+  {
+    if (m_pos == m_end || depth > max_depth)
+      return 0;
+
+    const int type = static_cast<unsigned char>(*m_pos++);
+    switch(type)
+    {
+      case Lisp::TYPE_LIST:
+        {
+          uint32_t size;
+          // every element takes at least two bytes
+          if (!read_raw(size) || size > static_cast<size_t>(m_end - m_pos) / 2)
+            return 0;
+
+          Lisp** entries = static_cast<Lisp**>(m_arena.allocate(size * sizeof(Lisp*)));
+          for(uint32_t i = 0; i < size; ++i)
+          {
+            entries[i] = read_node(depth + 1);
+            if (!entries[i])
+              return 0;
+          }
+          return make_list(m_arena, entries, size);
+        }
+
+      case Lisp::TYPE_SYMBOL:
+        {
+          uint32_t index;
+          if (!read_raw(index) || index >= m_strings.size())
+            return 0;
+
+          if (!m_symbols[index])
+            m_symbols[index] = m_arena.intern(m_strings[index], m_lengths[index]);
+          return make_string(m_arena, Lisp::TYPE_SYMBOL, m_symbols[index]);
+        }
+
+      case Lisp::TYPE_STRING:
+        {
+          uint32_t index;
+          if (!read_raw(index) || index >= m_strings.size())
+            return 0;
+
+          return make_string(m_arena, Lisp::TYPE_STRING, m_strings[index]);
+        }
+
+      case Lisp::TYPE_INT:
+        {
+          int32_t value;
+          if (!read_raw(value))
+            return 0;
+          return new (m_arena.allocate(sizeof(Lisp))) Lisp(static_cast<int>(value));
+        }
+
+      case Lisp::TYPE_FLOAT:
+        {
+          float value;
+          if (!read_raw(value))
+            return 0;
+          return new (m_arena.allocate(sizeof(Lisp))) Lisp(value);
+        }
+
+      case Lisp::TYPE_BOOL:
+        if (m_pos == m_end)
+          return 0;
+        return new (m_arena.allocate(sizeof(Lisp))) Lisp(*m_pos++ != 0);
+
+      default:
+        return 0;
+    }
+  }
+
+  template<class T>
+  bool read_raw(T& value)
+  {
+    if (static_cast<size_t>(m_end - m_pos) < sizeof(value))
+    {
+      return false;
+    }
+    else
+    {
+      memcpy(&value, m_pos, sizeof(value));
+      m_pos += sizeof(value);
+      return true;
+    }
+  }
+
+private:
+  TreeReader(const TreeReader&);
+  TreeReader& operator=(const TreeReader&);
+};
+
+void
+BinaryFormat::write(const Lisp* root, std::string& out)
+{
+  TreeWriter writer(out);
+  writer.write(root);
+}
+
+Lisp*
+BinaryFormat::read(const char* data, size_t size, Arena& arena)
+{
+  TreeReader reader(data, size, arena);
+  return reader.read();
+}
+
+Lisp*
+BinaryFormat::make_string(Arena& arena, int type, const char* string)
+{
+  // shared by all equal strings and symbols, but never written to
+  return new (arena.allocate(sizeof(Lisp))) Lisp(static_cast<Lisp::LispType>(type), const_cast<char*>(string));
+}
+
+Lisp*
+BinaryFormat::make_list(Arena& arena, Lisp** entries, size_t size)
+{
+  return new (arena.allocate(sizeof(Lisp))) Lisp(entries, size);
+}
+
+} // namespace lisp
+
+/* EOF */
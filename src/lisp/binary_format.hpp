@@ -0,0 +1,74 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef HEADER_WINDSTILLE_LISP_BINARY_FORMAT_HPP
+#define HEADER_WINDSTILLE_LISP_BINARY_FORMAT_HPP
+
+#include <stddef.h>
+#include <string>
+
+namespace lisp
+{
+
+class Arena;
+class Lisp;
+
+/**
+ * Compact binary serialisation of a Lisp tree, which can be read back
+ * much faster than the text can be lexed and parsed. All strings and
+ * symbols are stored once in a string table, followed by the nodes in
+ * depth-first order, each a type byte and its payload:
+ *
+ *   list:           uint32 number of elements, then the elements
+ *   symbol, string: uint32 index into the string table
+ *   int, float:     4 bytes
+ *   bool:           1 byte
+ *
+ * Numbers are stored in the native byte order, the caller has to make
+ * sure that the data was written on the same kind of machine.
+ */
+class BinaryFormat
+{
+public:
+  /** Appends the serialised \a root to \a out */
+  static void write(const Lisp* root, std::string& out);
+
+  /** Rebuilds the tree stored in \a data in \a arena, returns 0 when
+      \a data is truncated or otherwise malformed */
+  static Lisp* read(const char* data, size_t size, Arena& arena);
+
+private:
+  class TreeReader;
+
+  /** take over \a string or \a entries, which live in the arena, only
+      BinaryFormat has access to these constructors of Lisp */
+  static Lisp* make_string(Arena& arena, int type, const char* string);
+  static Lisp* make_list(Arena& arena, Lisp** entries, size_t size);
+
+private:
+  BinaryFormat();
+  BinaryFormat(const BinaryFormat&);
+  BinaryFormat& operator=(const BinaryFormat&);
+};
+
+} // namespace lisp
+
+#endif
+
+/* EOF */
@@ -15,8 +15,12 @@
 //  along with this program; if not, write to the Free Software
 //  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+#include <ctype.h>
+#include <limits.h>
+#include <istream>
 #include <sstream>
 #include <stdexcept>
+#include <stdio.h>
 #include <string.h>
 
 #include "lisp/lexer.hpp"
@@ -29,7 +33,8 @@ class EOFException
 };
 
 Lexer::Lexer(std::istream& newstream) :
-  stream(newstream), eof(false), linenumber(0), bufend(0), c(0), token_length(0)
+  stream(&newstream), data(0), data_end(0), eof(false), linenumber(0), bufend(0), c(0),
+  token(token_string), token_length(0)
 {
   try {
     // trigger a refill of the buffer
@@ -40,6 +45,18 @@ Lexer::Lexer(std::istream& newstream) :
   }
 }
 
+Lexer::Lexer(const char* data_, size_t size) :
+  stream(0), data(data_), data_end(data_ + size), eof(false), linenumber(0), bufend(0), c(0),
+  token(token_string), token_length(0)
+{
+  try {
+    c = 0;
+    bufend = 0;
+    nextChar();
+  } catch(EOFException& e) {
+  }
+}
+
 Lexer::~Lexer()
 {
 }
@@ -51,8 +68,25 @@ Lexer::nextChar()
   if(c >= bufend) {
     if(eof)
       throw EOFException();
-    stream.read(buffer, BUFFER_SIZE);
-    size_t bytes_read = stream.gcount();
+
+    if(!stream) {
+      // the whole input is one chunk, followed by the extra ' ' below
+      if(data != data_end) {
+        c = data;
+        bufend = data_end;
+        data = data_end;
+        return;
+      }
+
+      eof = true;
+      buffer[0] = ' ';
+      c = buffer;
+      bufend = buffer + 1;
+      return;
+    }
+
+    stream->read(buffer, BUFFER_SIZE);
+    size_t bytes_read = static_cast<size_t>(stream->gcount());
     
     c = buffer;
     bufend = buffer + bytes_read;
@@ -60,14 +94,143 @@ Lexer::nextChar()
     // the following is a hack that appends an additional ' ' at the end of
     // the file to avoid problems when parsing symbols/elements and a sudden
     // EOF. This is faster than relying on unget and IMO also nicer.
-    if(bytes_read == 0 || stream.eof()) {
+    if(bytes_read == 0 || stream->eof()) {
       eof = true;
-      *bufend = ' ';
+      buffer[bytes_read] = ' ';
       ++bufend;
     }
   }
 }
 
+void
+Lexer::beginToken()
+{
+  // in buffer mode the token stays where it is, as long as it doesn't
+  // need to be changed
+  token = stream ? token_string : c;
+  token_length = 0;
+}
+
+void
+Lexer::appendChar(char ch)
+{
+  if(token != token_string) {
+    ++token_length; // ch is *c, right behind the token
+  } else if(token_length < MAX_TOKEN_LENGTH) {
+    token_string[token_length++] = ch;
+  }
+}
+
+void
+Lexer::copyToken()
+{
+  if(token != token_string) {
+    if(token_length > MAX_TOKEN_LENGTH)
+      token_length = MAX_TOKEN_LENGTH;
+    memcpy(token_string, token, static_cast<size_t>(token_length));
+    token = token_string;
+  }
+}
+
+const char*
+Lexer::getString() const
+{
+  if(token != token_string) {
+    const int len = token_length < MAX_TOKEN_LENGTH ? token_length : static_cast<int>(MAX_TOKEN_LENGTH);
+    memcpy(token_string, token, static_cast<size_t>(len));
+    token_string[len] = 0;
+  } else {
+    token_string[token_length] = 0;
+  }
+  return token_string;
+}
+
+int
+Lexer::getInteger() const
+{
+  const char* p   = token;
+  const char* end = token + token_length;
+
+  bool negative = false;
+  if(p != end && *p == '-') {
+    negative = true;
+    ++p;
+  }
+
+  // INT_MIN has no positive counterpart, so the magnitude is
+  // accumulated unsigned and checked against the limit of the sign
+  const unsigned int limit = negative
+    ? static_cast<unsigned int>(INT_MAX) + 1u
+    : static_cast<unsigned int>(INT_MAX);
+
+  unsigned int value = 0;
+  for(; p != end && isdigit(*p); ++p) {
+    const unsigned int digit = static_cast<unsigned int>(*p - '0');
+    if(value > (limit - digit) / 10) {
+      std::stringstream msg;
+      msg << "Parse Error in line " << linenumber << ": "
+          << "integer out of range: " << std::string(token, token_length);
+      throw std::runtime_error(msg.str());
+    }
+    value = value * 10 + digit;
+  }
+
+  if(negative && value != 0)
+    return -static_cast<int>(value - 1) - 1;
+  else
+    return static_cast<int>(value);
+}
+
+float
+Lexer::getReal() const
+{
+  // exactly representable as float
+  static const float powers_of_ten[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+  };
+
+  const char* p   = token;
+  const char* end = token + token_length;
+
+  bool negative = false;
+  if(p != end && *p == '-') {
+    negative = true;
+    ++p;
+  }
+
+  // As long as the digits fit into the 24 bit mantissa of a float and
+  // there are few enough decimals, a single division gives the
+  // correctly rounded result, everything else goes the slow way.
+  unsigned int mantissa = 0;
+  int decimals = 0;
+  bool point = false;
+  bool fast = true;
+  for(; p != end; ++p) {
+    if(isdigit(*p)) {
+      if(mantissa > (1u << 24) / 10 - 1) {
+        fast = false;
+        break;
+      }
+      mantissa = mantissa * 10 + static_cast<unsigned int>(*p - '0');
+      if(point)
+        ++decimals;
+    } else if(*p == '.' && !point) {
+      point = true;
+    } else {
+      break;
+    }
+  }
+
+  if(fast && decimals <= 10) {
+    const float value = static_cast<float>(mantissa) / powers_of_ten[decimals];
+    return negative ? -value : value;
+  } else {
+    float value = 0.0f;
+    sscanf(getString(), "%f", &value);
+    return value;
+  }
+}
+
 Lexer::TokenType
 Lexer::getNextToken()
 {
@@ -101,27 +264,31 @@ Lexer::getNextToken()
       case '"': {  // string
         int startline = linenumber;
         try {
-          while(1) {
-            nextChar();
-            if(*c == '"')
-              break;
-            else if(*c == '\n')
+          nextChar();
+          beginToken();
+          while(*c != '"') {
+            if(*c == '\n') {
               linenumber++;
-            else if(*c == '\\') {
+            } else if(*c == '\\') {
+              // the unescaped string differs from the input
+              copyToken();
               nextChar();
-              switch(*c) {
+              char ch = *c;
+              switch(ch) {
                 case 'n':
-                  *c = '\n';
+                  ch = '\n';
                   break;
                 case 't':
-                  *c = '\t';
+                  ch = '\t';
                   break;
               }
+              appendChar(ch);
+              nextChar();
+              continue;
             }
-            if(token_length < MAX_TOKEN_LENGTH)
-              token_string[token_length++] = *c;
+            appendChar(*c);
+            nextChar();
           }
-          token_string[token_length] = 0;
         } catch(EOFException& ) {
           std::stringstream msg;
           msg << "Parse error in line " << startline << ": "
@@ -134,13 +301,12 @@ Lexer::getNextToken()
       case '#': // constant
         try {
           nextChar();
+          beginToken();
           
           while(isalnum(*c) || *c == '_') {
-            if(token_length < MAX_TOKEN_LENGTH)
-              token_string[token_length++] = *c;
+            appendChar(*c);
             nextChar();
           }
-          token_string[token_length] = 0;
         } catch(EOFException& ) {
           std::stringstream msg;
           msg << "Parse Error in line " << linenumber << ": "
@@ -148,9 +314,9 @@ Lexer::getNextToken()
           throw std::runtime_error(msg.str());
         }
 
-        if(strcmp(token_string, "t") == 0)
+        if(token_length == 1 && token[0] == 't')
           return TOKEN_TRUE;
-        if(strcmp(token_string, "f") == 0)
+        if(token_length == 1 && token[0] == 'f')
           return TOKEN_FALSE;
 
         // we only handle #t and #f constants at the moment...
@@ -158,11 +324,12 @@ Lexer::getNextToken()
         {
           std::stringstream msg;
           msg << "Parse Error in line " << linenumber << ": "
-              << "Unknown constant '" << token_string << "'.";
+              << "Unknown constant '" << getString() << "'.";
           throw std::runtime_error(msg.str());
         }
 
       default:
+        beginToken();
         if(isdigit(*c) || *c == '-' || *c == '.') {
           bool have_nondigits = false;
           bool have_digits = false;
@@ -176,14 +343,10 @@ Lexer::getNextToken()
             else if(isalnum(*c) || *c == '_')
               have_nondigits = true;  
             
-            if(token_length < MAX_TOKEN_LENGTH)
-              token_string[token_length++] = *c;
-
+            appendChar(*c);
             nextChar();
           } while(!isspace(*c) && !strchr(delims, *c));
 
-          token_string[token_length] = 0;
-          
           // no nextChar
 
           if(have_nondigits || !have_digits || have_floating_point > 1)
@@ -194,11 +357,9 @@ Lexer::getNextToken()
             return TOKEN_INTEGER;
         } else {
           do {
-            if(token_length < MAX_TOKEN_LENGTH)
-              token_string[token_length++] = *c;
+            appendChar(*c);
             nextChar();
           } while(!isspace(*c) && !strchr(delims, *c));
-          token_string[token_length] = 0;
           
           // no nextChar
 
@@ -17,9 +17,19 @@
 #ifndef __LISPLEXER_H__
 #define __LISPLEXER_H__
 
+#include <iosfwd>
+#include <stddef.h>
+
 namespace lisp
 {
 
+/**
+ * Splits an s-expression into tokens. The Lexer either pulls the text
+ * from a stream, copying each token into an internal buffer, or runs
+ * over a complete buffer in memory, in which case tokens are handed
+ * out as pointers into that buffer and only strings containing escape
+ * sequences get copied.
+ */
 class Lexer
 {
 public:
@@ -36,11 +46,30 @@ public:
   };
     
   Lexer(std::istream& stream);
+
+  /** Lexes \a size bytes at \a data, which must stay unchanged for
+      the lifetime of the Lexer */
+  Lexer(const char* data, size_t size);
   ~Lexer();
 
   TokenType getNextToken();
-  const char* getString() const
-  { return token_string; }
+
+  /** The current token as 0-terminated string, in buffer mode this
+      makes a copy, getToken() doesn't */
+  const char* getString() const;
+
+  /** The current token, not 0-terminated, valid until the next call
+      of getNextToken() */
+  const char* getToken() const
+  { return token; }
+  int getTokenLength() const
+  { return token_length; }
+
+  /** The value of a TOKEN_INTEGER or TOKEN_REAL, integers that
+      don't fit into an int throw std::runtime_error */
+  int getInteger() const;
+  float getReal() const;
+
   int getLineNumber() const
   { return linenumber; }
     
@@ -51,14 +80,26 @@ private:
   };
     
   inline void nextChar();
+  inline void beginToken();
+  inline void appendChar(char ch);
+  void copyToken();
     
-  std::istream& stream;
+  /** 0 in buffer mode */
+  std::istream* stream;
+
+  /** the remaining input in buffer mode */
+  const char* data;
+  const char* data_end;
+
   bool eof;
   int linenumber;
   char buffer[BUFFER_SIZE+1];
-  char* bufend;
-  char* c;
-  char token_string[MAX_TOKEN_LENGTH + 1];
+  const char* bufend;
+  const char* c;
+
+  /** either points to token_string or, in buffer mode, into the input */
+  const char* token;
+  mutable char token_string[MAX_TOKEN_LENGTH + 1];
   int token_length;
 
 private:
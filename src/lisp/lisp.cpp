@@ -50,6 +50,29 @@ Lisp::Lisp(LispType newtype, const std::string& str) :
   memcpy(v.string, str.c_str(), str.size()+1);
 }
 
+Lisp::Lisp(LispType newtype, const char* str, int length) :
+  type(newtype)
+{
+  assert(newtype == TYPE_SYMBOL || type == TYPE_STRING);
+  v.string = new char[length+1];
+  memcpy(v.string, str, static_cast<size_t>(length));
+  v.string[length] = '\0';
+}
+
+Lisp::Lisp(LispType newtype, char* str) :
+  type(newtype)
+{
+  assert(newtype == TYPE_SYMBOL || type == TYPE_STRING);
+  v.string = str;
+}
+
+Lisp::Lisp(Lisp** entries, size_t size) :
+  type(TYPE_LIST)
+{
+  v.list.entries = entries;
+  v.list.size = size;
+}
+
 Lisp::Lisp(const std::vector<Lisp*>& list_elements) :
   type(TYPE_LIST)
 {
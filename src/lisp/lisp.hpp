@@ -42,6 +42,8 @@ public:
 
   /// construct a new Lisp object symbol or string object
   Lisp(LispType newtype, const std::string& value);
+  /// same as above, \a value doesn't have to be 0-terminated
+  Lisp(LispType newtype, const char* value, int length);
   Lisp(const std::vector<Lisp*>& list_elements);
   Lisp(int val);
   Lisp(float val);
@@ -98,6 +100,15 @@ public:
 
   void print(std::ostream& out = std::cout, int indent = 0) const;
 
+private:
+  friend class Parser;
+  friend class BinaryFormat;
+
+  /// take over \a string or \a entries without copying, the Parser
+  /// allocates them either with new[] or from an Arena
+  Lisp(LispType newtype, char* string);
+  Lisp(Lisp** entries, size_t size);
+
 private:
   union
   {
@@ -18,13 +18,15 @@
 
 #include "lisp/parser.hpp"
 
+#include <algorithm>
 #include <boost/scoped_ptr.hpp>
-#include <fstream>
+#include <new>
 #include <sstream>
-#include <stdio.h>
 #include <string.h>
 
+#include "lisp/arena.hpp"
 #include "lisp/lisp.hpp"
+#include "util/mapped_file.hpp"
 
 namespace lisp
 {
@@ -55,41 +57,75 @@ private:
 Parser::Parser() :
   filename(),
   lexer(0),
-  token()
+  token(),
+  arena(0),
+  stack()
 {
 }
 
 Parser::~Parser()
 {
+  // only non-empty when parsing failed, an Arena cleans up by itself
+  if(!arena) {
+    for(std::vector<Lisp*>::iterator i = stack.begin(); i != stack.end(); ++i)
+      delete *i;
+  }
   delete lexer;
 }
 
 Lisp*
 Parser::parse(const std::string& filename)
 {
-  std::ifstream in(filename.c_str());
-  if(!in.good()) {
-    std::stringstream msg;
-    msg << "Parser problem: Couldn't open file '" << filename << "'.";
-    throw std::runtime_error(msg.str());
-  }
-
-  return parse(in, filename);
+  MappedFilePtr file = MappedFile::open(filename);
+  return parse(file->get_data(), file->get_size(), filename);
 }
 
 Lisp*
 Parser::parse(std::istream& stream, const std::string& filename)
+{
+  return parse(new Lexer(stream), 0, filename);
+}
+
+Lisp*
+Parser::parse(const char* data, size_t size, const std::string& filename)
+{
+  return parse(new Lexer(data, size), 0, filename);
+}
+
+Lisp*
+Parser::parse(const std::string& filename, Arena& arena)
+{
+  MappedFilePtr file = MappedFile::open(filename);
+  return parse(file->get_data(), file->get_size(), arena, filename);
+}
+
+Lisp*
+Parser::parse(std::istream& stream, Arena& arena, const std::string& filename)
+{
+  return parse(new Lexer(stream), &arena, filename);
+}
+
+Lisp*
+Parser::parse(const char* data, size_t size, Arena& arena, const std::string& filename)
+{
+  return parse(new Lexer(data, size), &arena, filename);
+}
+
+Lisp*
+Parser::parse(Lexer* lexer, Arena* arena, const std::string& filename)
 {
   std::auto_ptr<Parser> parser (new Parser());
 
   parser->filename = filename;
-  parser->lexer = new Lexer(stream);
+  parser->lexer = lexer;
+  parser->arena = arena;
 
   parser->token = parser->lexer->getNextToken();
   if(parser->token != Lexer::TOKEN_OPEN_PAREN)
     throw ParseError(parser.get(), "file doesn't start with '('");
 
-  std::auto_ptr<Lisp> result (parser->parse());
+  Lisp* result = parser->parse();
+  parser->stack.push_back(result);
   if(parser->token != Lexer::TOKEN_EOF) {
     if(parser->token == Lexer::TOKEN_CLOSE_PAREN)
       throw ParseError(parser.get(), "too many ')'");
@@ -97,81 +133,128 @@ Parser::parse(std::istream& stream, const std::string& filename)
       throw ParseError(parser.get(), "extra tokens at end of file");
   }
     
-  return result.release();
+  parser->stack.pop_back();
+  return result;
+}
+
+Lisp*
+Parser::make_string(int type, const char* str, int length)
+{
+  if(arena) {
+    char* copy;
+    if(type == Lisp::TYPE_SYMBOL) {
+      // shared by all equal symbols, but never written to
+      copy = const_cast<char*>(arena->intern(str, static_cast<size_t>(length)));
+    } else {
+      copy = arena->allocate_bytes(static_cast<size_t>(length) + 1);
+      memcpy(copy, str, static_cast<size_t>(length));
+      copy[length] = '\0';
+    }
+    return new (arena->allocate(sizeof(Lisp))) Lisp(static_cast<Lisp::LispType>(type), copy);
+  } else {
+    return new Lisp(static_cast<Lisp::LispType>(type), str, length);
+  }
+}
+
+Lisp*
+Parser::make_list(size_t begin)
+{
+  const size_t size = stack.size() - begin;
+
+  Lisp** entries;
+  if(arena)
+    entries = static_cast<Lisp**>(arena->allocate(size * sizeof(Lisp*)));
+  else
+    entries = new Lisp*[size];
+  std::copy(stack.begin() + static_cast<std::ptrdiff_t>(begin), stack.end(), entries);
+
+  Lisp* list;
+  if(arena) {
+    list = new (arena->allocate(sizeof(Lisp))) Lisp(entries, size);
+  } else {
+    try {
+      list = new Lisp(entries, size);
+    } catch(...) {
+      delete[] entries;
+      throw;
+    }
+  }
+
+  // the entries belong to the list now
+  stack.resize(begin);
+  return list;
+}
+
+template<class T>
+Lisp*
+Parser::make_value(T value)
+{
+  if(arena)
+    return new (arena->allocate(sizeof(Lisp))) Lisp(value);
+  else
+    return new Lisp(value);
 }
 
 Lisp*
 Parser::parse()
 {
-  std::vector<Lisp*> entries;
-  try {
-    while(token != Lexer::TOKEN_CLOSE_PAREN && token != Lexer::TOKEN_EOF) {
-      switch(token) {
-        case Lexer::TOKEN_OPEN_PAREN:
-          token = lexer->getNextToken();
+  const size_t begin = stack.size();
+
+  while(token != Lexer::TOKEN_CLOSE_PAREN && token != Lexer::TOKEN_EOF) {
+    switch(token) {
+      case Lexer::TOKEN_OPEN_PAREN:
+        token = lexer->getNextToken();
         
-          // Handle (_ "blup") strings that need to be translated
-          if(token == Lexer::TOKEN_SYMBOL
-             && strcmp(lexer->getString(), "_") == 0) {
-            token = lexer->getNextToken();
-            if(token != Lexer::TOKEN_STRING)
-              throw ParseError(this, "Expected string after '(_' sequence");
+        // Handle (_ "blup") strings that need to be translated
+        if(token == Lexer::TOKEN_SYMBOL
+           && lexer->getTokenLength() == 1 && lexer->getToken()[0] == '_') {
+          token = lexer->getNextToken();
+          if(token != Lexer::TOKEN_STRING)
+            throw ParseError(this, "Expected string after '(_' sequence");
             
-            entries.push_back(new Lisp(Lisp::TYPE_STRING, lexer->getString()));
+          stack.push_back(make_string(Lisp::TYPE_STRING, lexer->getToken(), lexer->getTokenLength()));
             
-            token = lexer->getNextToken();
-            if(token != Lexer::TOKEN_CLOSE_PAREN)
-              throw ParseError(this, "Expected ')' after '(_ ""' sequence");
-            break;
-          }
-        
-          entries.push_back(parse());
-          if(token != Lexer::TOKEN_CLOSE_PAREN) {
-            if(token == Lexer::TOKEN_EOF)
-              throw ParseError(this, "Expected ')' token, got EOF");
-            else
-              throw ParseError(this, "Expected ')' token");
-          }
-          break;
-        case Lexer::TOKEN_SYMBOL:
-          entries.push_back(new Lisp(Lisp::TYPE_SYMBOL, lexer->getString()));
-          break;
-        case Lexer::TOKEN_STRING:
-          entries.push_back(new Lisp(Lisp::TYPE_STRING, lexer->getString()));
-          break;
-        case Lexer::TOKEN_INTEGER: {
-          int val;
-          sscanf(lexer->getString(), "%d", &val);
-          entries.push_back(new Lisp(val));
+          token = lexer->getNextToken();
+          if(token != Lexer::TOKEN_CLOSE_PAREN)
+            throw ParseError(this, "Expected ')' after '(_ ""' sequence");
           break;
         }
-        case Lexer::TOKEN_REAL: {
-          float val;
-          sscanf(lexer->getString(), "%f", &val);
-          entries.push_back(new Lisp(val));
-          break;
+        
+        stack.push_back(parse());
+        if(token != Lexer::TOKEN_CLOSE_PAREN) {
+          if(token == Lexer::TOKEN_EOF)
+            throw ParseError(this, "Expected ')' token, got EOF");
+          else
+            throw ParseError(this, "Expected ')' token");
         }
-        case Lexer::TOKEN_TRUE:
-          entries.push_back(new Lisp(true));
-          break;
-        case Lexer::TOKEN_FALSE:
-          entries.push_back(new Lisp(false));
-          break;
-        default:
-          // this should never happen
-          assert(false);
-      }
-
-      token = lexer->getNextToken();
+        break;
+      case Lexer::TOKEN_SYMBOL:
+        stack.push_back(make_string(Lisp::TYPE_SYMBOL, lexer->getToken(), lexer->getTokenLength()));
+        break;
+      case Lexer::TOKEN_STRING:
+        stack.push_back(make_string(Lisp::TYPE_STRING, lexer->getToken(), lexer->getTokenLength()));
+        break;
+      case Lexer::TOKEN_INTEGER:
+        stack.push_back(make_value(lexer->getInteger()));
+        break;
+      case Lexer::TOKEN_REAL:
+        stack.push_back(make_value(lexer->getReal()));
+        break;
+      case Lexer::TOKEN_TRUE:
+        stack.push_back(make_value(true));
+        break;
+      case Lexer::TOKEN_FALSE:
+        stack.push_back(make_value(false));
+        break;
+      default:
+        // this should never happen
+        assert(false);
     }
-  } catch(...) {
-    for(std::vector<Lisp*>::iterator i = entries.begin();
-        i != entries.end(); ++i)
-      delete *i;
-    throw;
+
+    token = lexer->getNextToken();
   }
   
-  return new Lisp(entries);
+  return make_list(begin);
 }
 
 } // end of namespace lisp
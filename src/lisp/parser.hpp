@@ -18,32 +18,55 @@
 #define __LISPPARSER_H__
 
 #include <string>
+#include <vector>
 
 #include "lisp/lexer.hpp"
 
 namespace lisp
 {
 
+class Arena;
 class Lisp;
 
 class Parser
 {
 public:
   ~Parser();
+  /** Maps the file into memory and parses it from there */
   static Lisp* parse(const std::string& filename);
   static Lisp* parse(std::istream& stream, const std::string& filename = "");
+  static Lisp* parse(const char* data, size_t size, const std::string& filename = "");
+
+  /** Same as above, but the whole tree is allocated from \a arena,
+      it must not be deleted and goes away together with the Arena.
+      Symbols are interned in \a arena. */
+  static Lisp* parse(const std::string& filename, Arena& arena);
+  static Lisp* parse(std::istream& stream, Arena& arena, const std::string& filename = "");
+  static Lisp* parse(const char* data, size_t size, Arena& arena, const std::string& filename = "");
 
 private:
   friend class ParseError;
 
   Parser();
   
+  static Lisp* parse(Lexer* lexer, Arena* arena, const std::string& filename);
   Lisp* parse();
+
+  Lisp* make_string(int type, const char* str, int length);
+  Lisp* make_list(size_t begin);
+  template<class T> Lisp* make_value(T value);
   
   std::string filename;
   Lexer* lexer;
   Lexer::TokenType token;
 
+  /** 0 when the nodes are allocated with new */
+  Arena* arena;
+
+  /** entries of the lists currently being parsed, shared by all
+      nesting levels */
+  std::vector<Lisp*> stack;
+
 private:
   Parser(const Parser&);
   Parser& operator=(const Parser&);
@@ -17,7 +17,6 @@
 
 #include "lisp/writer.hpp"
 
-#include <fstream>
 #include <iostream>
 
 #include "util/pathname.hpp"
@@ -26,25 +25,17 @@ namespace lisp
 {
 
 Writer::Writer(const Pathname& filename) :
-  out(),
-  out_owned(),
-  indent_depth(),
+  out(filename.get_sys_path()),
+  indent_depth(0),
   lists()
 {
-  out = new std::ofstream(filename.get_sys_path().c_str());
-  out_owned = true;
-  indent_depth = 0;
 }
   
 Writer::Writer(std::ostream* newout) :
-  out(),
-  out_owned(),
-  indent_depth(),
+  out(*newout),
+  indent_depth(0),
   lists()
 {
-  out = newout;
-  out_owned = false;
-  indent_depth = 0;
 }
 
 Writer::~Writer()
@@ -52,21 +43,28 @@ Writer::~Writer()
   if(lists.size() > 0) {
     std::cerr << "Warning: Not all sections closed in lispwriter!\n";
   }
-  if(out_owned)
-    delete out;
+}
+
+void
+Writer::commit()
+{
+  out.commit();
 }
 
 void
 Writer::write_comment(const std::string& comment)
 {
-  *out << comment << "\n";
+  out.write(comment);
+  out.put('\n');
 }
 
 void
 Writer::start_list(const std::string& listname)
 {
   indent();
-  *out << '(' << listname << '\n';
+  out.put('(');
+  out.write(listname);
+  out.put('\n');
   indent_depth += 2;
 
   lists.push_back(listname);
@@ -89,21 +87,29 @@ Writer::end_list(const std::string& listname)
   
   indent_depth -= 2;
   indent();
-  *out << ")\n";
+  out.write(")\n", 2);
 }
 
 void
 Writer::write_int(const std::string& name, int value)
 {
   indent();
-  *out << '(' << name << ' ' << value << ")\n";
+  out.put('(');
+  out.write(name);
+  out.put(' ');
+  out.write_int(value);
+  out.write(")\n", 2);
 }
 
 void
 Writer::write_float(const std::string& name, float value)
 {
   indent();
-  *out << '(' << name << ' ' << value << ")\n";
+  out.put('(');
+  out.write(name);
+  out.put(' ');
+  out.write_float(value);
+  out.write(")\n", 2);
 }
 
 void
@@ -111,11 +117,16 @@ Writer::write_string(const std::string& name, const std::string& value,
                      bool translatable)
 {
   indent();
-  *out << '(' << name;
+  out.put('(');
+  out.write(name);
   if(translatable) {
-    *out << " (_ \"" << value << "\"))\n";
+    out.write(" (_ \"", 5);
+    out.write(value);
+    out.write("\"))\n", 4);
   } else {
-    *out << " \"" << value << "\")\n";
+    out.write(" \"", 2);
+    out.write(value);
+    out.write("\")\n", 3);
   }
 }
 
@@ -123,7 +134,9 @@ void
 Writer::write_bool(const std::string& name, bool value)
 {
   indent();
-  *out << '(' << name << ' ' << (value ? "#t" : "#f") << ")\n";
+  out.put('(');
+  out.write(name);
+  out.write(value ? " #t)\n" : " #f)\n", 5);
 }
 
 void
@@ -131,10 +144,13 @@ Writer::write_int_vector(const std::string& name,
                          const std::vector<int>& value)
 {
   indent();
-  *out << '(' << name;
-  for(std::vector<int>::const_iterator i = value.begin(); i != value.end(); ++i)
-    *out << " " << *i;
-  *out << ")\n";
+  out.put('(');
+  out.write(name);
+  for(std::vector<int>::const_iterator i = value.begin(); i != value.end(); ++i) {
+    out.put(' ');
+    out.write_int(*i);
+  }
+  out.write(")\n", 2);
 }
 
 void
@@ -142,17 +158,34 @@ Writer::write_int_vector(const std::string& name,
                          const std::vector<unsigned int>& value)
 {
   indent();
-  *out << '(' << name;
-  for(std::vector<unsigned int>::const_iterator i = value.begin(); i != value.end(); ++i)
-    *out << " " << *i;
-  *out << ")\n";
+  out.put('(');
+  out.write(name);
+  for(std::vector<unsigned int>::const_iterator i = value.begin(); i != value.end(); ++i) {
+    out.put(' ');
+    out.write_uint(*i);
+  }
+  out.write(")\n", 2);
+}
+
+void
+Writer::write_float_vector(const std::string& name,
+                           const std::vector<float>& value)
+{
+  indent();
+  out.put('(');
+  out.write(name);
+  for(std::vector<float>::const_iterator i = value.begin(); i != value.end(); ++i) {
+    out.put(' ');
+    out.write_float(*i);
+  }
+  out.write(")\n", 2);
 }
 
 void
 Writer::indent()
 {
   for(int i = 0; i<indent_depth; ++i)
-    *out << ' ';
+    out.put(' ');
 }
 
 } // end of namespace lisp
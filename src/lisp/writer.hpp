@@ -21,6 +21,8 @@
 #include <string>
 #include <vector>
 
+#include "util/output_buffer.hpp"
+
 class Pathname;
 
 namespace lisp
@@ -29,10 +31,16 @@ namespace lisp
 class Writer
 {
 public:
+  /** Writes to a temporary file, \a filename only gets replaced by
+      commit() */
   Writer(const Pathname& filename);
   Writer(std::ostream* out);
   ~Writer();
 
+  /** Flushes the output and moves the file into place, throws
+      std::runtime_error on failure */
+  void commit();
+
   void write_comment(const std::string& comment);
 
   void start_list(const std::string& listname);
@@ -44,6 +52,7 @@ public:
   void write_bool(const std::string& name, bool value);
   void write_int_vector(const std::string& name, const std::vector<int>& value);
   void write_int_vector(const std::string& name, const std::vector<unsigned int>& value);
+  void write_float_vector(const std::string& name, const std::vector<float>& value);
   // add more write-functions when needed...
 
   void end_list(const std::string& listname);
@@ -51,8 +60,7 @@ public:
 private:
   void indent();
 
-  std::ostream* out;
-  bool out_owned;
+  OutputBuffer out;
   int indent_depth;
   std::vector<std::string> lists;
 
@@ -18,61 +18,45 @@
 
 #include "math/random.hpp"
 
-/* This file is based on:
- * A C-program for MT19937, with initialization improved 2002/1/26.
- *  Coded by Takuji Nishimura and Makoto Matsumoto.
- * http://www.math.sci.hiroshima-u.ac.jp/~m-mat/MT/MT2002/CODES/mt19937ar.c 
- */
-
-Random::Random(unsigned long s)
-  : mti(0)
+uint64_t Random::s_seed = 5489UL;
+unsigned int Random::s_next_stream = 1;
+
+Random::Random(unsigned long seed_) :
+  state(0),
+  inc(0)
 {
-  mt[0]= s & 0xffffffffUL;
-  for (mti=1; mti<N; mti++) {
-    mt[mti] =
-      (1812433253UL * (mt[mti-1] ^ (mt[mti-1] >> 30)) + mti);
-    /* See Knuth TAOCP Vol2. 3rd Ed. P.106 for multiplier. */
-    /* In the previous versions, MSBs of the seed affect   */
-    /* only MSBs of the array mt[].                        */
-    /* 2002/01/09 modified by Makoto Matsumoto             */
-    mt[mti] &= 0xffffffffUL;
-    /* for >32 bit machines */
-  }
+  seed(seed_, 0);
 }
 
-unsigned long
-Random::rand()
+Random::Random(uint64_t seed_, uint64_t stream) :
+  state(0),
+  inc(0)
 {
-  unsigned long y;
-  static unsigned long mag01[2]={0x0UL, MATRIX_A};
-  /* mag01[x] = x * MATRIX_A  for x=0,1 */
-
-  if (mti >= N) { /* generate N words at one time */
-    unsigned long kk;
-
-    for (kk=0;kk<N-M;kk++) {
-      y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
-      mt[kk] = mt[kk+M] ^ (y >> 1) ^ mag01[y & 0x1UL];
-    }
-    for (;kk<N-1;kk++) {
-      y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
-      mt[kk] = mt[kk+(M-N)] ^ (y >> 1) ^ mag01[y & 0x1UL];
-    }
-    y = (mt[N-1]&UPPER_MASK)|(mt[0]&LOWER_MASK);
-    mt[N-1] = mt[M-1] ^ (y >> 1) ^ mag01[y & 0x1UL];
-
-    mti = 0;
-  }
-  
-  y = mt[mti++];
+  seed(seed_, stream);
+}
+
+void
+Random::seed(uint64_t seed_, uint64_t stream)
+{
+  state = 0;
+  inc = (stream << 1) | 1;
+  next();
+  state += seed_;
+  next();
+}
 
-  /* Tempering */
-  y ^= (y >> 11);
-  y ^= (y << 7) & 0x9d2c5680UL;
-  y ^= (y << 15) & 0xefc60000UL;
-  y ^= (y >> 18);
+void
+Random::set_seed(uint64_t seed_)
+{
+  s_seed = seed_;
+  s_next_stream = 1;
+  rnd.seed(seed_, 0);
+}
 
-  return y;
+uint64_t
+Random::next_stream()
+{
+  return s_next_stream++;
 }
 
 long
@@ -103,7 +87,7 @@ Random::drand(double start, double end)
 double
 Random::drand()
 {
-  return rand()*(1.0/4294967295.0);
+  return static_cast<double>(next()) * (1.0/4294967295.0);
   /* divided by 2^32-1 */
 }
 
@@ -19,25 +19,34 @@
 #ifndef HEADER_WINDSTILLE_MATH_RANDOM_HPP
 #define HEADER_WINDSTILLE_MATH_RANDOM_HPP
 
-/** */
+#include <stdint.h>
+
+/**
+ * PCG32 random number generator, see http://www.pcg-random.org/
+ *
+ * A generator is defined by a seed and a stream, generators with the
+ * same seed but different streams produce independent sequences. For
+ * reproducible runs objects should create their own generator with
+ * Random(Random::get_seed(), Random::next_stream()) on the main
+ * thread.
+ */
 class Random
 {
 private:
-  /* Period parameters */
-  static const unsigned long N = 624;
-  static const unsigned long M = 397;
-  static const unsigned long MATRIX_A   = 0x9908b0dfUL;   /* constant vector a */
-  static const unsigned long UPPER_MASK = 0x80000000UL; /* most significant w-r bits */
-  static const unsigned long LOWER_MASK = 0x7fffffffUL; /* least significant r bits */
+  uint64_t state;
+  uint64_t inc;
 
-  unsigned long mt[N]; /* the array for the state vector  */
-  unsigned long mti;
+  static uint64_t s_seed;
+  static unsigned int s_next_stream;
 
 public:
   Random(unsigned long seed = 5489UL);
+  Random(uint64_t seed, uint64_t stream);
+
+  void seed(uint64_t seed, uint64_t stream = 0);
 
   /** generates a random number on [0,0xffffffff]-interval */
-  unsigned long rand();
+  unsigned long rand() { return next(); }
 
   long rand(long range);
   long rand(int start, int end);
@@ -56,6 +65,33 @@ public:
 
   /** Returns either 1 or -1 */
   int sign();
+
+  /** Reseeds the global generator and restarts the stream numbering,
+      call this before the objects of a level get created to replay
+      the same random sequences */
+  static void set_seed(uint64_t seed);
+  static uint64_t get_seed() { return s_seed; }
+
+  /** Returns a stream number not handed out before since the last
+      set_seed(), must only be called from the main thread */
+  static uint64_t next_stream();
+
+private:
+  uint32_t next()
+  {
+    const uint64_t old = state;
+    state = old * multiplier() + inc;
+    const uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+    const uint32_t rot = static_cast<uint32_t>(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+  }
+
+  static uint64_t multiplier()
+  {
+    // 6364136223846793005, spelled out as there are no 64bit literals in C++98
+    return (static_cast<uint64_t>(0x5851f42dU) << 32) | 0x4c957f2dU;
+  }
+
 private:
   Random (const Random&);
   Random& operator= (const Random&);
@@ -22,10 +22,12 @@
 
 #include "navigation/node.hpp"
 
-Edge::Edge(Node* node1_, Node* node2_, Properties props_) :
+Edge::Edge(Node* node1_, Node* node2_, EdgeProperties props_) :
   node1(node1_), 
   node2(node2_),
-  properties(props_)
+  properties(props_),
+  slot(0),
+  query_stamp(0)
 {
   node1->add_edge(EdgePosition(this, 0.0f));
   node2->add_edge(EdgePosition(this, 1.0f));
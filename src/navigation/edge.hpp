@@ -31,10 +31,16 @@ private:
   Node* node1;
   Node* node2;
   
-  Properties properties;
+  EdgeProperties properties;
+
+  /** slot in the NavigationGraph */
+  unsigned int slot;
+
+  /** last NavigationGraph query that returned this edge */
+  unsigned int query_stamp;
 
 public:
-  Edge(Node* node1_, Node* node2_, Properties props_ = 0);
+  Edge(Node* node1_, Node* node2_, EdgeProperties props_ = 0);
   ~Edge();
 
   /** Calculate the angle between two segments */
@@ -43,11 +49,16 @@ public:
   Node* get_node1() const { return node1; } 
   Node* get_node2() const { return node2; } 
 
-  Properties get_properties()  const { return properties; }
+  EdgeProperties get_properties()  const { return properties; }
+
+  unsigned int get_slot() const { return slot; }
 
   Line   get_line() const;
   Vector2f get_vector() const;
   
+private:
+  friend class NavigationGraph;
+
 private:
   Edge (const Edge&);
   Edge& operator= (const Edge&);
@@ -0,0 +1,945 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "navigation/hierarchical_path_finder.hpp"
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <set>
+#include <glm/glm.hpp>
+
+#include "navigation/edge.hpp"
+#include "navigation/navigation_graph.hpp"
+#include "navigation/node.hpp"
+
+namespace {
+
+/** Portal edges between two regions are at least this many region
+    sizes apart */
+const float kPortalSpacing = 0.5f;
+
+} // namespace
+
+void
+HierarchicalPathFinder::Search::resize(size_t size)
+{
+  entries.assign(size, Entry());
+  query = 0;
+}
+
+void
+HierarchicalPathFinder::Search::begin()
+{
+  open.clear();
+  touched.clear();
+
+  query += 1;
+  if (query == 0)
+  { // stamps wrapped around, start over
+    std::fill(entries.begin(), entries.end(), Entry());
+    query = 1;
+  }
+}
+
+bool
+HierarchicalPathFinder::Search::store(int node, int parent_, float cost_)
+{
+  Entry& entry = entries[node];
+  if (entry.closed == query)
+  {
+    return false;
+  }
+  else if (entry.visited != query || cost_ < entry.cost)
+  {
+    if (entry.visited != query)
+    {
+      entry.visited = query;
+      touched.push_back(node);
+    }
+
+    entry.cost   = cost_;
+    entry.parent = parent_;
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+void
+HierarchicalPathFinder::Search::push(int node, float priority)
+{
+  open.push_back(OpenEntry(priority, node));
+  std::push_heap(open.begin(), open.end());
+}
+
+bool
+HierarchicalPathFinder::Search::relax(int node, int parent_, float cost_, float estimate)
+{
+  if (store(node, parent_, cost_))
+  {
+    push(node, cost_ + estimate);
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+int
+HierarchicalPathFinder::Search::pop()
+{
+  while(!open.empty())
+  {
+    std::pop_heap(open.begin(), open.end());
+    const int node = open.back().node;
+    open.pop_back();
+
+    if (entries[node].closed != query)
+    {
+      entries[node].closed = query;
+      return node;
+    }
+  }
+
+  return -1;
+}
+
+bool
+HierarchicalPathFinder::Crossing::operator<(const Crossing& rhs) const
+{
+  if (region != rhs.region)
+    return region < rhs.region;
+  else if (key != rhs.key)
+    return key < rhs.key;
+  else
+    return cost < rhs.cost;
+}
+
+HierarchicalPathFinder::HierarchicalPathFinder(NavigationGraph& graph,
+                                               const PathCost& cost,
+                                               float region_size,
+                                               unsigned int cache_size) :
+  m_graph(graph),
+  m_cost(cost),
+  m_region_size(region_size),
+  m_cache_size(cache_size),
+  m_revision(-1),
+  m_nodes(),
+  m_links(),
+  m_region(),
+  m_local(),
+  m_portal(),
+  m_portal_links(),
+  m_portal_paths(),
+  m_regions(),
+  m_free_regions(),
+  m_cell_regions(),
+  m_num_regions(0),
+  m_num_portals(0),
+  m_start_search(),
+  m_goal_search(),
+  m_portal_search(),
+  m_local_search(),
+  m_routes(),
+  m_route_map(),
+  m_stats(),
+  m_trace(),
+  m_portal_route(),
+  m_crossings(),
+  m_old_portals(),
+  m_old_portal_costs(),
+  m_old_portal_next()
+{
+}
+
+HierarchicalPathFinder::~HierarchicalPathFinder()
+{
+}
+
+HierarchicalPathFinder::Cell
+HierarchicalPathFinder::get_cell(const Vector2f& pos) const
+{
+  return Cell(static_cast<int>(floorf(pos.x / m_region_size)),
+              static_cast<int>(floorf(pos.y / m_region_size)));
+}
+
+float
+HierarchicalPathFinder::get_edge_cost(const Edge* edge) const
+{
+  float length = glm::length(edge->get_vector());
+  if (edge->get_properties() & m_cost.penalized)
+    return length * std::max(1.0f, m_cost.penalty);
+  else
+    return length;
+}
+
+int
+HierarchicalPathFinder::get_index(Node* node) const
+{
+  const unsigned int slot = node->get_slot();
+  if (slot < m_nodes.size() && m_nodes[slot] == node)
+    return static_cast<int>(slot);
+  else
+    return -1;
+}
+
+void
+HierarchicalPathFinder::update()
+{
+  if (m_revision == m_graph.get_revision())
+    return;
+
+  const size_t num_slots = m_graph.get_num_node_slots();
+  std::vector<Node*> nodes(num_slots, static_cast<Node*>(0));
+  const NavigationGraph::Nodes& graph_nodes = m_graph.get_nodes();
+  for(NavigationGraph::Nodes::const_iterator i = graph_nodes.begin(); i != graph_nodes.end(); ++i)
+  {
+    nodes[(*i)->get_slot()] = *i;
+  }
+
+  // the cells that changed nodes were and are in get rebuilt
+  std::vector<int> changed;
+  std::set<Cell> dirty_cells;
+  for(size_t i = 0; i < std::max(num_slots, m_nodes.size()); ++i)
+  {
+    Node* node = (i < num_slots) ? nodes[i] : 0;
+    const bool is_changed = node && node->get_revision() > m_revision;
+
+    if (is_changed)
+    {
+      changed.push_back(static_cast<int>(i));
+      dirty_cells.insert(get_cell(node->get_pos()));
+    }
+
+    if (i < m_nodes.size() && m_nodes[i] && (!node || is_changed))
+    {
+      dirty_cells.insert(m_regions[m_region[i]].cell);
+    }
+  }
+
+  std::vector<int> candidates = changed;
+  for(std::set<Cell>::const_iterator c = dirty_cells.begin(); c != dirty_cells.end(); ++c)
+  {
+    std::map<Cell, std::vector<int> >::iterator it = m_cell_regions.find(*c);
+    if (it != m_cell_regions.end())
+    {
+      for(std::vector<int>::const_iterator r = it->second.begin(); r != it->second.end(); ++r)
+      {
+        free_region(*r, candidates);
+      }
+      m_cell_regions.erase(it);
+    }
+  }
+
+  m_nodes.swap(nodes);
+  m_links.resize(num_slots);
+  m_region.resize(num_slots, -1);
+  m_local.resize(num_slots, -1);
+  m_portal.resize(num_slots, -1);
+  m_portal_links.resize(num_slots);
+  m_portal_paths.resize(num_slots);
+
+  for(size_t i = 0; i < num_slots; ++i)
+  {
+    if (!m_nodes[i])
+      m_links[i].clear();
+  }
+
+  // edge costs are fixed at this point, as the PathCost is
+  for(std::vector<int>::const_iterator i = changed.begin(); i != changed.end(); ++i)
+  {
+    update_links(*i);
+  }
+
+  if (m_local_search.entries.size() != num_slots)
+  {
+    m_start_search.resize(num_slots);
+    m_goal_search.resize(num_slots);
+    m_local_search.resize(num_slots);
+    // one extra entry for the goal
+    m_portal_search.resize(num_slots + 1);
+  }
+
+  std::vector<int> new_regions;
+  for(std::vector<int>::const_iterator i = candidates.begin(); i != candidates.end(); ++i)
+  {
+    const size_t node = static_cast<size_t>(*i);
+    if (node < num_slots && m_nodes[node] && m_region[node] == -1)
+    {
+      new_regions.push_back(build_region(*i));
+    }
+  }
+
+  // the portal edges between a new region and its neighbors change,
+  // so the neighbors need new portals too
+  std::set<int> portal_regions(new_regions.begin(), new_regions.end());
+  for(std::vector<int>::const_iterator r = new_regions.begin(); r != new_regions.end(); ++r)
+  {
+    const Region& region = m_regions[*r];
+    for(std::vector<int>::const_iterator n = region.nodes.begin(); n != region.nodes.end(); ++n)
+    {
+      for(std::vector<Link>::const_iterator l = m_links[*n].begin(); l != m_links[*n].end(); ++l)
+      {
+        if (m_region[l->target] != *r)
+        {
+          portal_regions.insert(m_region[l->target]);
+        }
+      }
+    }
+  }
+
+  for(std::set<int>::const_iterator r = portal_regions.begin(); r != portal_regions.end(); ++r)
+  {
+    build_portals(*r);
+  }
+
+  clear_cache();
+
+  m_revision = m_graph.get_revision();
+}
+
+void
+HierarchicalPathFinder::update_links(int node)
+{
+  std::vector<Link>& links = m_links[node];
+  links.clear();
+
+  const Node::Edges& edges = m_nodes[node]->edges;
+  for(Node::Edges::const_iterator e = edges.begin(); e != edges.end(); ++e)
+  {
+    if (!(e->edge->get_properties() & m_cost.forbidden))
+    {
+      Node* target = (e->pos == 0.0f) ? e->edge->get_node2() : e->edge->get_node1();
+      const int index = get_index(target);
+      if (index != -1)
+      {
+        links.push_back(Link(index, get_edge_cost(e->edge)));
+      }
+    }
+  }
+}
+
+void
+HierarchicalPathFinder::free_region(int region, std::vector<int>& nodes)
+{
+  clear_portals(region);
+
+  Region& r = m_regions[region];
+  for(std::vector<int>::const_iterator n = r.nodes.begin(); n != r.nodes.end(); ++n)
+  {
+    m_region[*n] = -1;
+    m_local[*n]  = -1;
+    nodes.push_back(*n);
+  }
+  r.nodes.clear();
+
+  m_free_regions.push_back(region);
+  m_num_regions -= 1;
+}
+
+int
+HierarchicalPathFinder::build_region(int node)
+{
+  int region;
+  if (m_free_regions.empty())
+  {
+    region = static_cast<int>(m_regions.size());
+    m_regions.push_back(Region());
+  }
+  else
+  {
+    region = m_free_regions.back();
+    m_free_regions.pop_back();
+  }
+  m_num_regions += 1;
+
+  // a region is a connected part of the graph within a cell, so that
+  // each node of a region can reach all its portals locally
+  Region& r = m_regions[region];
+  r.cell = get_cell(m_nodes[node]->get_pos());
+  r.nodes.push_back(node);
+  m_region[node] = region;
+  m_cell_regions[r.cell].push_back(region);
+
+  for(size_t i = 0; i < r.nodes.size(); ++i)
+  {
+    m_local[r.nodes[i]] = static_cast<int>(i);
+
+    const std::vector<Link>& links = m_links[r.nodes[i]];
+    for(std::vector<Link>::const_iterator l = links.begin(); l != links.end(); ++l)
+    {
+      if (m_region[l->target] == -1 && get_cell(m_nodes[l->target]->get_pos()) == r.cell)
+      {
+        m_region[l->target] = region;
+        r.nodes.push_back(l->target);
+      }
+    }
+  }
+
+  return region;
+}
+
+void
+HierarchicalPathFinder::clear_portals(int region)
+{
+  Region& r = m_regions[region];
+  for(std::vector<int>::const_iterator p = r.portals.begin(); p != r.portals.end(); ++p)
+  {
+    m_portal[*p] = -1;
+    m_portal_links[*p].clear();
+    m_portal_paths[*p].clear();
+  }
+  m_num_portals -= static_cast<int>(r.portals.size());
+
+  r.portals.clear();
+  r.portal_costs.clear();
+  r.portal_next.clear();
+}
+
+void
+HierarchicalPathFinder::build_portals(int region)
+{
+  Region& r = m_regions[region];
+
+  m_old_portals = r.portals;
+  m_old_portal_costs.swap(r.portal_costs);
+  m_old_portal_next.swap(r.portal_next);
+  const size_t num_old_portals = m_old_portals.size();
+  clear_portals(region);
+
+  m_crossings.clear();
+  for(std::vector<int>::const_iterator n = r.nodes.begin(); n != r.nodes.end(); ++n)
+  {
+    for(std::vector<Link>::const_iterator l = m_links[*n].begin(); l != m_links[*n].end(); ++l)
+    {
+      if (m_region[l->target] != region)
+      {
+        Crossing crossing;
+        crossing.region  = m_region[l->target];
+        crossing.key     = std::make_pair(std::min(*n, l->target), std::max(*n, l->target));
+        crossing.inside  = *n;
+        crossing.outside = l->target;
+        crossing.center  = 0.5f * (m_nodes[*n]->get_pos() + m_nodes[l->target]->get_pos());
+        crossing.cost    = l->cost;
+        m_crossings.push_back(crossing);
+      }
+    }
+  }
+
+  // the neighbor region sorts the same edges alike, so both sides
+  // pick the same portal edges
+  std::sort(m_crossings.begin(), m_crossings.end());
+
+  const float spacing = kPortalSpacing * m_region_size;
+  size_t group = 0;
+  for(size_t i = 0; i < m_crossings.size(); ++i)
+  {
+    Crossing& crossing = m_crossings[i];
+    if (crossing.region != m_crossings[group].region)
+      group = i;
+
+    // keep it, unless a portal edge to the same region is close
+    crossing.selected = true;
+    for(size_t j = group; j < i && crossing.selected; ++j)
+    {
+      if (m_crossings[j].selected &&
+          glm::length(m_crossings[j].center - crossing.center) < spacing)
+      {
+        crossing.selected = false;
+      }
+    }
+
+    if (crossing.selected)
+    {
+      if (m_portal[crossing.inside] == -1)
+      {
+        m_portal[crossing.inside] = static_cast<int>(r.portals.size());
+        r.portals.push_back(crossing.inside);
+      }
+
+      std::vector<int>& paths = m_portal_paths[crossing.inside];
+      paths.push_back(crossing.outside);
+      m_portal_links[crossing.inside].push_back(PortalLink(crossing.outside, crossing.cost,
+                                                           static_cast<int>(paths.size()) - 1,
+                                                           static_cast<int>(paths.size())));
+    }
+  }
+  m_num_portals += static_cast<int>(r.portals.size());
+
+  // costs from each node to the portals, the graph is undirected, so
+  // one search from each portal covers the whole region
+  const size_t num_portals = r.portals.size();
+  r.portal_costs.assign(r.nodes.size() * num_portals, FLT_MAX);
+  r.portal_next.assign(r.nodes.size() * num_portals, -1);
+
+  for(size_t p = 0; p < num_portals; ++p)
+  {
+    const int portal = r.portals[p];
+
+    const size_t old = static_cast<size_t>(std::find(m_old_portals.begin(), m_old_portals.end(), portal) -
+                                           m_old_portals.begin());
+    if (old != num_old_portals)
+    {
+      for(size_t n = 0; n < r.nodes.size(); ++n)
+      {
+        r.portal_costs[n * num_portals + p] = m_old_portal_costs[n * num_old_portals + old];
+        r.portal_next [n * num_portals + p] = m_old_portal_next [n * num_old_portals + old];
+      }
+    }
+    else
+    {
+      m_local_search.begin();
+      m_local_search.relax(portal, -1, 0.0f, 0.0f);
+      search_local(m_local_search, -1, -1, 0);
+
+      for(size_t n = 0; n < r.nodes.size(); ++n)
+      {
+        r.portal_costs[n * num_portals + p] = m_local_search.get_cost(r.nodes[n]);
+        r.portal_next [n * num_portals + p] = m_local_search.get_parent(r.nodes[n]);
+      }
+    }
+  }
+
+  // a way that passes another portal is covered by the links of
+  // that portal, leaving it out keeps the portal graph sparse
+  for(size_t p = 0; p < num_portals; ++p)
+  {
+    const int portal = r.portals[p];
+    std::vector<int>& paths = m_portal_paths[portal];
+    for(std::vector<int>::const_iterator t = r.portals.begin(); t != r.portals.end(); ++t)
+    {
+      const size_t target = static_cast<size_t>(m_local[*t]) * num_portals + p;
+      if (*t != portal && r.portal_costs[target] != FLT_MAX)
+      {
+        const int path_begin = static_cast<int>(paths.size());
+        bool passes_portal = false;
+        for(int n = *t; n != portal && !passes_portal;
+            n = r.portal_next[static_cast<size_t>(m_local[n]) * num_portals + p])
+        {
+          passes_portal = (n != *t && m_portal[n] != -1);
+          paths.push_back(n);
+        }
+
+        if (passes_portal)
+        {
+          paths.resize(static_cast<size_t>(path_begin));
+        }
+        else
+        {
+          std::reverse(paths.begin() + path_begin, paths.end());
+          m_portal_links[portal].push_back(PortalLink(*t, r.portal_costs[target],
+                                                      path_begin, static_cast<int>(paths.size())));
+        }
+      }
+    }
+  }
+}
+
+void
+HierarchicalPathFinder::search_local(Search& search, int to1, int to2, int remaining)
+{
+  int node;
+  while((node = search.pop()) != -1)
+  {
+    if (node == to1 || node == to2)
+    {
+      remaining -= 1;
+      if (remaining == 0)
+        return;
+    }
+
+    const int region = m_region[node];
+    const float cost = search.get_cost(node);
+    for(std::vector<Link>::const_iterator l = m_links[node].begin(); l != m_links[node].end(); ++l)
+    {
+      if (m_region[l->target] == region)
+      {
+        search.relax(l->target, node, cost + l->cost, 0.0f);
+      }
+    }
+  }
+}
+
+void
+HierarchicalPathFinder::add_portal_costs(Search& search, int node, float cost) const
+{
+  const Region& r = m_regions[m_region[node]];
+  const size_t num_portals = r.portals.size();
+  const size_t offset = static_cast<size_t>(m_local[node]) * num_portals;
+
+  for(size_t p = 0; p < num_portals; ++p)
+  {
+    search.store(r.portals[p], node, cost + r.portal_costs[offset + p]);
+  }
+}
+
+bool
+HierarchicalPathFinder::find_path(const Vector2f& from, const Vector2f& to, Path& path)
+{
+  const EdgePosition from_pos = m_graph.find_closest_position(from, m_cost.snap_radius);
+  const EdgePosition to_pos   = m_graph.find_closest_position(to, m_cost.snap_radius);
+
+  if (from_pos.edge && to_pos.edge)
+  {
+    return find_path(from_pos, to_pos, path);
+  }
+  else
+  {
+    path.clear();
+    return false;
+  }
+}
+
+bool
+HierarchicalPathFinder::find_path(const EdgePosition& from, const EdgePosition& to, Path& path)
+{
+  path.clear();
+
+  if (!from.edge || !to.edge)
+    return false;
+
+  update();
+
+  const int from1 = get_index(from.edge->get_node1());
+  const int from2 = get_index(from.edge->get_node2());
+  const int to1   = get_index(to.edge->get_node1());
+  const int to2   = get_index(to.edge->get_node2());
+
+  if (from1 == -1 || from2 == -1 || to1 == -1 || to2 == -1)
+    return false; // stale EdgePosition
+
+  const float from_cost = get_edge_cost(from.edge);
+  const float to_cost   = get_edge_cost(to.edge);
+
+  // the start edge itself may cross into a second region, as may the
+  // goal edge
+  m_start_search.begin();
+  add_portal_costs(m_start_search, from1, from.pos * from_cost);
+  add_portal_costs(m_start_search, from2, (1.0f - from.pos) * from_cost);
+
+  // the graph is undirected, so the costs from the goal equal those
+  // of the way to the goal
+  m_goal_search.begin();
+  add_portal_costs(m_goal_search, to1, to.pos * to_cost);
+  add_portal_costs(m_goal_search, to2, (1.0f - to.pos) * to_cost);
+
+  // a direct connection without leaving the start regions, a node of
+  // -2 stands for start and goal sharing the edge
+  int   direct_node = -1;
+  float direct_cost = FLT_MAX;
+  if (from.edge == to.edge)
+  {
+    direct_node = -2;
+    direct_cost = fabsf(to.pos - from.pos) * from_cost;
+  }
+
+  const int region1 = m_region[from1];
+  const int region2 = m_region[from2];
+  const int local_targets =
+    ((m_region[to1] == region1 || m_region[to1] == region2) ? 1 : 0) +
+    ((m_region[to2] == region1 || m_region[to2] == region2) ? 1 : 0);
+
+  if (local_targets > 0)
+  {
+    m_local_search.begin();
+    m_local_search.relax(from1, -1, from.pos * from_cost, 0.0f);
+    m_local_search.relax(from2, -1, (1.0f - from.pos) * from_cost, 0.0f);
+    search_local(m_local_search, to1, to2, local_targets);
+
+    if (m_local_search.is_closed(to1) && m_local_search.get_cost(to1) + to.pos * to_cost < direct_cost)
+    {
+      direct_node = to1;
+      direct_cost = m_local_search.get_cost(to1) + to.pos * to_cost;
+    }
+    if (m_local_search.is_closed(to2) && m_local_search.get_cost(to2) + (1.0f - to.pos) * to_cost < direct_cost)
+    {
+      direct_node = to2;
+      direct_cost = m_local_search.get_cost(to2) + (1.0f - to.pos) * to_cost;
+    }
+  }
+
+  if (use_cached_route(from, to, direct_node, direct_cost, path))
+    return true;
+  else
+    return search_portals(from, to, direct_node, direct_cost, path);
+}
+
+bool
+HierarchicalPathFinder::use_cached_route(const EdgePosition& from, const EdgePosition& to,
+                                         int direct_node, float direct_cost, Path& path)
+{
+  const int from_region = m_region[get_index(from.edge->get_node1())];
+  const int to_region   = m_region[get_index(to.edge->get_node1())];
+
+  if (from_region == to_region)
+    return false;
+
+  RouteMap::iterator it = m_route_map.find(std::make_pair(from_region, to_region));
+  if (it == m_route_map.end())
+  {
+    m_stats.misses += 1;
+    return false;
+  }
+
+  const Route& route = *it->second;
+  const int first = route.nodes.front();
+  const int last  = route.nodes.back();
+
+  if (!m_start_search.is_visited(first) || !m_goal_search.is_visited(last))
+  { // the route starts in the other region of the start edge
+    m_stats.misses += 1;
+    return false;
+  }
+
+  m_stats.hits += 1;
+  m_routes.splice(m_routes.begin(), m_routes, it->second);
+
+  const float cost = m_start_search.get_cost(first) + route.cost + m_goal_search.get_cost(last);
+
+  m_trace.clear();
+  if (direct_cost <= cost)
+  {
+    if (direct_node >= 0)
+      trace_local(direct_node);
+    finish_path(from, to, direct_cost, path);
+  }
+  else
+  {
+    trace_start(first);
+    m_trace.insert(m_trace.end(), route.nodes.begin() + 1, route.nodes.end());
+    trace_goal(last);
+    finish_path(from, to, cost, path);
+  }
+
+  return true;
+}
+
+bool
+HierarchicalPathFinder::search_portals(const EdgePosition& from, const EdgePosition& to,
+                                       int direct_node, float direct_cost, Path& path)
+{
+  // portals are searched by their node slot
+  const int goal = static_cast<int>(m_nodes.size());
+  const Vector2f goal_pos = to.get_pos();
+
+  m_portal_search.begin();
+
+  for(std::vector<int>::const_iterator i = m_start_search.touched.begin(); i != m_start_search.touched.end(); ++i)
+  {
+    m_portal_search.relax(*i, -1, m_start_search.get_cost(*i),
+                          glm::length(goal_pos - m_nodes[*i]->get_pos()));
+  }
+
+  // a goal parent of -1 marks the direct connection
+  if (direct_node != -1)
+  {
+    m_portal_search.relax(goal, -1, direct_cost, 0.0f);
+  }
+
+  int node;
+  while((node = m_portal_search.pop()) != -1 && node != goal)
+  {
+    const float cost = m_portal_search.get_cost(node);
+
+    if (m_goal_search.is_visited(node))
+    {
+      m_portal_search.relax(goal, node, cost + m_goal_search.get_cost(node), 0.0f);
+    }
+
+    const std::vector<PortalLink>& links = m_portal_links[node];
+    for(std::vector<PortalLink>::const_iterator l = links.begin(); l != links.end(); ++l)
+    {
+      // the estimate is only needed when the cost improves
+      if (m_portal_search.store(l->target, node, cost + l->cost))
+      {
+        m_portal_search.push(l->target, cost + l->cost + glm::length(goal_pos - m_nodes[l->target]->get_pos()));
+      }
+    }
+  }
+
+  if (node != goal)
+    return false;
+
+  const float cost = m_portal_search.get_cost(goal);
+
+  m_trace.clear();
+  if (m_portal_search.get_parent(goal) == -1)
+  {
+    if (direct_node >= 0)
+      trace_local(direct_node);
+  }
+  else
+  {
+    m_portal_route.clear();
+    for(int p = m_portal_search.get_parent(goal); p != -1; p = m_portal_search.get_parent(p))
+    {
+      m_portal_route.push_back(p);
+    }
+    std::reverse(m_portal_route.begin(), m_portal_route.end());
+
+    trace_start(m_portal_route.front());
+    const size_t route_begin = m_trace.size() - 1;
+    for(size_t i = 1; i < m_portal_route.size(); ++i)
+    {
+      trace_between(m_portal_route[i-1], m_portal_route[i]);
+    }
+    const size_t route_end = m_trace.size();
+
+    cache_route(m_region[get_index(from.edge->get_node1())],
+                m_region[get_index(to.edge->get_node1())],
+                route_begin, route_end,
+                m_portal_search.get_cost(m_portal_route.back()) -
+                m_start_search.get_cost(m_portal_route.front()));
+
+    trace_goal(m_portal_route.back());
+  }
+
+  finish_path(from, to, cost, path);
+  return true;
+}
+
+void
+HierarchicalPathFinder::cache_route(int from_region, int to_region, size_t begin, size_t end, float cost)
+{
+  if (from_region == to_region || m_cache_size == 0)
+    return;
+
+  const std::pair<int, int> key(from_region, to_region);
+
+  RouteMap::iterator it = m_route_map.find(key);
+  if (it != m_route_map.end())
+  {
+    m_routes.erase(it->second);
+    m_route_map.erase(it);
+  }
+
+  m_routes.push_front(Route());
+  Route& route = m_routes.front();
+  route.from_region = from_region;
+  route.to_region   = to_region;
+  route.nodes.assign(m_trace.begin() + static_cast<std::ptrdiff_t>(begin),
+                     m_trace.begin() + static_cast<std::ptrdiff_t>(end));
+  route.cost = cost;
+  m_route_map[key] = m_routes.begin();
+
+  if (m_routes.size() > m_cache_size)
+  {
+    const Route& oldest = m_routes.back();
+    m_route_map.erase(std::make_pair(oldest.from_region, oldest.to_region));
+    m_routes.pop_back();
+  }
+
+  m_stats.entries = static_cast<unsigned int>(m_routes.size());
+}
+
+void
+HierarchicalPathFinder::clear_cache()
+{
+  m_routes.clear();
+  m_route_map.clear();
+  m_stats.entries = 0;
+}
+
+void
+HierarchicalPathFinder::trace_local(int node)
+{
+  const size_t begin = m_trace.size();
+  for(int n = node; n != -1; n = m_local_search.get_parent(n))
+  {
+    m_trace.push_back(n);
+  }
+  std::reverse(m_trace.begin() + static_cast<std::ptrdiff_t>(begin), m_trace.end());
+}
+
+void
+HierarchicalPathFinder::trace_start(int portal)
+{
+  const Region& r = m_regions[m_region[portal]];
+  const size_t num_portals = r.portals.size();
+  const size_t p = static_cast<size_t>(m_portal[portal]);
+
+  // follow the next nodes from the start node to the portal
+  for(int n = m_start_search.get_parent(portal); n != -1;
+      n = r.portal_next[static_cast<size_t>(m_local[n]) * num_portals + p])
+  {
+    m_trace.push_back(n);
+  }
+}
+
+void
+HierarchicalPathFinder::trace_goal(int portal)
+{
+  const Region& r = m_regions[m_region[portal]];
+  const size_t num_portals = r.portals.size();
+  const size_t p = static_cast<size_t>(m_portal[portal]);
+
+  // the next nodes lead from the goal node to the portal, so the way
+  // gets reversed
+  const size_t begin = m_trace.size();
+  for(int n = m_goal_search.get_parent(portal); n != portal;
+      n = r.portal_next[static_cast<size_t>(m_local[n]) * num_portals + p])
+  {
+    m_trace.push_back(n);
+  }
+  std::reverse(m_trace.begin() + static_cast<std::ptrdiff_t>(begin), m_trace.end());
+}
+
+void
+HierarchicalPathFinder::trace_between(int from, int to)
+{
+  // parallel edges can give more than one link to the same portal,
+  // the search went along the cheapest
+  const std::vector<PortalLink>& links = m_portal_links[from];
+  const PortalLink* best = 0;
+  for(std::vector<PortalLink>::const_iterator l = links.begin(); l != links.end(); ++l)
+  {
+    if (l->target == to && (!best || l->cost < best->cost))
+    {
+      best = &*l;
+    }
+  }
+
+  const std::vector<int>& paths = m_portal_paths[from];
+  m_trace.insert(m_trace.end(),
+                 paths.begin() + best->path_begin,
+                 paths.begin() + best->path_end);
+}
+
+void
+HierarchicalPathFinder::finish_path(const EdgePosition& from, const EdgePosition& to, float cost, Path& path) const
+{
+  path.nodes.reserve(m_trace.size());
+  for(std::vector<int>::const_iterator i = m_trace.begin(); i != m_trace.end(); ++i)
+  {
+    path.nodes.push_back(m_nodes[*i]);
+  }
+
+  path.build_points(from.get_pos(), to.get_pos());
+  path.cost = cost;
+
+  if (m_cost.smooth_tolerance > 0.0f)
+  {
+    path.smooth(m_cost.smooth_tolerance);
+  }
+}
+
+/* EOF */
@@ -0,0 +1,334 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_NAVIGATION_HIERARCHICAL_PATH_FINDER_HPP
+#define HEADER_WINDSTILLE_NAVIGATION_HIERARCHICAL_PATH_FINDER_HPP
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include "math/vector2f.hpp"
+#include "navigation/path_finder.hpp"
+
+struct RouteCacheStats
+{
+  RouteCacheStats() :
+    hits(0),
+    misses(0),
+    entries(0)
+  {}
+
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int entries;
+};
+
+/**
+ * Path search for large graphs. Nodes are clustered into regions, the
+ * connected parts of the graph within a square cell of the world.
+ * Only a few of the edges between two regions become portal edges,
+ * spaced at least half a region apart, their nodes are the portals.
+ * The costs from each node to the portals of its region are
+ * precomputed, so a query only runs A* over the portals and then
+ * looks up the way through each region.
+ *
+ * Routes between portals are remembered in a LRU cache keyed by the
+ * start and goal regions. Neither cached nor searched routes are
+ * guaranteed to be optimal, as they have to pass the portals, which
+ * is the price for not searching the whole graph.
+ *
+ * The hierarchy is built for a fixed PathCost. When the revision of
+ * the graph changes, only the cells with changed nodes are rebuilt,
+ * along with the portals of the regions next to them, and the cache
+ * is cleared.
+ */
+class HierarchicalPathFinder
+{
+private:
+  struct Link
+  {
+    Link() : target(0), cost(0.0f) {}
+    Link(int target_, float cost_) : target(target_), cost(cost_) {}
+
+    int target;
+    float cost;
+  };
+
+  /** A link of the portal graph, the nodes on the way to the target
+      are stored in m_portal_paths of the source portal */
+  struct PortalLink
+  {
+    PortalLink() : target(0), cost(0.0f), path_begin(0), path_end(0) {}
+    PortalLink(int target_, float cost_, int path_begin_, int path_end_) :
+      target(target_), cost(cost_), path_begin(path_begin_), path_end(path_end_) {}
+
+    int target;
+    float cost;
+    int path_begin;
+    int path_end;
+  };
+
+  struct OpenEntry
+  {
+    OpenEntry() : cost(0.0f), node(0) {}
+    OpenEntry(float cost_, int node_) : cost(cost_), node(node_) {}
+
+    float cost;
+    int node;
+
+    bool operator<(const OpenEntry& rhs) const
+    {
+      // reversed, so that std::push_heap() gives a min-heap
+      return cost > rhs.cost;
+    }
+  };
+
+  /** Dijkstra/A* bookkeeping, entries are only valid when their stamp
+      matches the current query */
+  struct Search
+  {
+    struct Entry
+    {
+      Entry() : cost(0.0f), parent(-1), visited(0), closed(0) {}
+
+      float cost;
+      int parent;
+      unsigned int visited;
+      unsigned int closed;
+    };
+
+    Search() : entries(), open(), touched(), query(0) {}
+
+    std::vector<Entry> entries;
+    std::vector<OpenEntry> open;
+
+    /** the nodes visited by the current query */
+    std::vector<int> touched;
+
+    unsigned int query;
+
+    void resize(size_t size);
+    void begin();
+    bool is_visited(int node) const { return entries[node].visited == query; }
+    bool is_closed(int node) const { return entries[node].closed == query; }
+    float get_cost(int node) const { return entries[node].cost; }
+    int get_parent(int node) const { return entries[node].parent; }
+
+    /** Records \a cost for \a node, if it is lower than the known one */
+    bool store(int node, int parent, float cost);
+    void push(int node, float priority);
+    bool relax(int node, int parent, float cost, float estimate);
+    int  pop();
+  };
+
+  typedef std::pair<int, int> Cell;
+
+  struct Region
+  {
+    Region() : cell(), nodes(), portals(), portal_costs(), portal_next() {}
+
+    Cell cell;
+    std::vector<int> nodes;
+    std::vector<int> portals;
+
+    /** cost from each node to each portal and the next node on the
+        way there, indexed by m_local[node] * portals.size() + portal */
+    std::vector<float> portal_costs;
+    std::vector<int>   portal_next;
+  };
+
+  /** An edge leaving a region, seen from inside */
+  struct Crossing
+  {
+    Crossing() : region(0), key(), inside(0), outside(0), center(), cost(0.0f), selected(false) {}
+
+    /** the region on the other side */
+    int region;
+
+    /** the node slots ordered, so that both sides sort alike */
+    std::pair<int, int> key;
+
+    int inside;
+    int outside;
+    Vector2f center;
+    float cost;
+
+    /** whether it became a portal edge */
+    bool selected;
+
+    bool operator<(const Crossing& rhs) const;
+  };
+
+  struct Route
+  {
+    Route() : from_region(0), to_region(0), nodes(), cost(0.0f) {}
+
+    int from_region;
+    int to_region;
+
+    /** node slots from the first to the last portal */
+    std::vector<int> nodes;
+    float cost;
+  };
+
+  typedef std::list<Route> RouteList;
+  typedef std::map<std::pair<int, int>, RouteList::iterator> RouteMap;
+
+  NavigationGraph& m_graph;
+  PathCost m_cost;
+  float m_region_size;
+  unsigned int m_cache_size;
+  int m_revision;
+
+  // per node slot
+  std::vector<Node*> m_nodes;
+  std::vector<std::vector<Link> > m_links;
+  std::vector<int> m_region;
+
+  /** index of the node within its region */
+  std::vector<int> m_local;
+
+  /** index of the portal within its region or -1 */
+  std::vector<int> m_portal;
+
+  /** links of the portals to the other portals of their region and
+      along their portal edges */
+  std::vector<std::vector<PortalLink> > m_portal_links;
+
+  /** the nodes after the portal on the way to the targets of its
+      links */
+  std::vector<std::vector<int> > m_portal_paths;
+
+  std::vector<Region> m_regions;
+  std::vector<int>    m_free_regions;
+  std::map<Cell, std::vector<int> > m_cell_regions;
+  int m_num_regions;
+  int m_num_portals;
+
+  /** costs from the start to the portals of its regions, with the
+      start node as parent */
+  Search m_start_search;
+
+  /** costs from the portals of the goal regions to the goal, with
+      the goal node as parent */
+  Search m_goal_search;
+
+  Search m_portal_search;
+
+  /** searches within a region, for the way between start and goal
+      within the start regions and for building the portal costs */
+  Search m_local_search;
+
+  /** most recently used routes are at the front */
+  RouteList m_routes;
+  RouteMap  m_route_map;
+  RouteCacheStats m_stats;
+
+  // scratch space
+  std::vector<int> m_trace;
+  std::vector<int> m_portal_route;
+  std::vector<Crossing> m_crossings;
+  std::vector<int>   m_old_portals;
+  std::vector<float> m_old_portal_costs;
+  std::vector<int>   m_old_portal_next;
+
+public:
+  HierarchicalPathFinder(NavigationGraph& graph,
+                         const PathCost& cost = PathCost(),
+                         float region_size = 512.0f,
+                         unsigned int cache_size = 256);
+  ~HierarchicalPathFinder();
+
+  /** Finds a path from \a from to \a to, returns false and an empty
+      \a path if there is none */
+  bool find_path(const EdgePosition& from, const EdgePosition& to, Path& path);
+
+  /** Same as above, \a from and \a to are first moved onto the
+      closest edge within PathCost::snap_radius */
+  bool find_path(const Vector2f& from, const Vector2f& to, Path& path);
+
+  /** Brings the hierarchy up to date with the graph, done
+      automatically by find_path() */
+  void update();
+
+  int get_num_regions() const { return m_num_regions; }
+  int get_num_portals() const { return m_num_portals; }
+
+  const RouteCacheStats& get_cache_stats() const { return m_stats; }
+
+private:
+  Cell get_cell(const Vector2f& pos) const;
+  int  get_index(Node* node) const;
+  float get_edge_cost(const Edge* edge) const;
+
+  void update_links(int node);
+
+  /** Removes \a region and its portals, its nodes are appended to \a nodes */
+  void free_region(int region, std::vector<int>& nodes);
+
+  /** Collects the nodes connected to \a node within its cell */
+  int  build_region(int node);
+
+  void clear_portals(int region);
+
+  /** Selects the portals of \a region anew, the costs of portals it
+      had before are kept, as its nodes and links are unchanged */
+  void build_portals(int region);
+
+  /** Expands \a search within the regions of its seeds until \a
+      remaining of \a to1 and \a to2 are settled, or the regions are
+      exhausted */
+  void search_local(Search& search, int to1, int to2, int remaining);
+
+  /** Stores the costs from \a node, reached at \a cost, to the
+      portals of its region in \a search */
+  void add_portal_costs(Search& search, int node, float cost) const;
+
+  bool search_portals(const EdgePosition& from, const EdgePosition& to,
+                      int direct_node, float direct_cost, Path& path);
+  bool use_cached_route(const EdgePosition& from, const EdgePosition& to,
+                        int direct_node, float direct_cost, Path& path);
+  /** Stores m_trace[begin..end) as route between the two regions */
+  void cache_route(int from_region, int to_region, size_t begin, size_t end, float cost);
+  void clear_cache();
+
+  /** Appends the path from the seed of m_local_search to \a node to m_trace */
+  void trace_local(int node);
+
+  /** Appends the path from the start to \a portal to m_trace */
+  void trace_start(int portal);
+
+  /** Appends the path from \a portal to the goal to m_trace, \a
+      portal itself is left out */
+  void trace_goal(int portal);
+
+  /** Appends the path from portal \a from to \a to to m_trace,
+      \a from itself is left out */
+  void trace_between(int from, int to);
+
+  void finish_path(const EdgePosition& from, const EdgePosition& to, float cost, Path& path) const;
+
+private:
+  HierarchicalPathFinder(const HierarchicalPathFinder&);
+  HierarchicalPathFinder& operator=(const HierarchicalPathFinder&);
+};
+
+#endif
+
+/* EOF */
@@ -16,52 +16,170 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <iomanip>
 
 #include "display/display.hpp"
 #include "display/color.hpp"
+#include "math/math.hpp"
 #include "math/rect.hpp"
 #include "navigation/edge.hpp"
 #include "navigation/node.hpp"
+#include "navigation/path_finder.hpp"
 #include "util/file_reader.hpp"
 #include "util/file_writer.hpp"
 
 #include "navigation/navigation_graph.hpp"
+
+namespace {
+
+/** cell size and bucket count of the spatial hashes */
+const float kGridCellSize = 128.0f;
+const int   kGridBuckets  = 1024;
+
+Rectf get_bbox(const Vector2f& pos)
+{
+  return Rectf(pos.x, pos.y, pos.x, pos.y);
+}
+
+Rectf get_bbox(const Vector2f& pos, float radius)
+{
+  return Rectf(pos.x - radius, pos.y - radius, pos.x + radius, pos.y + radius);
+}
+
+Rectf get_bbox(const Edge* edge)
+{
+  const Vector2f p1 = edge->get_node1()->get_pos();
+  const Vector2f p2 = edge->get_node2()->get_pos();
+  return Rectf(std::min(p1.x, p2.x), std::min(p1.y, p2.y),
+               std::max(p1.x, p2.x), std::max(p1.y, p2.y));
+}
+
+bool intersection_less(const std::pair<float, EdgePosition>& lhs,
+                       const std::pair<float, EdgePosition>& rhs)
+{
+  return lhs.first < rhs.first;
+}
+
+} // namespace
 
 NavigationGraph::NavigationGraph() :
   nodes(),
-  edges()
+  edges(),
+  revision(0),
+  query_stamp(0),
+  path_finder(),
+  node_grid(kGridCellSize, kGridBuckets),
+  edge_grid(kGridCellSize, kGridBuckets)
 {  
 }
 
 NavigationGraph::~NavigationGraph()
 {
-  for(Edges::iterator i = edges.begin(); i != edges.end(); ++i)
-    delete *i;
+  // edges unlink themselves from their nodes, so they go first
   edges.clear();
-
-  for (Nodes::iterator i = nodes.begin(); i != nodes.end(); ++i)
-    delete *i;
   nodes.clear();
 }
 
+unsigned int
+NavigationGraph::next_query_stamp()
+{
+  query_stamp += 1;
+  if (query_stamp == 0)
+  { // wrapped around, old stamps could collide with new ones
+    for(Nodes::const_iterator i = get_nodes().begin(); i != get_nodes().end(); ++i)
+      (*i)->query_stamp = 0;
+    for(Edges::const_iterator i = get_edges().begin(); i != get_edges().end(); ++i)
+      (*i)->query_stamp = 0;
+    query_stamp = 1;
+  }
+  return query_stamp;
+}
+
+void
+NavigationGraph::unique_candidates(std::vector<Node*>& candidates)
+{
+  const unsigned int stamp = next_query_stamp();
+  std::vector<Node*>::iterator out = candidates.begin();
+  for(std::vector<Node*>::iterator i = candidates.begin(); i != candidates.end(); ++i)
+  {
+    if ((*i)->query_stamp != stamp)
+    {
+      (*i)->query_stamp = stamp;
+      *out++ = *i;
+    }
+  }
+  candidates.erase(out, candidates.end());
+}
+
+void
+NavigationGraph::unique_candidates(std::vector<Edge*>& candidates)
+{
+  const unsigned int stamp = next_query_stamp();
+  std::vector<Edge*>::iterator out = candidates.begin();
+  for(std::vector<Edge*>::iterator i = candidates.begin(); i != candidates.end(); ++i)
+  {
+    if ((*i)->query_stamp != stamp)
+    {
+      (*i)->query_stamp = stamp;
+      *out++ = *i;
+    }
+  }
+  candidates.erase(out, candidates.end());
+}
+
+NodeHandle
+NavigationGraph::get_handle(Node* node) const
+{
+  return nodes.get_handle(node->get_slot());
+}
+
+EdgeHandle
+NavigationGraph::get_handle(Edge* edge) const
+{
+  return edges.get_handle(edge->get_slot());
+}
+
 NodeHandle
 NavigationGraph::add_node(const Vector2f& pos)
 {
-  Node* node = new Node(pos);
-  nodes.push_back(node);
-  return NodeHandle(node);
+  return insert_node(new Node(pos));
+}
+
+NodeHandle
+NavigationGraph::insert_node(Node* node)
+{
+  NodeHandle handle = nodes.acquire(node);
+  node->slot = handle.get_index();
+  node_grid.insert(node, get_bbox(node->get_pos()));
+  revision += 1;
+  node->revision = revision;
+  return handle;
+}
+
+EdgeHandle
+NavigationGraph::insert_edge(Edge* edge)
+{
+  EdgeHandle handle = edges.acquire(edge);
+  edge->slot = handle.get_index();
+  edge_grid.insert(edge, get_bbox(edge));
+  revision += 1;
+  edge->get_node1()->revision = revision;
+  edge->get_node2()->revision = revision;
+  return handle;
 }
 
 void
 NavigationGraph::remove_edge(EdgeHandle edge)
 {
-  // FIXME: Slow
-  Edges::iterator i = std::find(edges.begin(), edges.end(), edge.get());
-  if (i != edges.end())
+  if (edges.valid(edge))
   {
-    edges.erase(i);
-    delete edge.get();
+    revision += 1;
+    edge->get_node1()->revision = revision;
+    edge->get_node2()->revision = revision;
+
+    edge_grid.remove(edge.get(), get_bbox(edge.get()));
+    edges.release(edge);
   }
 
   // FIXME: Throw exception here
@@ -70,42 +188,28 @@ NavigationGraph::remove_edge(EdgeHandle edge)
 void
 NavigationGraph::remove_node(NodeHandle node)
 {
-  // FIXME: Slow
-
-  // Remove all edges that would get invalid by removing the node
-  for(Edges::iterator i = edges.begin(); i != edges.end(); ++i)
+  if (nodes.valid(node))
   {
-    if ((*i)->get_node1() == node.get() ||
-        (*i)->get_node2() == node.get())
+    // Remove all edges that would get invalid by removing the node,
+    // each removal shrinks node->edges
+    while(!node->edges.empty())
     {
-      delete *i;
-      *i = 0;
+      remove_edge(get_handle(node->edges.back().edge));
     }
-  }
 
-  Edges::iterator new_end = std::remove(edges.begin(), edges.end(), static_cast<Edge*>(0));
-  if (new_end != edges.end())
-  { 
-    edges.erase(new_end, edges.end());
+    node_grid.remove(node.get(), get_bbox(node->get_pos()));
+    nodes.release(node);
+    revision += 1;
   }
-  
-  // Remove the node itself 
-  Nodes::iterator j = std::find(nodes.begin(), nodes.end(), node.get());
-  if (j != nodes.end())
-  {
-    nodes.erase(j);
-    delete node.get();
-  }  
 }
 
 EdgeHandle
 NavigationGraph::add_edge(NodeHandle node1, NodeHandle node2)
 {
-  if (node1.get() != node2.get()) // node links to themself are forbidden
+  if (nodes.valid(node1) && nodes.valid(node2) &&
+      node1.get() != node2.get()) // node links to themself are forbidden
   { // FIXME: Find a way to figure out if the given edge already exists
-    Edge* edge = new Edge(node1.get(), node2.get());
-    edges.push_back(edge);
-    return EdgeHandle(edge);
+    return insert_edge(new Edge(node1.get(), node2.get()));
   }
   else
   {
@@ -116,8 +220,11 @@ NavigationGraph::add_edge(NodeHandle node1, NodeHandle node2)
 void
 NavigationGraph::split_edge(EdgeHandle edge)
 {
-  NodeHandle node1 = NodeHandle(edge->get_node1());
-  NodeHandle node3 = NodeHandle(edge->get_node2());
+  if (!edges.valid(edge))
+    return;
+
+  NodeHandle node1 = get_handle(edge->get_node1());
+  NodeHandle node3 = get_handle(edge->get_node2());
   NodeHandle node2 = add_node(0.5f * (node1->get_pos() + node3->get_pos()));
 
   remove_edge(edge);
@@ -125,14 +232,41 @@ NavigationGraph::split_edge(EdgeHandle edge)
   add_edge(node2, node3);  
 }
 
+void
+NavigationGraph::move_node(NodeHandle node, const Vector2f& pos)
+{
+  if (!nodes.valid(node))
+    return;
+
+  for(Node::Edges::iterator i = node->edges.begin(); i != node->edges.end(); ++i)
+    edge_grid.remove(i->edge, get_bbox(i->edge));
+  node_grid.remove(node.get(), get_bbox(node->get_pos()));
+
+  node->set_pos(pos);
+
+  node_grid.insert(node.get(), get_bbox(node->get_pos()));
+  for(Node::Edges::iterator i = node->edges.begin(); i != node->edges.end(); ++i)
+    edge_grid.insert(i->edge, get_bbox(i->edge));
+
+  // the edge lengths change, so the neighbors count as changed too
+  revision += 1;
+  node->revision = revision;
+  for(Node::Edges::iterator i = node->edges.begin(); i != node->edges.end(); ++i)
+  {
+    i->edge->get_node1()->revision = revision;
+    i->edge->get_node2()->revision = revision;
+  }
+}
+
 std::vector<EdgePosition>
 NavigationGraph::find_intersections(const Line& line)
 {
-  // FIXME: we might want to only return the first intersection, not
-  // all of them or alternativly return ua
-  std::vector<EdgePosition> ret;
- 
-  for(Edges::iterator i = edges.begin(); i != edges.end(); ++i)
+  std::vector<Edge*> candidates;
+  edge_grid.query(Rectf(line.p1.x, line.p1.y, line.p2.x, line.p2.y), candidates);
+  unique_candidates(candidates);
+
+  std::vector<std::pair<float, EdgePosition> > hits;
+  for(std::vector<Edge*>::iterator i = candidates.begin(); i != candidates.end(); ++i)
   {
     Line seg_line((*i)->get_node1()->get_pos(),
                   (*i)->get_node2()->get_pos());
@@ -140,25 +274,36 @@ NavigationGraph::find_intersections(const Line& line)
     float ua, ub;
     if (line.intersect(seg_line, ua, ub))
     {
-      ret.push_back(EdgePosition(*i, ub));
+      hits.push_back(std::make_pair(ua, EdgePosition(*i, ub)));
     }
   }
 
+  std::stable_sort(hits.begin(), hits.end(), intersection_less);
+
+  std::vector<EdgePosition> ret;
+  ret.reserve(hits.size());
+  for(std::vector<std::pair<float, EdgePosition> >::iterator i = hits.begin(); i != hits.end(); ++i)
+  {
+    ret.push_back(i->second);
+  }
+
   return ret;
 }
 
 std::vector<NodeHandle>
 NavigationGraph::find_nodes(const Vector2f& pos, float radius)
 {
-  // FIXME: Optimize this with spatial tree thingy
-  std::vector<NodeHandle> ret;
+  std::vector<Node*> candidates;
+  node_grid.query(get_bbox(pos, radius), candidates);
+  unique_candidates(candidates);
 
-  for(Nodes::iterator i = nodes.begin(); i != nodes.end(); ++i)
+  std::vector<NodeHandle> ret;
+  for(std::vector<Node*>::iterator i = candidates.begin(); i != candidates.end(); ++i)
   {
     float distance = glm::length(pos - (*i)->get_pos());
     if (distance < radius)
     {
-      ret.push_back(NodeHandle(*i));
+      ret.push_back(get_handle(*i));
     }
   }
   
@@ -168,13 +313,16 @@ NavigationGraph::find_nodes(const Vector2f& pos, float radius)
 std::vector<NodeHandle>
 NavigationGraph::find_nodes(const Rectf& rect)
 {
-  std::vector<NodeHandle> ret;
+  std::vector<Node*> candidates;
+  node_grid.query(rect, candidates);
+  unique_candidates(candidates);
 
-  for(Nodes::iterator i = nodes.begin(); i != nodes.end(); ++i)
+  std::vector<NodeHandle> ret;
+  for(std::vector<Node*>::iterator i = candidates.begin(); i != candidates.end(); ++i)
   {  
     if (rect.is_inside((*i)->get_pos()))
     {
-      ret.push_back(NodeHandle(*i));
+      ret.push_back(get_handle(*i));
     }
   }
 
@@ -184,15 +332,18 @@ NavigationGraph::find_nodes(const Rectf& rect)
 std::vector<EdgeHandle>
 NavigationGraph::find_edges(const Vector2f& pos, float radius)
 {
+  std::vector<Edge*> candidates;
+  edge_grid.query(get_bbox(pos, radius), candidates);
+  unique_candidates(candidates);
+
   std::vector<EdgeHandle> ret;
- 
-  for(Edges::iterator i = edges.begin(); i != edges.end(); ++i)
+  for(std::vector<Edge*>::iterator i = candidates.begin(); i != candidates.end(); ++i)
   {
     float distance = Line((*i)->get_node1()->get_pos(),
                           (*i)->get_node2()->get_pos()).distance(pos);
     if (distance < radius)
     {
-      ret.push_back(EdgeHandle(*i));
+      ret.push_back(get_handle(*i));
     }
   }
 
@@ -202,11 +353,13 @@ NavigationGraph::find_edges(const Vector2f& pos, float radius)
 NodeHandle
 NavigationGraph::find_closest_node(const Vector2f& pos, float radius)
 {
-  // FIXME: Optimize this with spatial tree thingy
+  std::vector<Node*> candidates;
+  node_grid.query(get_bbox(pos, radius), candidates);
+
   Node* node = 0;
   float min_distance = radius;
 
-  for(Nodes::iterator i = nodes.begin(); i != nodes.end(); ++i)
+  for(std::vector<Node*>::iterator i = candidates.begin(); i != candidates.end(); ++i)
   {
     float current_distance = glm::length(pos - (*i)->get_pos());
     if (current_distance < min_distance)
@@ -216,16 +369,19 @@ NavigationGraph::find_closest_node(const Vector2f& pos, float radius)
     }
   }
   
-  return NodeHandle(node);
+  return node ? get_handle(node) : NodeHandle();
 }
 
 EdgeHandle
 NavigationGraph::find_closest_edge(const Vector2f& pos, float radius)
 {
+  std::vector<Edge*> candidates;
+  edge_grid.query(get_bbox(pos, radius), candidates);
+
   Edge* edge   = 0;
   float min_distance = radius;
 
-  for(Edges::iterator i = edges.begin(); i != edges.end(); ++i)
+  for(std::vector<Edge*>::iterator i = candidates.begin(); i != candidates.end(); ++i)
   {
     float current_distance = Line((*i)->get_node1()->get_pos(),
                                   (*i)->get_node2()->get_pos()).distance(pos);
@@ -236,20 +392,57 @@ NavigationGraph::find_closest_edge(const Vector2f& pos, float radius)
     }
   }
 
-  return EdgeHandle(edge);
+  return edge ? get_handle(edge) : EdgeHandle();
+}
+
+EdgePosition
+NavigationGraph::find_closest_position(const Vector2f& pos, float radius)
+{
+  EdgeHandle edge = find_closest_edge(pos, radius);
+  if (!edge)
+  {
+    return EdgePosition();
+  }
+  else
+  {
+    const Vector2f v = edge->get_vector();
+    const float len2 = glm::dot(v, v);
+    const float u = (len2 == 0.0f) ? 0.0f : glm::dot(pos - edge->get_node1()->get_pos(), v) / len2;
+    return EdgePosition(edge.get(), math::mid(0.0f, u, 1.0f));
+  }
+}
+
+bool
+NavigationGraph::find_path(const EdgePosition& from, const EdgePosition& to,
+                           const PathCost& cost, Path& path)
+{
+  if (!path_finder)
+    path_finder.reset(new PathFinder(*this));
+
+  return path_finder->find_path(from, to, cost, path);
+}
+
+bool
+NavigationGraph::find_path(const Vector2f& from, const Vector2f& to,
+                           const PathCost& cost, Path& path)
+{
+  if (!path_finder)
+    path_finder.reset(new PathFinder(*this));
+
+  return path_finder->find_path(from, to, cost, path);
 }
 
 void
 NavigationGraph::draw()
 {
-  for(Edges::iterator i = edges.begin(); i != edges.end(); ++i)
+  for(Edges::const_iterator i = get_edges().begin(); i != get_edges().end(); ++i)
   {
     Display::draw_line_with_normal(Line((*i)->get_node1()->get_pos(),
                                         (*i)->get_node2()->get_pos()),
                                    Color(1.0f, 0.0f, 0.0f));
   }
 
-  for(Nodes::iterator i = nodes.begin(); i != nodes.end(); ++i)
+  for(Nodes::const_iterator i = get_nodes().begin(); i != get_nodes().end(); ++i)
   {
     Display::fill_rect(Rectf((*i)->get_pos() - Vector2f(4,4), Sizef(9, 9)),
                        Color(1.0f, 1.0f, 0.0f));
@@ -259,8 +452,11 @@ NavigationGraph::draw()
 void
 NavigationGraph::load(FileReader& reader)
 {
-  nodes.clear();
   edges.clear();
+  nodes.clear();
+  node_grid.clear();
+  edge_grid.clear();
+  revision += 1;
 
   int id_count = 1;
   std::map<int, Node*> id2ptr;
@@ -278,7 +474,7 @@ NavigationGraph::load(FileReader& reader)
         {
           Node* node = new Node(pos);
           id2ptr[id_count++] = node;
-          nodes.push_back(node);
+          insert_node(node);
         }
         else
         {
@@ -314,7 +510,7 @@ NavigationGraph::load(FileReader& reader)
           if (node_left_ptr != id2ptr.end() && node_right_ptr != id2ptr.end())
           {
             Edge* edge = new Edge(node_left_ptr->second, node_right_ptr->second, properties);
-            edges.push_back(edge);
+            insert_edge(edge);
           }
           else
           {
@@ -341,20 +537,20 @@ NavigationGraph::save(std::ostream& out)
   int id = 1;
   std::map<Node*, int> ptr2id;
 
-  for(Nodes::iterator i = nodes.begin(); i != nodes.end(); ++i)
+  for(Nodes::const_iterator i = get_nodes().begin(); i != get_nodes().end(); ++i)
     ptr2id[*i] = id++;
 
   std::ios_base::fmtflags old_flags = out.flags(); // save flags
 
   out << "(navigation\n";
   out << "  (nodes\n"; 
-  for(Nodes::iterator i = nodes.begin(); i != nodes.end(); ++i)
+  for(Nodes::const_iterator i = get_nodes().begin(); i != get_nodes().end(); ++i)
     out << "    (node (id " << std::setw(3) << ptr2id[*i] << ") (pos " 
         << std::setw(3) << (*i)->get_pos().x << " " << (*i)->get_pos().y << "))\n";
   out << " )\n";
 
   out << "  (edges\n";
-  for(Edges::iterator i = edges.begin(); i != edges.end(); ++i)  
+  for(Edges::const_iterator i = get_edges().begin(); i != get_edges().end(); ++i)  
     out << "    (edge "
         << "(node1 " << std::setw(3) << ptr2id[(*i)->get_node1()] << ") "
         << "(node2 " << std::setw(3) << ptr2id[(*i)->get_node2()] << ") "
@@ -372,12 +568,12 @@ NavigationGraph::write(FileWriter& writer)
   std::map<Node*, int> ptr2id;
 
   {
-    for(Nodes::iterator i = nodes.begin(); i != nodes.end(); ++i)
-      ptr2id[*i] = i - nodes.begin() + 1;
+    for(Nodes::const_iterator i = get_nodes().begin(); i != get_nodes().end(); ++i)
+      ptr2id[*i] = static_cast<int>(i - get_nodes().begin()) + 1;
   }
 
   writer.start_section("nodes");
-  for(Nodes::iterator i = nodes.begin(); i != nodes.end(); ++i)
+  for(Nodes::const_iterator i = get_nodes().begin(); i != get_nodes().end(); ++i)
   {
     writer.start_section("node");
     writer.write("id", ptr2id[*i]);
@@ -387,7 +583,7 @@ NavigationGraph::write(FileWriter& writer)
   writer.end_section();
 
   writer.start_section("edges");
-  for(Edges::iterator i = edges.begin(); i != edges.end(); ++i)  
+  for(Edges::const_iterator i = get_edges().begin(); i != get_edges().end(); ++i)  
   {
     writer.start_section("edge");
     writer.write("node1", ptr2id[(*i)->get_node1()]);
@@ -398,18 +594,4 @@ NavigationGraph::write(FileWriter& writer)
   writer.end_section();
 }
 
-bool
-NavigationGraph::valid(Edge* edge)
-{
-  // FIXME: Slow
-  return std::find(edges.begin(), edges.end(), edge) != edges.end();
-}
-
-bool
-NavigationGraph::valid(Node* node)
-{
-  // FIXME: Slow
-  return std::find(nodes.begin(), nodes.end(), node) != nodes.end();
-}
-
 /* EOF */
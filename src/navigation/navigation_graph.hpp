@@ -19,12 +19,15 @@
 #ifndef HEADER_WINDSTILLE_NAVIGATION_NAVIGATION_GRAPH_HPP
 #define HEADER_WINDSTILLE_NAVIGATION_NAVIGATION_GRAPH_HPP
 
+#include <boost/scoped_ptr.hpp>
 #include <iosfwd>
 #include <vector>
 
 #include <glm/glm.hpp>
 
 #include "math/vector2f.hpp"
+#include "navigation/spatial_hash.hpp"
+#include "util/handle.hpp"
 
 class Edge;
 class EdgePosition;
@@ -32,59 +35,13 @@ class FileReader;
 class FileWriter;
 class Line;
 class Node;
+class PathFinder;
 class Rectf;
+struct Path;
+struct PathCost;
 
-template<typename Data>
-class PointerHandle
-{
-private:
-  Data* data;
-
-public: 
-  PointerHandle() 
-    : data(0)
-  {}
-
-  PointerHandle(Data* data_)
-    : data(data_)
-  {}
-
-  inline Data* get() {
-    return data;
-  }
-
-  inline Data* operator->()  {
-    return data;
-  }
-
-  inline const Data* operator->() const {
-    return data;
-  }
-
-  inline Data& operator*()  {
-    return *data;
-  }
-
-  inline const Data& operator*() const {
-    return *data;
-  }
-
-  operator bool() {
-    return data != 0;
-  }
-
-  bool operator==(const PointerHandle<Data>& rhs) const {
-    return data == rhs.data;
-  }
-
-  bool operator<(const PointerHandle<Data>& other) const {
-    return this->data < other.data;
-  }
-};
-
-
-typedef PointerHandle<Node> NodeHandle; 
-typedef PointerHandle<Edge> EdgeHandle; 
+typedef Handle<Node> NodeHandle;
+typedef Handle<Edge> EdgeHandle;
 
 class NavigationGraph
 {
@@ -93,20 +50,41 @@ public:
   typedef std::vector<Edge*> Edges;
 
 private:
-  Nodes nodes;
-  Edges edges;
-  
-  // insert some spartial thingy here
+  HandleManager<Node> nodes;
+  HandleManager<Edge> edges;
+
+  /** incremented on each change of the topology */
+  int revision;
+
+  /** Marks the candidates of the current find_*() query, so that
+      duplicates from the spatial hash are dropped in O(1) */
+  unsigned int query_stamp;
+
+  boost::scoped_ptr<PathFinder> path_finder;
+
+  /** Nodes and edges by position, backing the find_*() queries */
+  SpatialHash<Node*> node_grid;
+  SpatialHash<Edge*> edge_grid;
 
 public:
   NavigationGraph();
   ~NavigationGraph();
 
-  Nodes& get_nodes() { return nodes; }
-  Edges& get_edges() { return edges; }
+  /** All nodes and edges, the order changes when some get removed */
+  const Nodes& get_nodes() const { return nodes.get_data(); }
+  const Edges& get_edges() const { return edges.get_data(); }
+
+  /** Slot indexes, as returned by Node::get_slot(), are below this */
+  unsigned int get_num_node_slots() const { return nodes.get_num_slots(); }
+
+  NodeHandle get_handle(Node* node) const;
+  EdgeHandle get_handle(Edge* edge) const;
+
+  /** Changes whenever nodes or edges are added, removed or moved,
+      the nodes affected by a change remember its revision, see
+      Node::get_revision() */
+  int get_revision() const { return revision; }
 
-  // FIXME: It might be worth it to return handles that can be
-  // validated instead of pure pointers
   NodeHandle add_node(const Vector2f& pos);
   EdgeHandle add_edge(NodeHandle node1, NodeHandle node2);
 
@@ -115,7 +93,11 @@ public:
 
   void split_edge(EdgeHandle edge);
 
-  /** Find edges that intersect with the given line */
+  /** Moves \a node and its edges to \a pos */
+  void move_node(NodeHandle node, const Vector2f& pos);
+
+  /** Find edges that intersect with the given line, the closest
+      intersection to line.p1 comes first */
   std::vector<EdgePosition> find_intersections(const Line& line);
 
   /** Find nodes that are near within the \a radius */
@@ -128,6 +110,18 @@ public:
 
   EdgeHandle find_closest_edge(const Vector2f& pos, float radius);
 
+  /** Projects \a pos onto the closest edge within \a radius, the
+      returned EdgePosition has no edge if there is none */
+  EdgePosition find_closest_position(const Vector2f& pos, float radius);
+
+  /** Find the cheapest path between two positions, returns false if
+      there is none. Queries share one PathFinder, so this must only
+      be called from one thread, see PathFinder for concurrent use. */
+  bool find_path(const EdgePosition& from, const EdgePosition& to,
+                 const PathCost& cost, Path& path);
+  bool find_path(const Vector2f& from, const Vector2f& to,
+                 const PathCost& cost, Path& path);
+
   /** Find edges that are near the given point */
   std::vector<EdgeHandle> find_edges(const Vector2f& pos, float radius);
 
@@ -138,8 +132,19 @@ public:
   void save(std::ostream& out);
   void write(FileWriter& writer);
 
-  bool valid(Edge* edge);
-  bool valid(Node* node);
+  bool valid(EdgeHandle edge) const { return edges.valid(edge); }
+  bool valid(NodeHandle node) const { return nodes.valid(node); }
+
+private:
+  NodeHandle insert_node(Node* node);
+  EdgeHandle insert_edge(Edge* edge);
+
+  /** Drop duplicates from \a candidates, keeping the first
+      occurrence, so results stay in spatial hash order instead of
+      being sorted by address */
+  void unique_candidates(std::vector<Node*>& candidates);
+  void unique_candidates(std::vector<Edge*>& candidates);
+  unsigned int next_query_stamp();
 
 private:
   NavigationGraph (const NavigationGraph&);
@@ -20,6 +20,9 @@
 
 Node::Node(const Vector2f& pos_) :
   pos(pos_),
+  slot(0),
+  query_stamp(0),
+  revision(0),
   edges()
   // FIXME: Do something with id
 {
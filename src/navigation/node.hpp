@@ -29,6 +29,16 @@ class Node
 {
 private:
   Vector2f pos;
+
+  /** slot in the NavigationGraph */
+  unsigned int slot;
+
+  /** last NavigationGraph query that returned this node */
+  unsigned int query_stamp;
+
+  /** NavigationGraph revision of the last change to the node or its
+      edges */
+  int revision;
   
 public:
   /** Edges connected to this node */
@@ -40,7 +50,12 @@ public:
   ~Node();
 
   Vector2f get_pos() const { return pos; }
-  void     set_pos(const Vector2f& p) { pos = p; }
+
+  unsigned int get_slot() const { return slot; }
+
+  /** Lets users of the graph find what changed since a revision, see
+      NavigationGraph::get_revision() */
+  int get_revision() const { return revision; }
 
   /** Connect the given edge to the node, the position is used to
       mark the end of the edge that is actually connected */
@@ -48,6 +63,13 @@ public:
 
   void remove_edge(Edge* edge);
 
+private:
+  friend class NavigationGraph;
+
+  /** Use NavigationGraph::move_node(), which keeps the spatial hash
+      up to date */
+  void set_pos(const Vector2f& p) { pos = p; }
+
 private:
   Node(const Node&);
   Node& operator=(const Node&);
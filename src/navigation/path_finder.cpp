@@ -0,0 +1,292 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "navigation/path_finder.hpp"
+
+#include <algorithm>
+#include <math.h>
+#include <glm/glm.hpp>
+
+#include "math/math.hpp"
+#include "navigation/navigation_graph.hpp"
+#include "navigation/node.hpp"
+
+namespace {
+
+/** Distance between \a p and the segment \a p1, \a p2 */
+float segment_distance(const Vector2f& p1, const Vector2f& p2, const Vector2f& p)
+{
+  const Vector2f v = p2 - p1;
+  const float len2 = glm::dot(v, v);
+  if (len2 == 0.0f)
+  {
+    return glm::length(p - p1);
+  }
+  else
+  {
+    const float u = math::mid(0.0f, glm::dot(p - p1, v) / len2, 1.0f);
+    return glm::length(p - (p1 + u * v));
+  }
+}
+
+} // namespace
+
+PathSearch::PathSearch() :
+  m_cost(),
+  m_parent(),
+  m_visited(),
+  m_closed(),
+  m_open(),
+  m_query(0),
+  m_goal_pos()
+{
+}
+
+void
+PathSearch::begin_query(const PathGraph& graph)
+{
+  m_open.clear();
+
+  // one extra slot for the goal, which sits in the middle of an edge
+  const size_t num_slots = static_cast<size_t>(graph.get_num_nodes()) + 1;
+  if (m_visited.size() != num_slots)
+  {
+    m_cost.resize(num_slots);
+    m_parent.resize(num_slots);
+    m_visited.assign(num_slots, 0);
+    m_closed.assign(num_slots, 0);
+    m_query = 0;
+  }
+
+  m_query += 1;
+  if (m_query == 0)
+  { // stamps wrapped around, start over
+    std::fill(m_visited.begin(), m_visited.end(), 0);
+    std::fill(m_closed.begin(), m_closed.end(), 0);
+    m_query = 1;
+  }
+}
+
+void
+PathSearch::relax(const PathGraph& graph, int node, int parent, float cost)
+{
+  if (m_closed[node] == m_query)
+    return;
+
+  if (m_visited[node] != m_query || cost < m_cost[node])
+  {
+    m_visited[node] = m_query;
+    m_cost[node]    = cost;
+    m_parent[node]  = parent;
+
+    const int goal = graph.get_num_nodes();
+    const float estimate = (node == goal) ? 0.0f : glm::length(m_goal_pos - graph.get_pos(node));
+
+    m_open.push_back(OpenEntry(cost + estimate, node));
+    std::push_heap(m_open.begin(), m_open.end());
+  }
+}
+
+bool
+PathSearch::find_path(const PathGraph& graph, const PathEnd& from, const PathEnd& to,
+                      const PathCost& cost, Path& path)
+{
+  path.clear();
+
+  const int goal = graph.get_num_nodes();
+
+  begin_query(graph);
+  m_goal_pos = to.point;
+
+  // the start sits in the middle of an edge, so both ends of the edge
+  // are seeded, a parent of -1 marks the start
+  relax(graph, from.node1, -1, from.pos * from.cost);
+  relax(graph, from.node2, -1, (1.0f - from.pos) * from.cost);
+  if (from.edge == to.edge)
+  {
+    relax(graph, goal, -1, fabsf(to.pos - from.pos) * from.cost);
+  }
+
+  while(!m_open.empty())
+  {
+    std::pop_heap(m_open.begin(), m_open.end());
+    const int node = m_open.back().node;
+    m_open.pop_back();
+
+    if (m_closed[node] == m_query)
+      continue; // outdated entry, node was reached cheaper already
+
+    m_closed[node] = m_query;
+
+    if (node == goal)
+    {
+      build_path(graph, from, to, path);
+      path.cost = m_cost[goal];
+      if (cost.smooth_tolerance > 0.0f)
+      {
+        path.smooth(cost.smooth_tolerance);
+      }
+      return true;
+    }
+
+    const float node_cost = m_cost[node];
+
+    if (node == to.node1)
+      relax(graph, goal, node, node_cost + to.pos * to.cost);
+    if (node == to.node2)
+      relax(graph, goal, node, node_cost + (1.0f - to.pos) * to.cost);
+
+    for(int i = graph.get_first_link(node); i < graph.get_last_link(node); ++i)
+    {
+      const PathGraph::Link& link = graph.get_link(i);
+      if (!(link.properties & cost.forbidden))
+      {
+        if (link.properties & cost.penalized)
+          relax(graph, link.target, node, node_cost + link.length * std::max(1.0f, cost.penalty));
+        else
+          relax(graph, link.target, node, node_cost + link.length);
+      }
+    }
+  }
+
+  return false;
+}
+
+void
+PathSearch::build_path(const PathGraph& graph, const PathEnd& from, const PathEnd& to, Path& path) const
+{
+  for(int node = m_parent[graph.get_num_nodes()]; node != -1; node = m_parent[node])
+  {
+    path.nodes.push_back(graph.get_node(node));
+  }
+  std::reverse(path.nodes.begin(), path.nodes.end());
+
+  // positions come from the copy, the nodes themselves might be gone
+  // or moved by now
+  path.points.clear();
+  path.points.reserve(path.nodes.size() + 2);
+  path.points.push_back(from.point);
+  for(int node = m_parent[graph.get_num_nodes()]; node != -1; node = m_parent[node])
+  {
+    path.points.push_back(graph.get_pos(node));
+  }
+  std::reverse(path.points.begin() + 1, path.points.end());
+  path.points.push_back(to.point);
+}
+
+PathFinder::PathFinder(NavigationGraph& graph) :
+  m_graph(graph),
+  m_path_graph(),
+  m_search()
+{
+}
+
+PathFinder::~PathFinder()
+{
+}
+
+void
+PathFinder::update()
+{
+  if (!m_path_graph || m_path_graph->get_revision() != m_graph.get_revision())
+  {
+    // a PathGraph still in use elsewhere stays alive with the old data
+    m_path_graph.reset(new PathGraph(m_graph));
+  }
+}
+
+boost::shared_ptr<const PathGraph>
+PathFinder::get_path_graph()
+{
+  update();
+  return m_path_graph;
+}
+
+bool
+PathFinder::find_path(const Vector2f& from, const Vector2f& to,
+                      const PathCost& cost, Path& path)
+{
+  const EdgePosition from_pos = m_graph.find_closest_position(from, cost.snap_radius);
+  const EdgePosition to_pos   = m_graph.find_closest_position(to, cost.snap_radius);
+
+  if (from_pos.edge && to_pos.edge)
+  {
+    return find_path(from_pos, to_pos, cost, path);
+  }
+  else
+  {
+    path.clear();
+    return false;
+  }
+}
+
+bool
+PathFinder::find_path(const EdgePosition& from, const EdgePosition& to,
+                      const PathCost& cost, Path& path)
+{
+  path.clear();
+
+  if (!from.edge || !to.edge)
+    return false;
+
+  update();
+
+  PathEnd from_end;
+  PathEnd to_end;
+  if (!m_path_graph->get_end(from, cost, from_end) ||
+      !m_path_graph->get_end(to, cost, to_end))
+    return false; // stale EdgePosition
+
+  return m_search.find_path(*m_path_graph, from_end, to_end, cost, path);
+}
+
+void
+Path::build_points(const Vector2f& from, const Vector2f& to)
+{
+  points.clear();
+  points.reserve(nodes.size() + 2);
+  points.push_back(from);
+  for(std::vector<Node*>::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+  {
+    points.push_back((*i)->get_pos());
+  }
+  points.push_back(to);
+}
+
+void
+Path::smooth(float tolerance)
+{
+  if (points.size() <= 2)
+    return;
+
+  // greedily drop every point that lies close to the line between the
+  // last point kept and the next one
+  size_t out = 1;
+  for(size_t i = 1; i + 1 < points.size(); ++i)
+  {
+    if (segment_distance(points[out-1], points[i+1], points[i]) >= tolerance)
+    {
+      points[out] = points[i];
+      out += 1;
+    }
+  }
+  points[out] = points.back();
+  points.resize(out + 1);
+}
+
+/* EOF */
@@ -0,0 +1,190 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_NAVIGATION_PATH_FINDER_HPP
+#define HEADER_WINDSTILLE_NAVIGATION_PATH_FINDER_HPP
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+#include "math/vector2f.hpp"
+#include "navigation/edge_position.hpp"
+#include "navigation/path_graph.hpp"
+#include "navigation/properties.hpp"
+
+class Edge;
+class NavigationGraph;
+class Node;
+
+struct PathCost
+{
+  PathCost() :
+    forbidden(0),
+    penalized(0),
+    penalty(1.0f),
+    snap_radius(64.0f),
+    smooth_tolerance(0.0f)
+  {}
+
+  /** Edges having any of these properties are not used, except for
+      the edges the path starts and ends on */
+  EdgeProperties forbidden;
+
+  /** The length of edges having any of these properties gets
+      multiplied by \a penalty, values below 1 are treated as 1 */
+  EdgeProperties penalized;
+  float penalty;
+
+  /** Maximum distance between a Vector2f and the graph when looking
+      for the start and goal edges */
+  float snap_radius;
+
+  /** Points of the path that are closer than this to the straight
+      line between their neighbours get dropped, 0 disables smoothing */
+  float smooth_tolerance;
+};
+
+struct Path
+{
+  Path() :
+    points(),
+    nodes(),
+    cost(0.0f)
+  {}
+
+  /** World positions from start to goal, both included */
+  std::vector<Vector2f> points;
+
+  /** The nodes passed on the way, smoothing doesn't touch these */
+  std::vector<Node*> nodes;
+
+  /** Cost of the path as defined by the PathCost of the query */
+  float cost;
+
+  void clear()
+  {
+    points.clear();
+    nodes.clear();
+    cost = 0.0f;
+  }
+
+  /** Fills \a points with \a from, the positions of \a nodes and \a to */
+  void build_points(const Vector2f& from, const Vector2f& to);
+
+  /** Drops points that are closer than \a tolerance to the straight
+      line between their neighbours */
+  void smooth(float tolerance);
+};
+
+/**
+ * A* search over a PathGraph. The search buffers are kept between
+ * queries, so a query doesn't allocate once the buffers have grown to
+ * the size of the graph. A PathSearch only reads the PathGraph, any
+ * number of them can search the same PathGraph concurrently.
+ */
+class PathSearch
+{
+private:
+  struct OpenEntry
+  {
+    OpenEntry() : cost(0.0f), node(0) {}
+    OpenEntry(float cost_, int node_) : cost(cost_), node(node_) {}
+
+    /** estimated total cost through the node */
+    float cost;
+    int node;
+
+    bool operator<(const OpenEntry& rhs) const
+    {
+      // reversed, so that std::push_heap() gives a min-heap
+      return cost > rhs.cost;
+    }
+  };
+
+  // Search state, one entry per node plus one for the goal. Entries
+  // are only valid when their stamp matches m_query, which saves
+  // clearing the arrays for each query.
+  std::vector<float> m_cost;
+  std::vector<int>   m_parent;
+  std::vector<unsigned int> m_visited;
+  std::vector<unsigned int> m_closed;
+  std::vector<OpenEntry> m_open;
+  unsigned int m_query;
+
+  Vector2f m_goal_pos;
+
+public:
+  PathSearch();
+
+  /** Finds the cheapest path from \a from to \a to, returns false
+      and an empty \a path if there is none. The nodes of \a path are
+      taken from \a graph and not dereferenced. */
+  bool find_path(const PathGraph& graph, const PathEnd& from, const PathEnd& to,
+                 const PathCost& cost, Path& path);
+
+private:
+  void begin_query(const PathGraph& graph);
+  void relax(const PathGraph& graph, int node, int parent, float cost);
+  void build_path(const PathGraph& graph, const PathEnd& from, const PathEnd& to, Path& path) const;
+};
+
+/**
+ * A* search over a NavigationGraph. The graph is copied into a
+ * PathGraph, which gets replaced when the revision of the graph
+ * changes.
+ *
+ * A PathFinder must only be used by one thread at a time, concurrent
+ * queries need a PathSearch each, see PathQueryQueue.
+ */
+class PathFinder
+{
+private:
+  NavigationGraph& m_graph;
+  boost::shared_ptr<const PathGraph> m_path_graph;
+  PathSearch m_search;
+
+public:
+  PathFinder(NavigationGraph& graph);
+  ~PathFinder();
+
+  /** Finds the cheapest path from \a from to \a to, returns false
+      and an empty \a path if there is none */
+  bool find_path(const EdgePosition& from, const EdgePosition& to,
+                 const PathCost& cost, Path& path);
+
+  /** Same as above, \a from and \a to are first moved onto the
+      closest edge within PathCost::snap_radius */
+  bool find_path(const Vector2f& from, const Vector2f& to,
+                 const PathCost& cost, Path& path);
+
+  /** Replaces the PathGraph if the graph has changed, done
+      automatically by find_path() */
+  void update();
+
+  /** Returns the current copy of the graph, which stays valid for as
+      long as it is referenced, even after the graph has changed */
+  boost::shared_ptr<const PathGraph> get_path_graph();
+
+private:
+  PathFinder(const PathFinder&);
+  PathFinder& operator=(const PathFinder&);
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,96 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "navigation/path_graph.hpp"
+
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include "navigation/edge.hpp"
+#include "navigation/edge_position.hpp"
+#include "navigation/navigation_graph.hpp"
+#include "navigation/node.hpp"
+#include "navigation/path_finder.hpp"
+
+PathGraph::PathGraph(const NavigationGraph& graph) :
+  m_revision(graph.get_revision()),
+  m_nodes(graph.get_num_node_slots(), static_cast<Node*>(0)),
+  m_positions(graph.get_num_node_slots()),
+  m_first_link(),
+  m_links()
+{
+  const NavigationGraph::Nodes& nodes = graph.get_nodes();
+  for(NavigationGraph::Nodes::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+  {
+    m_nodes[(*i)->get_slot()]     = *i;
+    m_positions[(*i)->get_slot()] = (*i)->get_pos();
+  }
+
+  m_first_link.reserve(m_nodes.size() + 1);
+  for(std::vector<Node*>::const_iterator i = m_nodes.begin(); i != m_nodes.end(); ++i)
+  {
+    m_first_link.push_back(static_cast<int>(m_links.size()));
+    if (!*i)
+      continue;
+
+    for(Node::Edges::const_iterator e = (*i)->edges.begin(); e != (*i)->edges.end(); ++e)
+    {
+      // the EdgePosition marks which end of the edge is connected to
+      // the node, the link goes to the other end
+      Node* target = (e->pos == 0.0f) ? e->edge->get_node2() : e->edge->get_node1();
+      const int index = get_index(target);
+      if (index != -1)
+      {
+        m_links.push_back(Link(index, e->edge->get_properties(),
+                               glm::length(target->get_pos() - (*i)->get_pos())));
+      }
+    }
+  }
+  m_first_link.push_back(static_cast<int>(m_links.size()));
+}
+
+int
+PathGraph::get_index(Node* node) const
+{
+  const unsigned int slot = node->get_slot();
+  if (slot < m_nodes.size() && m_nodes[slot] == node)
+    return static_cast<int>(slot);
+  else
+    return -1;
+}
+
+bool
+PathGraph::get_end(const EdgePosition& pos, const PathCost& cost, PathEnd& end) const
+{
+  if (!pos.edge)
+    return false;
+
+  end.edge  = pos.edge;
+  end.node1 = get_index(pos.edge->get_node1());
+  end.node2 = get_index(pos.edge->get_node2());
+  end.pos   = pos.pos;
+  end.point = pos.get_pos();
+
+  end.cost = glm::length(pos.edge->get_vector());
+  if (pos.edge->get_properties() & cost.penalized)
+    end.cost *= std::max(1.0f, cost.penalty);
+
+  return end.node1 != -1 && end.node2 != -1;
+}
+
+/* EOF */
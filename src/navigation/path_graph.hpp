@@ -0,0 +1,125 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_NAVIGATION_PATH_GRAPH_HPP
+#define HEADER_WINDSTILLE_NAVIGATION_PATH_GRAPH_HPP
+
+#include <vector>
+
+#include "math/vector2f.hpp"
+#include "navigation/properties.hpp"
+
+class Edge;
+class EdgePosition;
+class NavigationGraph;
+class Node;
+struct PathCost;
+
+/** A start or goal of a search, an EdgePosition in terms of a
+    PathGraph */
+struct PathEnd
+{
+  PathEnd() :
+    edge(0),
+    node1(-1),
+    node2(-1),
+    pos(0.0f),
+    cost(0.0f),
+    point()
+  {}
+
+  /** only compared, never dereferenced */
+  const Edge* edge;
+
+  int node1;
+  int node2;
+
+  /** position on the edge in range [0,1] */
+  float pos;
+
+  /** cost of the whole edge */
+  float cost;
+
+  /** world position */
+  Vector2f point;
+};
+
+/**
+ * Immutable copy of the topology and node positions of a
+ * NavigationGraph, stored as compact adjacency arrays indexed by node
+ * slot. As it doesn't refer back to the graph, a PathGraph can be
+ * searched from worker threads while the NavigationGraph keeps
+ * changing on the main thread.
+ */
+class PathGraph
+{
+public:
+  struct Link
+  {
+    Link() : target(0), properties(0), length(0.0f) {}
+    Link(int target_, EdgeProperties properties_, float length_) :
+      target(target_), properties(properties_), length(length_) {}
+
+    int target;
+    EdgeProperties properties;
+    float length;
+  };
+
+private:
+  int m_revision;
+
+  /** nodes by slot, unused slots are 0, only used for identification */
+  std::vector<Node*> m_nodes;
+  std::vector<Vector2f> m_positions;
+
+  /** the links of node i are m_links[m_first_link[i]] up to
+      m_links[m_first_link[i+1]] */
+  std::vector<int>  m_first_link;
+  std::vector<Link> m_links;
+
+public:
+  PathGraph(const NavigationGraph& graph);
+
+  /** revision of the NavigationGraph at the time of the copy */
+  int get_revision() const { return m_revision; }
+
+  int get_num_nodes() const { return static_cast<int>(m_nodes.size()); }
+  Node* get_node(int index) const { return m_nodes[index]; }
+  const Vector2f& get_pos(int index) const { return m_positions[index]; }
+
+  int get_first_link(int index) const { return m_first_link[index]; }
+  int get_last_link(int index)  const { return m_first_link[index+1]; }
+  const Link& get_link(int link) const { return m_links[link]; }
+
+  /** Returns the index of \a node or -1 if it isn't part of the
+      copy, \a node must still be alive */
+  int get_index(Node* node) const;
+
+  /** Translates \a pos into a PathEnd, returns false if its edge
+      isn't part of the copy. Reads the edge, so this has to happen
+      while the NavigationGraph is unchanged. */
+  bool get_end(const EdgePosition& pos, const PathCost& cost, PathEnd& end) const;
+
+private:
+  PathGraph(const PathGraph&);
+  PathGraph& operator=(const PathGraph&);
+};
+
+#endif
+
+/* EOF */
@@ -28,7 +28,7 @@ enum {
   STAIRS   = (1<<2)
 };
 
-typedef uint32_t Properties;
+typedef uint32_t EdgeProperties;
 
 #endif
 
@@ -0,0 +1,146 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_NAVIGATION_SPATIAL_HASH_HPP
+#define HEADER_WINDSTILLE_NAVIGATION_SPATIAL_HASH_HPP
+
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+#include "math/math.hpp"
+#include "math/rect.hpp"
+
+/**
+ * Uniform grid of unlimited size, the cells are hashed into a fixed
+ * number of buckets. An item is stored in every cell its bounding box
+ * overlaps, so insert() and remove() must be given the same bounding
+ * box.
+ *
+ * query() returns candidates only: the result may contain duplicates
+ * and items that merely share a bucket with the queried cells, the
+ * caller has to do the exact test.
+ */
+template<class T>
+class SpatialHash
+{
+private:
+  typedef std::vector<T> Bucket;
+
+  std::vector<Bucket> m_buckets;
+  float m_cell_size;
+
+public:
+  /** \a num_buckets must be a power of two */
+  SpatialHash(float cell_size, int num_buckets) :
+    m_buckets(static_cast<size_t>(num_buckets)),
+    m_cell_size(cell_size)
+  {}
+
+  void insert(const T& item, const Rectf& bbox)
+  {
+    int x1, y1, x2, y2;
+    get_cells(bbox, x1, y1, x2, y2);
+
+    for(int y = y1; y <= y2; ++y)
+      for(int x = x1; x <= x2; ++x)
+        get_bucket(x, y).push_back(item);
+  }
+
+  void remove(const T& item, const Rectf& bbox)
+  {
+    int x1, y1, x2, y2;
+    get_cells(bbox, x1, y1, x2, y2);
+
+    for(int y = y1; y <= y2; ++y)
+    {
+      for(int x = x1; x <= x2; ++x)
+      {
+        Bucket& bucket = get_bucket(x, y);
+        typename Bucket::iterator it = std::find(bucket.begin(), bucket.end(), item);
+        if (it != bucket.end())
+        {
+          *it = bucket.back();
+          bucket.pop_back();
+        }
+      }
+    }
+  }
+
+  void clear()
+  {
+    for(typename std::vector<Bucket>::iterator i = m_buckets.begin(); i != m_buckets.end(); ++i)
+      i->clear();
+  }
+
+  /** Appends the items of all cells overlapping \a rect to \a out */
+  void query(const Rectf& rect, std::vector<T>& out) const
+  {
+    int x1, y1, x2, y2;
+    get_cells(rect, x1, y1, x2, y2);
+
+    if (static_cast<float>(x2 - x1 + 1) * static_cast<float>(y2 - y1 + 1) >= static_cast<float>(m_buckets.size()))
+    { // the rect covers more cells than there are buckets, so
+      // visiting each bucket once is cheaper
+      for(typename std::vector<Bucket>::const_iterator i = m_buckets.begin(); i != m_buckets.end(); ++i)
+        out.insert(out.end(), i->begin(), i->end());
+    }
+    else
+    {
+      for(int y = y1; y <= y2; ++y)
+      {
+        for(int x = x1; x <= x2; ++x)
+        {
+          const Bucket& bucket = m_buckets[get_bucket_index(x, y)];
+          out.insert(out.end(), bucket.begin(), bucket.end());
+        }
+      }
+    }
+  }
+
+private:
+  void get_cells(const Rectf& rect, int& x1, int& y1, int& x2, int& y2) const
+  {
+    x1 = get_cell(std::min(rect.left, rect.right));
+    y1 = get_cell(std::min(rect.top,  rect.bottom));
+    x2 = get_cell(std::max(rect.left, rect.right));
+    y2 = get_cell(std::max(rect.top,  rect.bottom));
+  }
+
+  int get_cell(float v) const
+  {
+    // clamped, so that queries with a huge radius don't overflow
+    return static_cast<int>(math::mid(-1.0e9f, floorf(v / m_cell_size), 1.0e9f));
+  }
+
+  size_t get_bucket_index(int x, int y) const
+  {
+    const uint32_t hash = (static_cast<uint32_t>(x) * 73856093U) ^ (static_cast<uint32_t>(y) * 19349663U);
+    return hash & (m_buckets.size() - 1);
+  }
+
+  Bucket& get_bucket(int x, int y)
+  {
+    return m_buckets[get_bucket_index(x, y)];
+  }
+};
+
+#endif
+
+/* EOF */
@@ -45,6 +45,7 @@ public:
   ~Liquid();
 
   void update(float delta);
+  bool is_thread_safe() const { return true; }
 
 private:
   void update_scene_graph();
@@ -23,8 +23,19 @@
 
 #include "engine/sector.hpp"
 #include "particles/particle_system.hpp"
-#include "scenegraph/scene_graph.hpp"
-#include "scenegraph/particle_system_drawable.hpp"
+#include "scenegraph/particle_batcher.hpp"
+#include "screen/view.hpp"
+
+namespace {
+
+/** systems closer than this to the visible area are still simulated,
+    so that they are up to date when they scroll into view */
+const float kLodMargin = 128.0f;
+
+/** lowest detail at which systems are simulated when zoomed out */
+const float kLodMinDetail = 0.25f;
+
+} // namespace
 
 ParticleSystems::ParticleSystems(const FileReader& reader) :
   m_systems(),
@@ -58,19 +69,62 @@ ParticleSystems::ParticleSystems(const FileReader& reader) :
 
   for(Systems::iterator i = m_systems.begin(); i != m_systems.end(); ++i)
   {
-    boost::shared_ptr<ParticleSystemDrawable> drawable(new ParticleSystemDrawable(**i));
+    m_drawables.push_back(Sector::current()->get_particle_batcher().add(*i));
+  }
+}
 
-    m_drawables.push_back(drawable);
-    Sector::current()->get_scene_graph().add_drawable(drawable);
+ParticleSystems::~ParticleSystems()
+{
+  // the drawables would otherwise keep drawing the systems, objects
+  // are destroyed before the ParticleBatcher of their Sector
+  Sector* sector = Sector::current();
+  if (sector)
+  {
+    for(size_t i = 0; i < m_drawables.size(); ++i)
+    {
+      sector->get_particle_batcher().remove(m_systems[i], m_drawables[i]);
+    }
   }
 }
 
 void
 ParticleSystems::update(float delta)
 {
-  for(Systems::iterator i = m_systems.begin(); i != m_systems.end(); ++i)
+  View* view = View::current();
+  if (!view)
   {
-    (*i)->update(delta);
+    for(Systems::iterator i = m_systems.begin(); i != m_systems.end(); ++i)
+    {
+      (*i)->update(delta);
+    }
+  }
+  else
+  {
+    // Systems outside of the view aren't simulated, they catch up
+    // analytically when they get close to it again. When zoomed out
+    // each particle covers fewer pixels, so fewer of them are used.
+    const Rectf clip_rect = view->get_clip_rect().grow(kLodMargin);
+    const float detail = math::mid(kLodMinDetail, view->get_gc_state().get_zoom(), 1.0f);
+
+    for(Systems::iterator i = m_systems.begin(); i != m_systems.end(); ++i)
+    {
+      // the drawers offset the particles by the system position
+      Rectf bbox = (*i)->get_bounding_box();
+      bbox.left   += (*i)->get_x_pos();
+      bbox.right  += (*i)->get_x_pos();
+      bbox.top    += (*i)->get_y_pos();
+      bbox.bottom += (*i)->get_y_pos();
+
+      if (clip_rect.is_overlapped(bbox))
+      {
+        (*i)->set_detail(detail);
+        (*i)->update(delta);
+      }
+      else
+      {
+        (*i)->skip();
+      }
+    }
   }
 }
 
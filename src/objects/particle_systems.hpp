@@ -25,22 +25,24 @@
 #include "engine/game_object.hpp"
 
 class ParticleSystem;
-class ParticleSystemDrawable;
+class Drawable;
 class FileReader;
 
 class ParticleSystems : public GameObject
 {
 private:
   typedef std::vector<boost::shared_ptr<ParticleSystem> > Systems;
-  typedef std::vector<boost::shared_ptr<ParticleSystemDrawable> > Drawables;
+  typedef std::vector<boost::shared_ptr<Drawable> > Drawables;
 
   Systems   m_systems;
   Drawables m_drawables;
 
 public:
   ParticleSystems(const FileReader& reader);
+  ~ParticleSystems();
 
   void update (float delta);
+  bool is_thread_safe() const { return true; }
 
 private:
   ParticleSystems(const ParticleSystems&);
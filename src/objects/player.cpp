@@ -49,7 +49,8 @@ Player::Player () :
   state(STAND),
   jump_foot(),
   reload_time(),
-  z_pos()
+  z_pos(),
+  last_pos()
 {
   Sprite3D sprite(Pathname("models/characters/jane/jane.wsprite"));
   pos.x = 320;
@@ -67,6 +68,7 @@ Player::Player () :
 
   c_object->set_pos(pos);
   c_object->set_velocity(velocity);
+  last_pos = pos;
   
   c_object->sig_collision().connect(boost::bind(&Player::collision, this, _1));
 
@@ -98,6 +100,11 @@ Player::draw (SceneContext& sc)
 
   //m_drawable->get_sprite().draw(sc.color(), pos + Vector2f(0.0f, 1.0f), z_pos);
 
+  // in between the last two steps, like the camera, update() leaves
+  // the drawable at the current position
+  const Vector2f draw_pos = last_pos + (pos - last_pos) * sc.get_interpolation();
+  m_drawable->set_pos(draw_pos);
+
   Entity* obj = find_useable_entity();
   if (obj)
   {
@@ -109,7 +116,7 @@ Player::draw (SceneContext& sc)
   // Draw weapon at the 'Weapon' attachment point
   Sprite3D::PointID id = m_drawable->get_sprite().get_attachment_point_id("Weapon");
   sc.push_modelview();
-  sc.translate(pos.x, pos.y);
+  sc.translate(draw_pos.x, draw_pos.y);
   sc.mult_modelview(m_drawable->get_sprite().get_attachment_point_matrix(id));
   weapon->draw(sc);
   sc.pop_modelview();
@@ -117,7 +124,7 @@ Player::draw (SceneContext& sc)
   if (laser_pointer->is_active())
   {
     sc.push_modelview();
-    sc.translate(pos.x, pos.y - 80);
+    sc.translate(draw_pos.x, draw_pos.y - 80);
     laser_pointer->draw(sc);
     sc.pop_modelview();
   }
@@ -833,6 +840,9 @@ Player::set_pos(Vector2f pos_)
 {
   Entity::set_pos(pos_);
   c_object->set_pos(pos_);
+
+  // a jump, not something to interpolate
+  last_pos = pos_;
 }
 
 /* EOF */
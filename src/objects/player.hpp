@@ -93,6 +93,9 @@ private:
   double reload_time;
   float  z_pos;
 
+  /** position before the last update step */
+  Vector2f last_pos;
+
 public:
   Player ();
   virtual ~Player ();
@@ -103,6 +106,10 @@ public:
   void update(float delta);
   void update(const Controller& controller, float delta);
 
+  /** Remembers the current position, to be called before each update
+      step */
+  void begin_step() { last_pos = pos; }
+
   void start_listening();
   void stop_listening();
   
@@ -26,7 +26,8 @@
 Swarm::Swarm(const FileReader& props) :
   agents(),
   target(),
-  turn_speed()
+  turn_speed(),
+  rng(Random::get_seed(), Random::next_stream())
 {
   int count = 100;
   turn_speed = 7.0f;
@@ -85,13 +86,18 @@ Swarm::draw(SceneContext& sc)
 }
 
 void
-Swarm::update(float delta)
+Swarm::prepare_update()
 {
+  // the mouse and the view belong to the main thread
   int x, y;
   SDL_GetMouseState(&x, &y);
   
   target = GameSession::current()->get_view()->screen_to_world(Vector2f(static_cast<float>(x), static_cast<float>(y)));
+}
 
+void
+Swarm::update(float delta)
+{
   for(Agents::iterator i = agents.begin(); i != agents.end(); ++i)
   {
     i->last_pos = i->pos;
@@ -120,9 +126,9 @@ Swarm::update(float delta)
     }
     else
     {
-      i->angle += rnd.frand(-15.0f, 15.0f) * delta;
+      i->angle += rng.frand(-15.0f, 15.0f) * delta;
       //i->speed += 150.0f - fabs(i->angle);
-      i->speed = rnd.frand(50.0f, 100.0f);
+      i->speed = rng.frand(50.0f, 100.0f);
     }
 
     i->pos.x += i->speed * cosf(i->angle) * delta;
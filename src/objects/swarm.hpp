@@ -20,6 +20,7 @@
 #define HEADER_WINDSTILLE_OBJECTS_SWARM_HPP
 
 #include "engine/entity.hpp"
+#include "math/random.hpp"
 
 class SwarmAgent
 {
@@ -52,11 +53,15 @@ private:
 
   float turn_speed; 
 
+  Random rng;
+
 public:
   Swarm(const FileReader& reader);
   
   void draw(SceneContext& sc);
   void update(float delta);
+  bool is_thread_safe() const { return true; }
+  void prepare_update();
 
 private:
   Swarm (const Swarm&);
@@ -22,6 +22,7 @@
 #include <glm/ext.hpp>
 
 #include "display/display.hpp"
+#include "display/framebuffer_pool.hpp"
 #include "display/shader_object.hpp"
 #include "particles/particle_system.hpp"
 #include "display/opengl_state.hpp"
@@ -96,7 +97,7 @@ public:
     state.activate();    
 
     glBegin(GL_QUADS);
-    for(ParticleSystem::Particles::iterator i = psys.begin(); i != psys.end(); ++i)
+    for(ParticleSystem::const_iterator i = psys.begin(); i != psys.end(); ++i)
     {
       if (i->t != -1.0f)
       {
@@ -166,7 +167,6 @@ public:
 };
 
 DeformDrawer::DeformDrawer(FileReader& /*props*/) :
-  framebuffer(Framebuffer::create_with_texture(GL_TEXTURE_2D, 800, 600)),
   surface(Surface::create(Pathname("images/particles/deform2.png"))),
   shader_program(ShaderProgram::create())
 {
@@ -181,6 +181,9 @@ DeformDrawer::~DeformDrawer()
 void
 DeformDrawer::draw(DrawingContext& dc, ParticleSystem& psys)
 {
+  // the request keeps the framebuffer until the DrawingContext gets
+  // cleared, after that it goes back to the pool
+  FramebufferPtr framebuffer = FramebufferPool::current()->get(FramebufferPool::kTexture, Size(800, 600));
   dc.draw(new DeformDrawerRequest(Vector2f(400, 300), 1200, dc.get_modelview(), 
                                   framebuffer, surface, psys, shader_program));
 }
@@ -38,7 +38,6 @@ class ParticleSystem;
 class DeformDrawer : public Drawer
 {
 private:
-  FramebufferPtr framebuffer;
   SurfacePtr     surface;
   ShaderProgramPtr shader_program;
 
@@ -17,6 +17,13 @@
 */
 
 #include "particles/particle_system.hpp"
+
+#if defined(__AVX__)
+#  include <immintrin.h>
+#elif defined(__SSE__)
+#  include <xmmintrin.h>
+#endif
+
 #include "display/scene_context.hpp"
 #include "util/file_reader.hpp"
 #include "particles/spark_drawer.hpp"
@@ -25,7 +32,17 @@
 #include "particles/randomizer.hpp"
 
 ParticleSystem::ParticleSystem(FileReader& props)
-  : particles(),
+  : pos_x(),
+    pos_y(),
+    vel_x(),
+    vel_y(),
+    angle(),
+    age(),
+    respawn_queue(),
+    active_count(0),
+    detail(1.0f),
+    skipped_steps(0),
+    bounding_box(),
     life_time(1.0f),
     randomizer(new PointRandomizer()),
     drawer(),
@@ -45,7 +62,8 @@ ParticleSystem::ParticleSystem(FileReader& props)
     speed_start(100.0),
     speed_stop(200.0f),
     color_start(1.0f, 1.0f, 1.0f, 1.0f),
-    color_stop(   0,    0,    0,    0)
+    color_stop(   0,    0,    0,    0),
+    rng(Random::get_seed(), Random::next_stream())
 {
   float p_bunching = 1.0; 
   props.get("bunching", p_bunching);
@@ -193,7 +211,17 @@ ParticleSystem::ParticleSystem(FileReader& props)
 }
 
 ParticleSystem::ParticleSystem()
-  : particles(),
+  : pos_x(),
+    pos_y(),
+    vel_x(),
+    vel_y(),
+    angle(),
+    age(),
+    respawn_queue(),
+    active_count(0),
+    detail(1.0f),
+    skipped_steps(0),
+    bounding_box(),
     life_time(1.0f),
     randomizer(new PointRandomizer()),
     drawer(),
@@ -213,7 +241,8 @@ ParticleSystem::ParticleSystem()
     speed_start(100.0),
     speed_stop(200.0f),
     color_start(1.0f, 1.0f, 1.0f, 1.0f),
-    color_stop(   0,    0,    0,    0)
+    color_stop(   0,    0,    0,    0),
+    rng(Random::get_seed(), Random::next_stream())
 {
   set_count(70);
 }
@@ -242,67 +271,311 @@ ParticleSystem::draw() const
 }
 
 void
-ParticleSystem::spawn(Particle& particle)
+ParticleSystem::spawn(int i)
 {
-  randomizer->set_pos(particle);
+  Particle particle;
+  particle.x = 0.0f;
+  particle.y = 0.0f;
+  randomizer->set_pos(particle, rng);
 
-  particle.x   += x_pos + spawn_x;
-  particle.y   += y_pos + spawn_y;
+  pos_x[i] = particle.x + x_pos + spawn_x;
+  pos_y[i] = particle.y + y_pos + spawn_y;
   // FIXME: parent handling disabled due to work on the editor
-  // particle.x   += (parent ? parent->get_pos().x : 0) + x_pos + spawn_x;
-  // particle.y   += (parent ? parent->get_pos().y : 0) + y_pos + spawn_y;
+  // pos_x[i] += (parent ? parent->get_pos().x : 0);
+  // pos_y[i] += (parent ? parent->get_pos().y : 0);
 
-  float direction = rnd.frand(cone_start, cone_stop);
-  float speed     = rnd.frand(speed_start, speed_stop);
-  particle.v_x    = cosf(direction) * speed;
-  particle.v_y    = sinf(direction) * speed;
+  float direction = rng.frand(cone_start, cone_stop);
+  float speed     = rng.frand(speed_start, speed_stop);
+  vel_x[i] = cosf(direction) * speed;
+  vel_y[i] = sinf(direction) * speed;
 
-  particle.angle = rnd.frand(360.0f);
+  angle[i] = rng.frand(360.0f);
 
-  particle.t   = fmodf(particle.t, life_time);
+  age[i] = fmodf(age[i], life_time);
 }
 
 void
 ParticleSystem::update(float delta)
 {
-  for(Particles::iterator i = particles.begin(); i != particles.end(); ++i)
+  const int count = active_count;
+  if (count == 0)
+  {
+    return;
+  }
+
+  if (skipped_steps > 0)
   {
-    if (i->t > life_time)
+    fast_forward(delta, skipped_steps);
+    skipped_steps = 0;
+  }
+
+  int i = 0;
+
+  float* const x  = &pos_x[0];
+  float* const y  = &pos_y[0];
+  float* const vx = &vel_x[0];
+  float* const vy = &vel_y[0];
+  float* const t  = &age[0];
+
+  float min_x = x[0];
+  float min_y = y[0];
+  float max_x = x[0];
+  float max_y = y[0];
+
+  respawn_queue.clear();
+
+  // Particles that outlived life_time are left alone and respawned
+  // afterwards, all others are moved and aged. The SIMD loops do the
+  // same as the scalar loop below, the latter handles the remainder.
+#if defined(__AVX__)
+  {
+    const __m256 v_delta = _mm256_set1_ps(delta);
+    const __m256 v_life  = _mm256_set1_ps(life_time);
+    const __m256 v_gx    = _mm256_set1_ps(gravity_x);
+    const __m256 v_gy    = _mm256_set1_ps(gravity_y);
+
+    __m256 v_min_x = _mm256_set1_ps(min_x);
+    __m256 v_min_y = _mm256_set1_ps(min_y);
+    __m256 v_max_x = _mm256_set1_ps(max_x);
+    __m256 v_max_y = _mm256_set1_ps(max_y);
+
+    for(; i + 8 <= count; i += 8)
     {
-      spawn(*i);
+      const __m256 v_t   = _mm256_loadu_ps(t + i);
+      const __m256 alive = _mm256_cmp_ps(v_t, v_life, _CMP_LE_OQ);
+      const __m256 v_vx  = _mm256_loadu_ps(vx + i);
+      const __m256 v_vy  = _mm256_loadu_ps(vy + i);
+      const __m256 step  = _mm256_and_ps(alive, v_delta);
+      const __m256 v_x   = _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(v_vx, step));
+      const __m256 v_y   = _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(v_vy, step));
+
+      _mm256_storeu_ps(t + i,  _mm256_add_ps(v_t, step));
+      _mm256_storeu_ps(x + i,  v_x);
+      _mm256_storeu_ps(y + i,  v_y);
+      _mm256_storeu_ps(vx + i, _mm256_add_ps(v_vx, _mm256_and_ps(alive, v_gx)));
+      _mm256_storeu_ps(vy + i, _mm256_add_ps(v_vy, _mm256_and_ps(alive, v_gy)));
+
+      v_min_x = _mm256_min_ps(v_min_x, v_x);
+      v_min_y = _mm256_min_ps(v_min_y, v_y);
+      v_max_x = _mm256_max_ps(v_max_x, v_x);
+      v_max_y = _mm256_max_ps(v_max_y, v_y);
+
+      const int dead = ~_mm256_movemask_ps(alive) & 0xff;
+      if (dead)
+      {
+        for(int lane = 0; lane < 8; ++lane)
+        {
+          if (dead & (1 << lane))
+            respawn_queue.push_back(i + lane);
+        }
+      }
+    }
+
+    float lanes[4][8];
+    _mm256_storeu_ps(lanes[0], v_min_x);
+    _mm256_storeu_ps(lanes[1], v_min_y);
+    _mm256_storeu_ps(lanes[2], v_max_x);
+    _mm256_storeu_ps(lanes[3], v_max_y);
+    for(int lane = 0; lane < 8; ++lane)
+    {
+      min_x = std::min(min_x, lanes[0][lane]);
+      min_y = std::min(min_y, lanes[1][lane]);
+      max_x = std::max(max_x, lanes[2][lane]);
+      max_y = std::max(max_y, lanes[3][lane]);
+    }
+  }
+#elif defined(__SSE__)
+  {
+    const __m128 v_delta = _mm_set1_ps(delta);
+    const __m128 v_life  = _mm_set1_ps(life_time);
+    const __m128 v_gx    = _mm_set1_ps(gravity_x);
+    const __m128 v_gy    = _mm_set1_ps(gravity_y);
+
+    __m128 v_min_x = _mm_set1_ps(min_x);
+    __m128 v_min_y = _mm_set1_ps(min_y);
+    __m128 v_max_x = _mm_set1_ps(max_x);
+    __m128 v_max_y = _mm_set1_ps(max_y);
+
+    for(; i + 4 <= count; i += 4)
+    {
+      const __m128 v_t   = _mm_loadu_ps(t + i);
+      const __m128 alive = _mm_cmple_ps(v_t, v_life);
+      const __m128 v_vx  = _mm_loadu_ps(vx + i);
+      const __m128 v_vy  = _mm_loadu_ps(vy + i);
+      const __m128 step  = _mm_and_ps(alive, v_delta);
+      const __m128 v_x   = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(v_vx, step));
+      const __m128 v_y   = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(v_vy, step));
+
+      _mm_storeu_ps(t + i,  _mm_add_ps(v_t, step));
+      _mm_storeu_ps(x + i,  v_x);
+      _mm_storeu_ps(y + i,  v_y);
+      _mm_storeu_ps(vx + i, _mm_add_ps(v_vx, _mm_and_ps(alive, v_gx)));
+      _mm_storeu_ps(vy + i, _mm_add_ps(v_vy, _mm_and_ps(alive, v_gy)));
+
+      v_min_x = _mm_min_ps(v_min_x, v_x);
+      v_min_y = _mm_min_ps(v_min_y, v_y);
+      v_max_x = _mm_max_ps(v_max_x, v_x);
+      v_max_y = _mm_max_ps(v_max_y, v_y);
+
+      const int dead = ~_mm_movemask_ps(alive) & 0xf;
+      if (dead)
+      {
+        for(int lane = 0; lane < 4; ++lane)
+        {
+          if (dead & (1 << lane))
+            respawn_queue.push_back(i + lane);
+        }
+      }
+    }
+
+    float lanes[4][4];
+    _mm_storeu_ps(lanes[0], v_min_x);
+    _mm_storeu_ps(lanes[1], v_min_y);
+    _mm_storeu_ps(lanes[2], v_max_x);
+    _mm_storeu_ps(lanes[3], v_max_y);
+    for(int lane = 0; lane < 4; ++lane)
+    {
+      min_x = std::min(min_x, lanes[0][lane]);
+      min_y = std::min(min_y, lanes[1][lane]);
+      max_x = std::max(max_x, lanes[2][lane]);
+      max_y = std::max(max_y, lanes[3][lane]);
+    }
+  }
+#endif
+
+  for(; i < count; ++i)
+  {
+    if (t[i] > life_time)
+    {
+      respawn_queue.push_back(i);
     }
     else
     {
-      i->t += delta;
-          
-      i->x += i->v_x * delta;
-      i->y += i->v_y * delta;
+      t[i] += delta;
+
+      x[i] += vx[i] * delta;
+      y[i] += vy[i] * delta;
+
+      vx[i] += gravity_x;
+      vy[i] += gravity_y;
+    }
+
+    min_x = std::min(min_x, x[i]);
+    min_y = std::min(min_y, y[i]);
+    max_x = std::max(max_x, x[i]);
+    max_y = std::max(max_y, y[i]);
+  }
+
+  for(std::vector<int>::const_iterator j = respawn_queue.begin(); j != respawn_queue.end(); ++j)
+  {
+    spawn(*j);
+
+    min_x = std::min(min_x, x[*j]);
+    min_y = std::min(min_y, y[*j]);
+    max_x = std::max(max_x, x[*j]);
+    max_y = std::max(max_y, y[*j]);
+  }
+
+  bounding_box = Rectf(min_x, min_y, max_x, max_y);
+}
+
+void
+ParticleSystem::fast_forward(float delta, int steps)
+{
+  // update() takes one step to respawn a dead particle, after which
+  // it lives for this many steps
+  const int cycle_steps = static_cast<int>(life_time / delta) + 2;
+
+  for(int i = 0; i < active_count; ++i)
+  {
+    int k = steps;
+    while(k > 0)
+    {
+      // number of steps until the particle dies
+      const int n = (age[i] > life_time) ? 0 : std::min(k, static_cast<int>((life_time - age[i]) / delta) + 1);
+
+      // closed form of n steps of integration, gravity is added to
+      // the velocity once per step
+      const float fn = static_cast<float>(n);
+      const float gravity_steps = fn * (fn - 1.0f) / 2.0f;
+      pos_x[i] += delta * (fn * vel_x[i] + gravity_steps * gravity_x);
+      pos_y[i] += delta * (fn * vel_y[i] + gravity_steps * gravity_y);
+      vel_x[i] += fn * gravity_x;
+      vel_y[i] += fn * gravity_y;
+      age[i]   += fn * delta;
+      k -= n;
+
+      if (k > 0)
+      {
+        spawn(i);
+        k -= 1;
 
-      i->v_x += gravity_x;
-      i->v_y += gravity_y;
+        // whole lifetimes of the respawned particle leave no trace
+        k %= cycle_steps;
+      }
     }
   }
 }
 
+void
+ParticleSystem::set_detail(float factor)
+{
+  detail = math::mid(0.05f, factor, 1.0f);
+
+  const int count = get_count();
+  const int new_active_count = std::min(count, static_cast<int>(ceilf(static_cast<float>(count) * detail)));
+
+  // particles that come back get fresh, staggered ages like in
+  // set_count(), their old state is outdated
+  for(int i = active_count; i < new_active_count; ++i)
+  {
+    spawn(i);
+    age[i] = life_time * bunching * static_cast<float>(i) / static_cast<float>(count);
+  }
+
+  active_count = new_active_count;
+}
+
 int
 ParticleSystem::get_count() const
 {
-  return particles.size();
+  return static_cast<int>(age.size());
+}
+
+Particle
+ParticleSystem::get_particle(int i) const
+{
+  Particle particle;
+  particle.x     = pos_x[i];
+  particle.y     = pos_y[i];
+  particle.v_x   = vel_x[i];
+  particle.v_y   = vel_y[i];
+  particle.angle = angle[i];
+  particle.t     = age[i];
+  return particle;
 }
 
 void
 ParticleSystem::set_count(int num)
 {
-  int old_size = particles.size();
+  const int old_size = get_count();
   if (old_size != num)
   {
-    particles.resize(num);
-
-    for(Particles::size_type i = old_size; i < particles.size(); ++i)
+    const std::vector<float>::size_type size = static_cast<std::vector<float>::size_type>(num);
+    pos_x.resize(size);
+    pos_y.resize(size);
+    vel_x.resize(size);
+    vel_y.resize(size);
+    angle.resize(size);
+    age.resize(size);
+
+    for(int i = old_size; i < num; ++i)
     {
-      spawn(particles[i]);
-      particles[i].t = life_time * bunching * static_cast<float>(i) / static_cast<float>(particles.size());
+      spawn(i);
+      age[i] = life_time * bunching * static_cast<float>(i) / static_cast<float>(num);
     }
+
+    active_count = std::min(num, static_cast<int>(ceilf(static_cast<float>(num) * detail)));
   }
 }
   
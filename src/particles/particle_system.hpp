@@ -24,6 +24,7 @@
 
 #include "math/rect.hpp"
 #include "display/color.hpp"
+#include "math/random.hpp"
 #include "particles/drawer.hpp"
 
 class FileReader;
@@ -53,12 +54,67 @@ struct Particle
 class ParticleSystem
 {
 public:
-  typedef std::vector<Particle> Particles;
-  typedef Particles::iterator iterator;
-  typedef Particles::const_iterator const_iterator;
+  /**
+   * Iterates over the particles as if they were stored as an array of
+   * Particle, dereferencing returns a copy assembled from the
+   * separate arrays.
+   */
+  class const_iterator
+  {
+  public:
+    class arrow_proxy
+    {
+    private:
+      Particle particle;
+
+    public:
+      arrow_proxy(const Particle& particle_) : particle(particle_) {}
+      const Particle* operator->() const { return &particle; }
+    };
+
+  private:
+    const ParticleSystem* system;
+    int index;
+
+  public:
+    const_iterator(const ParticleSystem* system_, int index_) :
+      system(system_), index(index_)
+    {}
+
+    Particle    operator*()  const { return system->get_particle(index); }
+    arrow_proxy operator->() const { return arrow_proxy(system->get_particle(index)); }
+
+    const_iterator& operator++() { ++index; return *this; }
+
+    bool operator==(const const_iterator& rhs) const { return index == rhs.index; }
+    bool operator!=(const const_iterator& rhs) const { return index != rhs.index; }
+  };
+
+  typedef const_iterator iterator;
 
 private:
-  Particles particles;
+  /** Particle state stored as structure of arrays, so that update()
+      can process several particles at once with SIMD instructions */
+  std::vector<float> pos_x;
+  std::vector<float> pos_y;
+  std::vector<float> vel_x;
+  std::vector<float> vel_y;
+  std::vector<float> angle;
+  std::vector<float> age;
+
+  /** indices of the particles to respawn, filled by update() */
+  std::vector<int> respawn_queue;
+
+  /** only the first active_count particles are simulated and drawn,
+      see set_detail() */
+  int   active_count;
+  float detail;
+
+  /** update() steps that were skipped and have to be caught up */
+  int skipped_steps;
+
+  /** bounding box of the particle positions after the last update() */
+  Rectf bounding_box;
 
   float life_time;
 
@@ -93,8 +149,16 @@ private:
   Color color_start;
   Color color_stop;
 
+  /** each system has its own generator, so that systems can be
+      updated in parallel */
+  Random rng;
+
 private:
-  void spawn(Particle& particle);
+  void spawn(int i);
+
+  /** Advances the active particles by \a steps steps of \a delta
+      using the closed form of the integration in update() */
+  void fast_forward(float delta, int steps);
 
 public:
   ParticleSystem();
@@ -102,12 +166,28 @@ public:
   ~ParticleSystem();
 
   void set_drawer(Drawer*);
+  const Drawer* get_drawer() const { return drawer.get(); }
 
   /** Draws the particle system to the screen */
   void draw() const;
 
   /** Update the particle system \a delta seconds */
   void update(float delta);
+
+  /** Skips an update step, e.g. while the system is off-screen. The
+      skipped steps are caught up cheaply at the next update(). */
+  void skip() { skipped_steps += 1; }
+
+  /** Simulate and draw only \a factor of the particles, the factor is
+      clamped to [0.05, 1] */
+  void set_detail(float factor);
+  float get_detail() const { return detail; }
+
+  /** Number of particles simulated and drawn at the current detail */
+  int get_active_count() const { return active_count; }
+
+  /** Bounding box of the active particles as of the last update() */
+  Rectf get_bounding_box() const { return bounding_box; }
   
   /** Set how many particles will be used */
   void set_count(int num);
@@ -173,11 +253,10 @@ public:
       from \a from to \a to, direction will be taken from the cone */
   void set_velocity(float from, float to);
 
-  iterator begin() { return particles.begin(); }
-  iterator end()   { return particles.end(); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end()   const { return const_iterator(this, active_count); }
 
-  const_iterator begin() const { return particles.begin(); }
-  const_iterator end()   const { return particles.end(); }
+  Particle get_particle(int i) const;
 
   float get_size_start() const { return size_start; }
   float get_size_stop()  const { return size_stop; }
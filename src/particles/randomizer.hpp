@@ -25,12 +25,12 @@ class Randomizer
 {
 public:
   virtual ~Randomizer() {}
-  virtual void set_pos(Particle& p) =0;
+  virtual void set_pos(Particle& p, Random& rng) =0;
 };
 
 class PointRandomizer : public Randomizer {
 public:
-  void set_pos(Particle& particle) {
+  void set_pos(Particle& particle, Random& /*rng*/) {
     particle.x = 0;
     particle.y = 0;
   }
@@ -43,9 +43,9 @@ public:
   RectRandomizer(const Rectf& rect_)
     : rect(rect_) {}
  
-  void set_pos(Particle& p) {
-    p.x = rnd.frand(rect.left, rect.right);
-    p.y = rnd.frand(rect.top,  rect.bottom);
+  void set_pos(Particle& p, Random& rng) {
+    p.x = rng.frand(rect.left, rect.right);
+    p.y = rng.frand(rect.top,  rect.bottom);
   }
 };
 
@@ -56,10 +56,10 @@ public:
   CircleRandomizer(float radius_) 
     : radius(radius_) {}
 
-  void set_pos(Particle& p) {
+  void set_pos(Particle& p, Random& rng) {
     // FIXME: BROKEN!!!!!
-    p.x = rnd.frand(-radius, radius);
-    p.y = sqrtf((radius*radius) - (p.x*p.x)) * rnd.frand(-1.0f, 1.0f);
+    p.x = rng.frand(-radius, radius);
+    p.y = sqrtf((radius*radius) - (p.x*p.x)) * rng.frand(-1.0f, 1.0f);
   }
 };
 
@@ -72,8 +72,8 @@ public:
     : x1(x1_), y1(y1_), x2(x2_), y2(y2_)
   {}
 
-  void set_pos(Particle& p) {
-    float l = rnd.frand();
+  void set_pos(Particle& p, Random& rng) {
+    float l = rng.frand();
     p.x = x1 + (x2-x1) * l;
     p.y = y1 + (y2-y1) * l;
   }
@@ -22,11 +22,17 @@
 #include "display/surface_manager.hpp"
 #include "display/drawing_context.hpp"
 #include "particles/surface_drawer.hpp"
+
+#include <string.h>
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
 
 SurfaceDrawer::SurfaceDrawer(SurfacePtr surface_) :
   surface(surface_),
-  blendfunc_src(),
-  blendfunc_dest()
+  blendfunc_src(GL_SRC_ALPHA),
+  blendfunc_dest(GL_ONE_MINUS_SRC_ALPHA),
+  buffer(new VertexArrayDrawable(Vector2f(), 0.0f, Matrix(1.0f)))
 {
 }
 
@@ -108,59 +114,146 @@ SurfaceDrawer::set_blendfuncs(GLenum blendfunc_src_, GLenum blendfunc_dest_)
 void
 SurfaceDrawer::draw(const ParticleSystem& psys) const
 {
-  buffer->clear();
-  buffer->set_pos(Vector2f(psys.get_x_pos(), psys.get_y_pos()));
+  if (psys.get_active_count() == 0)
+  { // the buffer has no vertices to write to
+    buffer->resize(0);
+    return;
+  }
 
   buffer->set_mode(GL_QUADS);
   buffer->set_texture(surface->get_texture());
   buffer->set_blend_func(blendfunc_src, blendfunc_dest);
 
+  buffer->resize(psys.get_active_count() * 4);
+  const int num_vertices = generate_quads(psys, buffer->get_vertices(), buffer->get_texcoords(), buffer->get_colors());
+  buffer->resize(num_vertices);
+
+  if (num_vertices > 0)
+  {
+    buffer->render(~0u);
+  }
+}
+
+int
+SurfaceDrawer::generate_quads(const ParticleSystem& psys,
+                              float* vertices, float* texcoords, unsigned char* colors) const
+{
+  const Rectf uv = surface->get_uv();
+  const float half_width  = surface->get_width()  / 2.0f;
+  const float half_height = surface->get_height() / 2.0f;
+
+  const float size_start = psys.get_size_start();
+  const float size_delta = psys.get_size_stop() - size_start;
+
+  // the particles are offset by the system position once more, as
+  // VertexArrayDrawable::vertex() used to do with the buffer position
+  const float x_pos = psys.get_x_pos();
+  const float y_pos = psys.get_y_pos();
+
+#ifdef __SSE2__
+  const Color& start = psys.get_color_start();
+  const Color& stop  = psys.get_color_stop();
+  const __m128 color_start = _mm_setr_ps(start.r, start.g, start.b, start.a);
+  const __m128 color_delta = _mm_sub_ps(_mm_setr_ps(stop.r, stop.g, stop.b, stop.a), color_start);
+  const __m128 v_255 = _mm_set1_ps(255.0f);
+
+  // signs of the corner offsets, the corners are at (-x, -y), (+y, -x),
+  // (+x, +y), (-y, +x) of the rotated half extent (x, y)
+  const __m128 sign_a = _mm_setr_ps(-1.0f, 0.0f, 1.0f,  0.0f);
+  const __m128 sign_b = _mm_setr_ps( 0.0f, 1.0f, 0.0f, -1.0f);
+#endif
+
+  int n = 0;
   for(ParticleSystem::const_iterator i = psys.begin(); i != psys.end(); ++i)
   {
-    if (i->t != -1.0f)
+    const Particle particle = *i;
+    if (particle.t != -1.0f)
     {
-      float p = 1.0f - psys.get_progress(i->t);
-      Color color(psys.get_color_start().r * p + psys.get_color_stop().r * (1.0f - p),
-                  psys.get_color_start().g * p + psys.get_color_stop().g * (1.0f - p),
-                  psys.get_color_start().b * p + psys.get_color_stop().b * (1.0f - p),
-                  psys.get_color_start().a * p + psys.get_color_stop().a * (1.0f - p));
-
-      // scale
-      float scale  = psys.get_size_start() + 
-        psys.get_progress(i->t) * (psys.get_size_stop() - psys.get_size_start());
-          
-      float width  = surface->get_width()  * scale;
-      float height = surface->get_height() * scale;
-              
+      const float progress = psys.get_progress(particle.t);
+      const float scale = size_start + progress * size_delta;
+
       // rotate
-      float x_rot = width/2;
-      float y_rot = height/2; 
+      float x_rot = half_width  * scale;
+      float y_rot = half_height * scale;
 
-      if (i->angle != 0)
+      if (particle.angle != 0)
       {
-        float s = sinf(math::pi * i->angle/180.0f);
-        float c = cosf(math::pi * i->angle/180.0f);
-        x_rot = (width/2) * c - (height/2) * s;
-        y_rot = (width/2) * s + (height/2) * c;
+        const float s = sinf(math::pi * particle.angle/180.0f);
+        const float c = cosf(math::pi * particle.angle/180.0f);
+        const float w = x_rot;
+        const float h = y_rot;
+        x_rot = w * c - h * s;
+        y_rot = w * s + h * c;
       }
 
-      buffer->add_texcoords(surface->get_uv());
+      const float px = particle.x + x_pos;
+      const float py = particle.y + y_pos;
+
+      float* v = vertices + 3 * n;
+#ifdef __SSE2__
+      { // corners
+        const __m128 v_x_rot = _mm_set1_ps(x_rot);
+        const __m128 v_y_rot = _mm_set1_ps(y_rot);
+        const __m128 xs = _mm_add_ps(_mm_set1_ps(px), _mm_add_ps(_mm_mul_ps(sign_a, v_x_rot),
+                                                                 _mm_mul_ps(sign_b, v_y_rot)));
+        const __m128 ys = _mm_add_ps(_mm_set1_ps(py), _mm_sub_ps(_mm_mul_ps(sign_a, v_y_rot),
+                                                                 _mm_mul_ps(sign_b, v_x_rot)));
+        float x[4];
+        float y[4];
+        _mm_storeu_ps(x, xs);
+        _mm_storeu_ps(y, ys);
+        for(int k = 0; k < 4; ++k)
+        {
+          v[3*k + 0] = x[k];
+          v[3*k + 1] = y[k];
+          v[3*k + 2] = 0.0f;
+        }
+      }
 
-      buffer->color(color);
-      buffer->vertex(i->x - x_rot, i->y - y_rot);
+      { // color, truncated to bytes like VertexArrayDrawable::color()
+        const __m128 rgba = _mm_mul_ps(_mm_add_ps(color_start, _mm_mul_ps(color_delta, _mm_set1_ps(progress))), v_255);
+        const __m128i ints = _mm_cvttps_epi32(rgba);
+        const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(ints, ints), _mm_setzero_si128());
+        const int packed = _mm_cvtsi128_si32(bytes);
+        for(int k = 0; k < 4; ++k)
+        {
+          memcpy(colors + 4 * (n + k), &packed, 4);
+        }
+      }
+#else
+      v[0]  = px - x_rot; v[1]  = py - y_rot; v[2]  = 0.0f;
+      v[3]  = px + y_rot; v[4]  = py - x_rot; v[5]  = 0.0f;
+      v[6]  = px + x_rot; v[7]  = py + y_rot; v[8]  = 0.0f;
+      v[9]  = px - y_rot; v[10] = py + x_rot; v[11] = 0.0f;
 
-      buffer->color(color);
-      buffer->vertex(i->x + y_rot, i->y - x_rot);
+      {
+        const float p = 1.0f - progress;
+        const Color color(psys.get_color_start().r * p + psys.get_color_stop().r * (1.0f - p),
+                          psys.get_color_start().g * p + psys.get_color_stop().g * (1.0f - p),
+                          psys.get_color_start().b * p + psys.get_color_stop().b * (1.0f - p),
+                          psys.get_color_start().a * p + psys.get_color_stop().a * (1.0f - p));
+        for(int k = 0; k < 4; ++k)
+        {
+          unsigned char* c = colors + 4 * (n + k);
+          c[0] = static_cast<unsigned char>(color.r * 255);
+          c[1] = static_cast<unsigned char>(color.g * 255);
+          c[2] = static_cast<unsigned char>(color.b * 255);
+          c[3] = static_cast<unsigned char>(color.a * 255);
+        }
+      }
+#endif
 
-      buffer->color(color);
-      buffer->vertex(i->x + x_rot, i->y + y_rot);
+      float* tc = texcoords + 2 * n;
+      tc[0] = uv.left;  tc[1] = uv.top;
+      tc[2] = uv.right; tc[3] = uv.top;
+      tc[4] = uv.right; tc[5] = uv.bottom;
+      tc[6] = uv.left;  tc[7] = uv.bottom;
 
-      buffer->color(color);
-      buffer->vertex(i->x - y_rot, i->y + x_rot);
+      n += 4;
     }
   }
 
-  buffer->render(~0u);
+  return n;
 }
-
+
 /* EOF */
@@ -40,7 +40,18 @@ public:
   void set_texture(SurfacePtr surface);
   void set_blendfuncs(GLenum blendfunc_src, GLenum blendfunc_dst);
 
+  SurfacePtr get_surface() const { return surface; }
+  GLenum get_blendfunc_src() const { return blendfunc_src; }
+  GLenum get_blendfunc_dest() const { return blendfunc_dest; }
+
   void draw(const ParticleSystem& psys) const;
+
+  /** Writes a quad for each particle of \a psys into the given
+      arrays, which must have room for psys.get_active_count() * 4 vertices
+      (three floats, two texcoords and four color bytes each).
+      Returns the number of vertices written. */
+  int generate_quads(const ParticleSystem& psys,
+                     float* vertices, float* texcoords, unsigned char* colors) const;
 };
 
 #endif
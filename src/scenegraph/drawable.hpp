@@ -24,6 +24,8 @@
 #include "math/matrix.hpp"
 #include "display/texture.hpp"
 
+class SoftwareRasterizer;
+
 class Drawable
 {
 protected:
@@ -54,6 +56,13 @@ public:
    * OpenGL methods. 
    */
   virtual void render(unsigned int mask) = 0;
+
+  /**
+   * Software counterpart to render(), used by the
+   * SoftwareCompositorImpl, Drawables without a software
+   * implementation are skipped.
+   */
+  virtual void rasterize(SoftwareRasterizer& /*rasterizer*/, unsigned int /*mask*/) {}
   
   /** Returns the position at which the request should be drawn */
   float get_z_pos() const { return z_pos; }
@@ -54,4 +54,14 @@ DrawableGroup::render(unsigned int mask)
   }
 }
 
+void
+DrawableGroup::rasterize(SoftwareRasterizer& rasterizer, unsigned int mask)
+{
+  for(Drawables::iterator i = m_drawables.begin(); i != m_drawables.end(); ++i)
+  {
+    if ((*i)->get_render_mask() & mask)
+      (*i)->rasterize(rasterizer, mask);
+  }
+}
+
 /* EOF */
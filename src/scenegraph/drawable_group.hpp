@@ -42,6 +42,7 @@ public:
   void clear();
 
   void render(unsigned int mask);
+  void rasterize(SoftwareRasterizer& rasterizer, unsigned int mask);
 
 private:
   DrawableGroup(const DrawableGroup&);
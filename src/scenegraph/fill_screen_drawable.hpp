@@ -19,6 +19,8 @@
 #ifndef HEADER_WINDSTILLE_SCENEGRAPH_FILL_SCREEN_DRAWABLE_HPP
 #define HEADER_WINDSTILLE_SCENEGRAPH_FILL_SCREEN_DRAWABLE_HPP
 
+#include "display/software_rasterizer.hpp"
+
 class FillScreenDrawable : public Drawable
 {
 private:
@@ -36,6 +38,11 @@ public:
     glClearColor(color.r, color.g, color.b, color.a);
     glClear(GL_COLOR_BUFFER_BIT);
   }
+
+  void rasterize(SoftwareRasterizer& rasterizer, unsigned int /*mask*/)
+  {
+    rasterizer.clear(color);
+  }
 };
 
 #endif
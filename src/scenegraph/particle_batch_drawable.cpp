@@ -0,0 +1,129 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**  
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**  
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scenegraph/particle_batch_drawable.hpp"
+
+#include <algorithm>
+
+#include "particles/particle_system.hpp"
+#include "particles/surface_drawer.hpp"
+#include "scenegraph/vertex_array_drawable.hpp"
+
+ParticleBatchDrawable::ParticleBatchDrawable(SurfacePtr surface, GLenum sfactor, GLenum dfactor,
+                                             unsigned int layer, float z_pos_) :
+  Drawable(Vector2f(), z_pos_),
+  m_surface(surface),
+  m_sfactor(sfactor),
+  m_dfactor(dfactor),
+  m_systems(),
+  m_buffer(new VertexArrayDrawable(Vector2f(), 0.0f, Matrix(1.0f)))
+{
+  set_render_mask(layer);
+
+  m_buffer->set_mode(GL_QUADS);
+  m_buffer->set_texture(m_surface->get_texture());
+  m_buffer->set_blend_func(m_sfactor, m_dfactor);
+}
+
+ParticleBatchDrawable::~ParticleBatchDrawable()
+{
+}
+
+bool
+ParticleBatchDrawable::accepts(const ParticleSystem& psys) const
+{
+  const SurfaceDrawer* drawer = dynamic_cast<const SurfaceDrawer*>(psys.get_drawer());
+  return
+    drawer &&
+    psys.get_layer() == get_render_mask() &&
+    psys.get_z_pos() == get_z_pos() &&
+    drawer->get_surface()->get_texture() == m_surface->get_texture() &&
+    drawer->get_blendfunc_src()  == m_sfactor &&
+    drawer->get_blendfunc_dest() == m_dfactor;
+}
+
+void
+ParticleBatchDrawable::add(boost::shared_ptr<ParticleSystem> psys)
+{
+  assert(accepts(*psys));
+  m_systems.push_back(psys);
+}
+
+void
+ParticleBatchDrawable::remove(boost::shared_ptr<ParticleSystem> psys)
+{
+  m_systems.erase(std::remove(m_systems.begin(), m_systems.end(), psys), m_systems.end());
+}
+
+bool
+ParticleBatchDrawable::fill()
+{
+  int capacity = 0;
+  for(Systems::iterator i = m_systems.begin(); i != m_systems.end(); ++i)
+  {
+    capacity += (*i)->get_active_count() * 4;
+  }
+
+  if (capacity == 0)
+  {
+    return false;
+  }
+  else
+  {
+    m_buffer->resize(capacity);
+
+    float* vertices = m_buffer->get_vertices();
+    float* texcoords = m_buffer->get_texcoords();
+    unsigned char* colors = m_buffer->get_colors();
+
+    int num_vertices = 0;
+    for(Systems::iterator i = m_systems.begin(); i != m_systems.end(); ++i)
+    {
+      // the surfaces of the drawers only share the texture, so each
+      // system is generated with its own drawer to get its uv and size
+      const SurfaceDrawer& drawer = static_cast<const SurfaceDrawer&>(*(*i)->get_drawer());
+      num_vertices += drawer.generate_quads(**i,
+                                            vertices  + 3 * num_vertices,
+                                            texcoords + 2 * num_vertices,
+                                            colors    + 4 * num_vertices);
+    }
+
+    m_buffer->resize(num_vertices);
+    return num_vertices > 0;
+  }
+}
+
+void
+ParticleBatchDrawable::render(unsigned int mask)
+{
+  if (fill())
+  {
+    m_buffer->render(mask);
+  }
+}
+
+void
+ParticleBatchDrawable::rasterize(SoftwareRasterizer& rasterizer, unsigned int mask)
+{
+  if (fill())
+  {
+    m_buffer->rasterize(rasterizer, mask);
+  }
+}
+
+/* EOF */
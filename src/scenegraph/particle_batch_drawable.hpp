@@ -0,0 +1,80 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**  
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**  
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_SCENEGRAPH_PARTICLE_BATCH_DRAWABLE_HPP
+#define HEADER_WINDSTILLE_SCENEGRAPH_PARTICLE_BATCH_DRAWABLE_HPP
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+#include "display/surface.hpp"
+#include "scenegraph/drawable.hpp"
+
+class ParticleSystem;
+class VertexArrayDrawable;
+
+/**
+ * Draws all particle systems that use a SurfaceDrawer with the same
+ * surface, blend func, layer and z-pos with a single vertex array,
+ * which is sized once per frame and filled by
+ * SurfaceDrawer::generate_quads(). The systems are drawn in the order
+ * they were added, all at the place in the SceneGraph where the batch
+ * was added, which is where the first of them would have been drawn.
+ */
+class ParticleBatchDrawable : public Drawable
+{
+private:
+  SurfacePtr m_surface;
+  GLenum m_sfactor;
+  GLenum m_dfactor;
+
+  typedef std::vector<boost::shared_ptr<ParticleSystem> > Systems;
+  Systems m_systems;
+
+  boost::scoped_ptr<VertexArrayDrawable> m_buffer;
+
+public:
+  ParticleBatchDrawable(SurfacePtr surface, GLenum sfactor, GLenum dfactor,
+                        unsigned int layer, float z_pos);
+  ~ParticleBatchDrawable();
+
+  /** Returns true if \a psys can be drawn as part of this batch */
+  bool accepts(const ParticleSystem& psys) const;
+
+  void add(boost::shared_ptr<ParticleSystem> psys);
+  void remove(boost::shared_ptr<ParticleSystem> psys);
+
+  bool empty() const { return m_systems.empty(); }
+
+  void render(unsigned int mask);
+  void rasterize(SoftwareRasterizer& rasterizer, unsigned int mask);
+
+private:
+  /** Fills m_buffer with the particles of all systems, returns false
+      if there is nothing to draw */
+  bool fill();
+
+private:
+  ParticleBatchDrawable(const ParticleBatchDrawable&);
+  ParticleBatchDrawable& operator=(const ParticleBatchDrawable&);
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,91 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scenegraph/particle_batcher.hpp"
+
+#include <algorithm>
+
+#include "particles/particle_system.hpp"
+#include "particles/surface_drawer.hpp"
+#include "scenegraph/particle_batch_drawable.hpp"
+#include "scenegraph/particle_system_drawable.hpp"
+#include "scenegraph/scene_graph.hpp"
+
+ParticleBatcher::ParticleBatcher(SceneGraph& scene_graph) :
+  m_scene_graph(scene_graph),
+  m_batches()
+{
+}
+
+ParticleBatcher::~ParticleBatcher()
+{
+}
+
+boost::shared_ptr<Drawable>
+ParticleBatcher::add(boost::shared_ptr<ParticleSystem> psys)
+{
+  const SurfaceDrawer* drawer = dynamic_cast<const SurfaceDrawer*>(psys->get_drawer());
+  if (!drawer)
+  {
+    boost::shared_ptr<Drawable> drawable(new ParticleSystemDrawable(*psys));
+    m_scene_graph.add_drawable(drawable);
+    return drawable;
+  }
+  else
+  {
+    for(Batches::iterator i = m_batches.begin(); i != m_batches.end(); ++i)
+    {
+      if ((*i)->accepts(*psys))
+      {
+        (*i)->add(psys);
+        return *i;
+      }
+    }
+
+    boost::shared_ptr<ParticleBatchDrawable> batch(new ParticleBatchDrawable(drawer->get_surface(),
+                                                                             drawer->get_blendfunc_src(),
+                                                                             drawer->get_blendfunc_dest(),
+                                                                             psys->get_layer(),
+                                                                             psys->get_z_pos()));
+    batch->add(psys);
+    m_batches.push_back(batch);
+    m_scene_graph.add_drawable(batch);
+    return batch;
+  }
+}
+
+void
+ParticleBatcher::remove(boost::shared_ptr<ParticleSystem> psys, boost::shared_ptr<Drawable> drawable)
+{
+  Batches::iterator it = std::find(m_batches.begin(), m_batches.end(), drawable);
+  if (it == m_batches.end())
+  {
+    m_scene_graph.remove_drawable(drawable);
+  }
+  else
+  {
+    (*it)->remove(psys);
+    if ((*it)->empty())
+    {
+      m_scene_graph.remove_drawable(drawable);
+      m_batches.erase(it);
+    }
+  }
+}
+
+/* EOF */
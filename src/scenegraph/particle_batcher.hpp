@@ -0,0 +1,65 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_SCENEGRAPH_PARTICLE_BATCHER_HPP
+#define HEADER_WINDSTILLE_SCENEGRAPH_PARTICLE_BATCHER_HPP
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+class Drawable;
+class ParticleBatchDrawable;
+class ParticleSystem;
+class SceneGraph;
+
+/**
+ * Adds particle systems to a SceneGraph, systems drawn with a
+ * SurfaceDrawer are merged into a ParticleBatchDrawable shared with
+ * all other systems using the same texture, blend func, layer and
+ * z-pos, the others get a ParticleSystemDrawable of their own.
+ */
+class ParticleBatcher
+{
+private:
+  SceneGraph& m_scene_graph;
+
+  typedef std::vector<boost::shared_ptr<ParticleBatchDrawable> > Batches;
+  Batches m_batches;
+
+public:
+  ParticleBatcher(SceneGraph& scene_graph);
+  ~ParticleBatcher();
+
+  /** Adds \a psys to the scene graph, returns the drawable it ended
+      up in */
+  boost::shared_ptr<Drawable> add(boost::shared_ptr<ParticleSystem> psys);
+
+  /** Takes \a psys out of \a drawable, as returned by add(), the
+      drawable leaves the scene graph once it has nothing left to draw */
+  void remove(boost::shared_ptr<ParticleSystem> psys, boost::shared_ptr<Drawable> drawable);
+
+  int get_num_batches() const { return static_cast<int>(m_batches.size()); }
+
+private:
+  ParticleBatcher(const ParticleBatcher&);
+  ParticleBatcher& operator=(const ParticleBatcher&);
+};
+
+#endif
+
+/* EOF */
@@ -44,6 +44,12 @@ SceneGraph::render(unsigned int mask)
   m_drawables->render(mask); 
 }
 
+void
+SceneGraph::rasterize(SoftwareRasterizer& rasterizer, unsigned int mask)
+{
+  m_drawables->rasterize(rasterizer, mask);
+}
+
 void
 SceneGraph::clear()
 {
@@ -24,6 +24,7 @@
 
 class Drawable;
 class DrawableGroup;
+class SoftwareRasterizer;
 class Texture;
 
 class SceneGraph
@@ -40,6 +41,7 @@ public:
   void remove_drawable(boost::shared_ptr<Drawable> drawable);
 
   void render(unsigned int mask);
+  void rasterize(SoftwareRasterizer& rasterizer, unsigned int mask);
 
   void clear();
 
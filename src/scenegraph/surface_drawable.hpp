@@ -23,6 +23,7 @@
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include "display/software_rasterizer.hpp"
 #include "display/surface_drawing_parameters.hpp"
 
 class SurfaceDrawable : public Drawable
@@ -55,6 +56,11 @@ public:
 
     glPopMatrix();
   }
+
+  void rasterize(SoftwareRasterizer& rasterizer, unsigned int /*mask*/)
+  {
+    surface->rasterize(rasterizer, params, modelview);
+  }
 };
 
 #endif
@@ -24,6 +24,7 @@
 #include "math/vector2f.hpp"
 #include "math/quad.hpp"
 #include "display/opengl_state.hpp"
+#include "display/software_rasterizer.hpp"
 #include "scenegraph/drawable.hpp"
 
 class SurfaceQuadDrawable : public Drawable
@@ -76,6 +77,15 @@ public:
     glPopMatrix();    
   }
 
+  void rasterize(SoftwareRasterizer& rasterizer, unsigned int /*mask*/)
+  {
+    rasterizer.draw_quad(Quad(pos + m_quad.p1, pos + m_quad.p2, pos + m_quad.p3, pos + m_quad.p4),
+                         m_surface->get_uv(), Color(1.0f, 1.0f, 1.0f),
+                         m_surface->get_texture(),
+                         m_params.blendfunc_src, m_params.blendfunc_dst,
+                         modelview);
+  }
+
   void set_quad(const Quad& quad) { m_quad = quad; }
 };
 
@@ -21,6 +21,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "display/opengl_state.hpp"
+#include "display/software_rasterizer.hpp"
 
 
 VertexArrayDrawable::VertexArrayDrawable(const Vector2f& pos_, float z_pos_, 
@@ -50,6 +51,15 @@ VertexArrayDrawable::clear()
   vertices.clear();
 }
 
+void
+VertexArrayDrawable::resize(int num_vertices_)
+{
+  const std::vector<float>::size_type n = static_cast<std::vector<float>::size_type>(num_vertices_);
+  colors.resize(4 * n);
+  texcoords.resize(2 * n);
+  vertices.resize(3 * n);
+}
+
 void
 VertexArrayDrawable::render(unsigned int mask)
 {
@@ -123,6 +133,85 @@ VertexArrayDrawable::render(int start, int end)
   glPopMatrix();
 }
 
+void
+VertexArrayDrawable::rasterize(SoftwareRasterizer& rasterizer, unsigned int /*mask*/)
+{
+  std::vector<SoftwareVertex> in(num_vertices());
+  for(int i = 0; i < num_vertices(); ++i)
+  {
+    in[i].x = vertices[3*i + 0];
+    in[i].y = vertices[3*i + 1];
+
+    if (!texcoords.empty())
+    {
+      in[i].u = texcoords[2*i + 0];
+      in[i].v = texcoords[2*i + 1];
+    }
+
+    if (!colors.empty())
+    {
+      in[i].color = Color(colors[4*i + 0] / 255.0f,
+                          colors[4*i + 1] / 255.0f,
+                          colors[4*i + 2] / 255.0f,
+                          colors[4*i + 3] / 255.0f);
+    }
+    else
+    {
+      in[i].color = Color(1.0f, 1.0f, 1.0f);
+    }
+  }
+
+  std::vector<SoftwareVertex> out;
+  switch(mode)
+  {
+    case GL_TRIANGLES:
+      out = in;
+      break;
+
+    case GL_QUADS:
+      for(size_t i = 0; i + 3 < in.size(); i += 4)
+      {
+        out.push_back(in[i+0]);
+        out.push_back(in[i+1]);
+        out.push_back(in[i+2]);
+
+        out.push_back(in[i+0]);
+        out.push_back(in[i+2]);
+        out.push_back(in[i+3]);
+      }
+      break;
+
+    case GL_TRIANGLE_FAN:
+    case GL_POLYGON:
+      for(size_t i = 1; i + 1 < in.size(); ++i)
+      {
+        out.push_back(in[0]);
+        out.push_back(in[i]);
+        out.push_back(in[i+1]);
+      }
+      break;
+
+    case GL_TRIANGLE_STRIP:
+      for(size_t i = 0; i + 2 < in.size(); ++i)
+      {
+        out.push_back(in[i]);
+        out.push_back(in[i+1]);
+        out.push_back(in[i+2]);
+      }
+      break;
+
+    default:
+      // lines and points have no software implementation
+      break;
+  }
+
+  if (!out.empty())
+  {
+    rasterizer.draw_triangles(&*out.begin(), static_cast<int>(out.size()),
+                              texture, blend_sfactor, blend_dfactor, modelview);
+  }
+}
+
 void
 VertexArrayDrawable::vertex(const Vector2f& vec, float z)
 {
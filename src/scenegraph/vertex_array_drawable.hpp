@@ -43,6 +43,10 @@ public:
   void render(unsigned int mask);
   void render(int start, int end);
 
+  /** Rasterizes the triangle based modes, lines and points are
+      skipped */
+  void rasterize(SoftwareRasterizer& rasterizer, unsigned int mask);
+
   void vertex(float x, float y, float z = 0.0f);
   void vertex(const Vector2f& vec, float z = 0.0f);
 
@@ -60,6 +64,16 @@ public:
 
   void clear();
 
+  /** Resizes the buffer to \a num_vertices vertices with color and
+      texcoords, so that it can be filled directly through the
+      pointers below instead of vertex() and friends. The pointers are
+      only valid until the next resize. The position of the drawable
+      is not applied to vertices written this way. */
+  void resize(int num_vertices);
+  float* get_vertices() { return &vertices[0]; }
+  float* get_texcoords() { return &texcoords[0]; }
+  unsigned char* get_colors() { return &colors[0]; }
+
   void set_mode(GLenum mode_);
   void set_texture(TexturePtr texture);
   void set_blend_func(GLenum sfactor, GLenum dfactor);
@@ -0,0 +1,137 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "screen/frame_pacer.hpp"
+
+#include <algorithm>
+
+#include "math/math.hpp"
+
+namespace {
+
+/** number of frames kept for the statistics */
+const int kFrameHistory = 1024;
+
+/** the last part of the wait in microseconds, polled instead of slept
+    as SDL_Delay() only has millisecond granularity */
+const Uint64 kSpinUsec = 1000;
+
+} // namespace
+
+FramePacer::FramePacer() :
+  m_frequency(SDL_GetPerformanceFrequency()),
+  m_frame_start(SDL_GetPerformanceCounter()),
+  m_last_frame(m_frame_start),
+  m_frame_ticks(0),
+  m_frame_times(kFrameHistory),
+  m_next_frame_time(0),
+  m_num_frame_times(0)
+{
+}
+
+Uint64
+FramePacer::get_ticks() const
+{
+  return SDL_GetPerformanceCounter();
+}
+
+void
+FramePacer::set_max_fps(int fps)
+{
+  if (fps > 0)
+  {
+    m_frame_ticks = m_frequency / static_cast<Uint64>(fps);
+  }
+  else
+  {
+    m_frame_ticks = 0;
+  }
+}
+
+void
+FramePacer::wait()
+{
+  if (m_frame_ticks)
+  {
+    const Uint64 deadline = m_frame_start + m_frame_ticks;
+    Uint64 now = get_ticks();
+
+    if (now < deadline)
+    {
+      // sleep in steps, as SDL_Delay() may wake up early, until only
+      // the last millisecond is left
+      for(;;)
+      {
+        const Uint64 remaining_usec = (deadline - now) * 1000000 / m_frequency;
+        if (remaining_usec < kSpinUsec + 1000)
+          break;
+
+        SDL_Delay(static_cast<Uint32>((remaining_usec - kSpinUsec) / 1000));
+        now = get_ticks();
+        if (now >= deadline)
+          break;
+      }
+
+      while(get_ticks() < deadline)
+      {
+        // spin for the last bit, SDL_Delay() isn't precise enough
+      }
+
+      m_frame_start = deadline;
+    }
+    else
+    {
+      // the frame took longer than its budget, start over from now
+      // instead of rushing the following frames to catch up
+      m_frame_start = now;
+    }
+  }
+
+  const Uint64 now = get_ticks();
+  m_frame_times[m_next_frame_time] = static_cast<float>(static_cast<double>(now - m_last_frame) * 1000.0 /
+                                                        static_cast<double>(m_frequency));
+  m_next_frame_time = (m_next_frame_time + 1) % kFrameHistory;
+  m_num_frame_times = std::min(m_num_frame_times + 1, kFrameHistory);
+  m_last_frame = now;
+
+  if (!m_frame_ticks)
+  {
+    m_frame_start = now;
+  }
+}
+
+float
+FramePacer::get_percentile(float percent) const
+{
+  if (m_num_frame_times == 0)
+  {
+    return 0.0f;
+  }
+  else
+  {
+    std::vector<float> times(m_frame_times.begin(), m_frame_times.begin() + m_num_frame_times);
+
+    const int n = math::mid(0,
+                            static_cast<int>(percent / 100.0f * static_cast<float>(m_num_frame_times)),
+                            m_num_frame_times - 1);
+    std::nth_element(times.begin(), times.begin() + n, times.end());
+    return times[n];
+  }
+}
+
+/* EOF */
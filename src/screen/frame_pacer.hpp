@@ -0,0 +1,74 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_SCREEN_FRAME_PACER_HPP
+#define HEADER_WINDSTILLE_SCREEN_FRAME_PACER_HPP
+
+#include <SDL.h>
+#include <vector>
+
+/**
+ * Limits the frame rate by sleeping for whatever is left of the
+ * frame budget after the frame is done, instead of sleeping for a
+ * fixed time. Frames are scheduled on a fixed cadence, so a frame
+ * that took a bit longer is followed by a shorter wait. The duration
+ * of the last frames is kept for statistics.
+ */
+class FramePacer
+{
+private:
+  Uint64 m_frequency;
+
+  /** time at which the current frame is supposed to have started */
+  Uint64 m_frame_start;
+
+  /** last time wait() returned, for measuring the real frame time */
+  Uint64 m_last_frame;
+
+  /** frame budget in performance counter ticks, 0 for no limit */
+  Uint64 m_frame_ticks;
+
+  /** ring buffer of frame times in milliseconds */
+  std::vector<float> m_frame_times;
+  int m_next_frame_time;
+  int m_num_frame_times;
+
+public:
+  FramePacer();
+
+  /** Set the frame rate to limit to, 0 disables the limit, i.e. when
+      vsync already limits the frame rate */
+  void set_max_fps(int fps);
+
+  /** Sleeps until the frame budget is used up, call once at the end
+      of each frame */
+  void wait();
+
+  /** Returns the frame time in milliseconds below which \a percent
+      of the recorded frames lie */
+  float get_percentile(float percent) const;
+
+  int get_num_frames() const { return m_num_frame_times; }
+
+private:
+  Uint64 get_ticks() const;
+};
+
+#endif
+
+/* EOF */
@@ -18,6 +18,8 @@
 
 #include "screen/game_session.hpp"
 
+#include <boost/bind.hpp>
+
 #include "app/menu_manager.hpp"
 #include "display/display.hpp"
 #include "display/compositor.hpp"
@@ -76,6 +78,9 @@ public:
       dialog_manager. Receives input and gets drawn to the screen */
   Screen* current_gui;
 
+  /** SDL_GetTicks() of the last loading screen update */
+  Uint32 last_progress_draw;
+
   GameSessionImpl() 
     : compositor(OpenGLWindow::current()->get_size(), Display::get_size()),
       sc(),
@@ -95,7 +100,8 @@ public:
       conversation(),
       inventory(),
       pda(),
-      current_gui()
+      current_gui(),
+      last_progress_draw()
   {
     current_gui    = 0;
     cutscene_mode  = false;
@@ -111,6 +117,7 @@ public:
   }
 
   void draw();
+  void draw_loading_progress(float progress);
 
   void update_cutscene(float delta);
   void update_input(float delta);
@@ -142,6 +149,7 @@ GameSession::~GameSession()
 void
 GameSessionImpl::draw()
 {
+  sc.set_interpolation(ScreenManager::current()->get_interpolation());
   view.draw(sc, *sector);
   
   // Render the scene to the screen
@@ -312,6 +320,12 @@ GameSessionImpl::update_controller(float delta, const Controller& controller)
 void
 GameSessionImpl::update(float delta, const Controller& controller)
 {  
+  // draw() interpolates from the state before this step, which must
+  // also be remembered when the step leaves things where they are
+  view.get_camera().begin_step();
+  if (Player::current())
+    Player::current()->begin_step();
+
   update_cutscene(delta);
 
   delta *= game_speed;
@@ -344,10 +358,34 @@ GameSession::change_sector(const Pathname& arg_filename)
   }
 }
 
+void
+GameSessionImpl::draw_loading_progress(float progress)
+{
+  // swap_buffers() might wait for the retrace, so the screen only
+  // gets updated every now and then
+  const Uint32 ticks = SDL_GetTicks();
+  if (progress < 1.0f && ticks - last_progress_draw < 100)
+    return;
+
+  last_progress_draw = ticks;
+
+  const float width  = static_cast<float>(Display::get_width());
+  const float height = static_cast<float>(Display::get_height());
+  const Rectf bar(width * 0.25f, height * 0.75f, width * 0.75f, height * 0.75f + 8.0f);
+
+  Display::fill_rect(Rectf(0.0f, 0.0f, width, height), Color(0.0f, 0.0f, 0.0f, 1.0f));
+  Display::fill_rect(bar, Color(0.25f, 0.25f, 0.25f, 1.0f));
+  Display::fill_rect(Rectf(bar.left, bar.top, bar.left + bar.get_width() * progress, bar.bottom),
+                     Color(1.0f, 1.0f, 1.0f, 1.0f));
+
+  OpenGLWindow::current()->swap_buffers();
+}
+
 void
 GameSession::set_sector(const Pathname& /* FIXME: huh? */)
 {
-  impl->sector.reset(new Sector(impl->filename));
+  impl->sector.reset(new Sector(impl->filename,
+                                boost::bind(&GameSessionImpl::draw_loading_progress, impl.get(), _1)));
   
   impl->sector->activate();
 }
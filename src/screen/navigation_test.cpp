@@ -28,6 +28,18 @@
 #include "navigation/node.hpp"
 #include "util/sexpr_file_reader.hpp"
 
+namespace {
+
+PathCost get_path_cost()
+{
+  PathCost cost;
+  cost.snap_radius      = 128.0f;
+  cost.smooth_tolerance = 2.0f;
+  return cost;
+}
+
+} // namespace
+
 NavigationTest::NavigationTest()
   : cursor(400, 300),
     stick(),
@@ -37,7 +49,12 @@ NavigationTest::NavigationTest()
     connection(),
     selected_edge(),
     selected_node(),
-    node_to_connect()
+    node_to_connect(),
+    path(),
+    path_queries(new PathQueryQueue(*graph)),
+    path_query(),
+    region_path(),
+    region_path_finder(new HierarchicalPathFinder(*graph, get_path_cost(), 256.0f))
 {
   try 
   {
@@ -88,6 +105,16 @@ NavigationTest::draw()
   if (selected_edge)
     Display::draw_line(selected_edge->get_line(), Color(1.0f, 1.0f, 1.0f, 1.0f));
 
+  for(size_t i = 1; i < region_path.points.size(); ++i)
+  {
+    Display::draw_line(region_path.points[i-1], region_path.points[i], Color(1.0f, 1.0f, 0.0f, 0.5f));
+  }
+
+  for(size_t i = 1; i < path.points.size(); ++i)
+  {
+    Display::draw_line(path.points[i-1], path.points[i], Color(0.0f, 1.0f, 0.0f, 1.0f));
+  }
+
   Display::fill_circle(player, 12.0f, Color(0.0f, 0.0f, 1.0f, 1.0f));
 
   if (connection.get())
@@ -122,7 +149,7 @@ NavigationTest::update(float delta, const Controller& controller)
       if (selected_node)
         graph->add_edge(node_to_connect, selected_node);
           
-      node_to_connect = 0;
+      node_to_connect = NodeHandle();
     }
     else if (selected_node)
     {
@@ -131,7 +158,7 @@ NavigationTest::update(float delta, const Controller& controller)
     else if (selected_edge)
     {
       graph->split_edge(selected_edge);
-      selected_edge = 0;
+      selected_edge = EdgeHandle();
     }
     else
     {
@@ -143,7 +170,7 @@ NavigationTest::update(float delta, const Controller& controller)
   { // Move node
     if (selected_node)
     {
-      selected_node->set_pos(cursor);
+      graph->move_node(selected_node, cursor);
     }
   }
 
@@ -235,16 +262,21 @@ NavigationTest::update(float delta, const Controller& controller)
     graph->save(std::cout);
   }
 
+  // remember the edge as handle, so that we notice when it gets removed
+  EdgeHandle connection_edge;
+  if (connection.get())
+    connection_edge = graph->get_handle(connection->get_edge());
+
   if (controller.button_was_pressed(QUATERNARY_BUTTON))
   {
     if (selected_node) {
       graph->remove_node(selected_node);
-      selected_node = 0;
+      selected_node = NodeHandle();
     } 
       
     if (selected_edge) {
       graph->remove_edge(selected_edge);
-      selected_edge = 0;
+      selected_edge = EdgeHandle();
     }      
   }
 
@@ -252,14 +284,30 @@ NavigationTest::update(float delta, const Controller& controller)
   if (!selected_node)
     selected_edge = graph->find_closest_edge(cursor, 32.0f);
   else
-    selected_edge = 0;
+    selected_edge = EdgeHandle();
 
-  if (connection.get() && !graph->valid(connection->get_edge()))
+  if (connection.get() && !graph->valid(connection_edge))
   {
     connection.reset();
   }
 
   old_player = player;
+
+  path_queries->collect();
+  if (path_queries->is_done(path_query))
+  {
+    if (!path_queries->get_path(path_query, path))
+      path.clear();
+    path_queries->release(path_query);
+  }
+
+  if (!path_query.get())
+  { // one query at a time, the next one starts once this one is done
+    path_query = path_queries->request(player, cursor, get_path_cost());
+  }
+  path_queries->dispatch();
+
+  region_path_finder->find_path(player, cursor, region_path);
 }
 
 /* EOF */
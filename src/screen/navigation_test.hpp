@@ -21,8 +21,11 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "engine/path_query_queue.hpp"
 #include "math/vector2f.hpp"
+#include "navigation/hierarchical_path_finder.hpp"
 #include "navigation/navigation_graph.hpp"
+#include "navigation/path_finder.hpp"
 #include "screen/screen.hpp"
 
 class NavigationGraph;
@@ -47,6 +50,17 @@ private:
 
   NodeHandle node_to_connect;
 
+  /** path from the player to the cursor, searched in the background
+      and picked up one frame later */
+  Path path;
+  boost::scoped_ptr<PathQueryQueue> path_queries;
+  PathQueryHandle path_query;
+
+  /** the same path found by the HierarchicalPathFinder, drawn below
+      the exact one to show where the two differ */
+  Path region_path;
+  boost::scoped_ptr<HierarchicalPathFinder> region_path_finder;
+
 public:
   NavigationTest();
 
@@ -25,7 +25,6 @@
 #include "display/display.hpp"
 #include "display/opengl_window.hpp"
 #include "display/graphic_context_state.hpp"
-#include "scenegraph/particle_system_drawable.hpp"
 #include "scenegraph/fill_screen_pattern_drawable.hpp"
 #include "scenegraph/fill_screen_drawable.hpp"
 #include "input/controller.hpp"
@@ -35,6 +34,7 @@ ParticleViewer::ParticleViewer()
   : compositor(OpenGLWindow::current()->get_size(), Display::get_size()),
     sc(),
     sg(),
+    batcher(sg),
     systems(),
     background(Pathname("images/greychess.sprite")),
     pos(),
@@ -90,7 +90,7 @@ ParticleViewer::load(const Pathname& filename)
 
     for(Systems::iterator i = systems.begin(); i != systems.end(); ++i)
     {
-      sg.add_drawable(boost::shared_ptr<Drawable>(new ParticleSystemDrawable(**i)));
+      batcher.add(*i);
     }
   }
 }
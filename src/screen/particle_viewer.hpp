@@ -24,6 +24,7 @@
 
 #include "display/compositor.hpp"
 #include "display/scene_context.hpp"
+#include "scenegraph/particle_batcher.hpp"
 #include "scenegraph/scene_graph.hpp"
 #include "gui/gui_manager.hpp"
 #include "particles/particle_system.hpp"
@@ -47,6 +48,7 @@ private:
   Compositor compositor;
   SceneContext sc;
   SceneGraph   sg;
+  ParticleBatcher batcher;
   typedef std::vector<boost::shared_ptr<ParticleSystem> > Systems;
   Systems systems;
   Sprite background;
@@ -18,6 +18,7 @@
 
 #include "screen/screen_manager.hpp"
 
+#include <algorithm>
 #include <boost/format.hpp>
 
 #include "app/config.hpp"
@@ -29,6 +30,7 @@
 #include "input/input_manager_sdl.hpp"
 #include "screen/game_session.hpp"
 #include "sound/sound_manager.hpp"
+#include "util/profiler.hpp"
 
 
 ScreenManager::ScreenManager() :
@@ -43,6 +45,10 @@ ScreenManager::ScreenManager() :
   frame_counter(0),
   last_fps(0),
   overlap_delta(0),
+  update_rate(120.0f),
+  max_update_steps(8),
+  interpolation(0.0f),
+  frame_pacer(),
   do_quit(false),
   show_controller_help_window(false),
   controller_help_window()
@@ -69,50 +75,75 @@ ScreenManager::run()
   {
     /// Amount of time the world moves forward each update(), this is
     /// independed of the number of frames and always constant
-    static const float step = 0.001f;
+    const float step = 1.0f / update_rate;
 
-    Uint32 now = SDL_GetTicks();
-    float delta = static_cast<float>(now - ticks) / 1000.0f + overlap_delta;
-    ticks = now;
+    Profiler::set_overlay_enabled(config.get_bool("show-profiler"));
 
-    time_counter += delta;
-
-    while (delta > step)
     {
-      InputManagerSDL::current()->update(delta);
+      ProfileScope profile_scope("ScreenManager::frame");
+
+      Uint32 now = SDL_GetTicks();
+      float delta = static_cast<float>(now - ticks) / 1000.0f;
+      ticks = now;
+
+      time_counter  += delta;
+      overlap_delta += delta;
 
-      Console::current()->update(step);
-      if (!Console::current()->is_active())
       {
-        if (!overlay_screens.empty())
-          overlay_screens.back()->update(step, InputManagerSDL::current()->get_controller());
-        else if (!screens.empty())
-          screens.back()->update(step, InputManagerSDL::current()->get_controller());
-      }
-      InputManagerSDL::current()->clear();
+        ProfileScope update_scope("ScreenManager::update");
+
+        int steps = 0;
+        while (overlap_delta >= step && steps < max_update_steps)
+        {
+          InputManagerSDL::current()->update(step);
+
+          Console::current()->update(step);
+          if (!Console::current()->is_active())
+          {
+            if (!overlay_screens.empty())
+              overlay_screens.back()->update(step, InputManagerSDL::current()->get_controller());
+            else if (!screens.empty())
+              screens.back()->update(step, InputManagerSDL::current()->get_controller());
+          }
+          InputManagerSDL::current()->clear();
   
-      delta -= step;
-    }
-      
-    overlap_delta = delta;
+          overlap_delta -= step;
+          steps += 1;
+        }
+
+        if (overlap_delta >= step)
+        {
+          // The updates can't keep up, drop the backlog instead of
+          // falling further behind with every frame
+          overlap_delta = fmodf(overlap_delta, step);
+        }
+      }
+
+      interpolation = overlap_delta / step;
 
-    SoundManager::current()->update(delta);
+      SoundManager::current()->update(delta);
 
-    draw();
+      draw();
 
-    frame_counter += 1;
+      frame_counter += 1;
 
-    poll_events();
+      poll_events();
 
-    apply_pending_actions();
+      apply_pending_actions();
+    }
+
+    Profiler::frame_end();
+    write_pending_trace();
 
-    SDL_Delay(5);
+    frame_pacer.wait();
   }
 }
 
 void
 ScreenManager::draw()
 {
+  ProfileScope profile_scope("ScreenManager::draw");
+
   if (!screens.empty())
     screens.back()->draw();
 
@@ -127,6 +158,9 @@ ScreenManager::draw()
   if (config.get_bool("show-fps"))
     draw_fps();
 
+  if (config.get_bool("show-profiler"))
+    draw_profiler();
+
   OpenGLWindow::current()->swap_buffers();
 }
 
@@ -311,6 +345,62 @@ ScreenManager::draw_fps()
   Fonts::current()->ttffont->draw(Vector2f(static_cast<float>(Display::get_width()) - 100.0f, 30.0f), out.str());
 }
 
+void
+ScreenManager::set_update_rate(float hz)
+{
+  assert(hz > 0.0f);
+  update_rate = hz;
+}
+
+void
+ScreenManager::set_max_update_steps(int steps)
+{
+  max_update_steps = std::max(1, steps);
+}
+
+void
+ScreenManager::draw_profiler()
+{
+  const std::vector<ProfilerNode>& nodes = Profiler::get_nodes();
+
+  TTFFont* font = Fonts::current()->vera12.get();
+  float y = 60.0f;
+  for(std::vector<ProfilerNode>::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+  {
+    std::ostringstream out;
+    out << boost::format("%6.2fms") % i->msec << "  " << std::string(2 * i->depth, ' ') << i->name;
+    if (i->calls > 1)
+      out << " (" << i->calls << "x)";
+
+    font->draw(Vector2f(20.0f, y), out.str());
+    y += static_cast<float>(font->get_height());
+  }
+}
+
+void
+ScreenManager::write_pending_trace()
+{
+  if (Profiler::is_capture_complete())
+  {
+    int count = 0;
+    Pathname filename;
+    do {
+      filename = Pathname((boost::format("profile/trace%04d.json") % count).str(), Pathname::kUserPath);
+      count += 1;
+    } while(filename.exists());
+
+    try
+    {
+      Profiler::write_trace(filename);
+      ConsoleLog << "Writing profile trace to: '" << filename << "'" << std::endl;
+    }
+    catch(std::exception& err)
+    {
+      ConsoleLog << "Error: " << err.what() << std::endl;
+    }
+  }
+}
+
 void
 ScreenManager::push_screen(Screen* s)
 {
@@ -23,6 +23,7 @@
 #include <boost/scoped_ptr.hpp>
 #include <vector>
 
+#include "screen/frame_pacer.hpp"
 #include "util/currenton.hpp"
 
 class Screen;
@@ -51,7 +52,20 @@ private:
   float time_counter;
   int   frame_counter;
   int   last_fps;
+  /** simulation time not yet consumed by update() */
   float overlap_delta;
+
+  /** number of update() steps per second */
+  float update_rate;
+
+  /** upper limit of update() steps per frame, if a frame needs more,
+      the simulation slows down instead */
+  int   max_update_steps;
+
+  float interpolation;
+
+  FramePacer frame_pacer;
+
   bool  do_quit;
   bool  show_controller_help_window;
   boost::scoped_ptr<ControllerHelpWindow> controller_help_window;
@@ -82,6 +96,17 @@ public:
   void pop_overlay();
   void clear_overlay();
 
+  void set_update_rate(float hz);
+  void set_max_update_steps(int steps);
+
+  /** Returns how far the simulation has advanced beyond the last
+      update(), as fraction of an update step in the range [0,1).
+      Screens can use it in draw() to interpolate between the last two
+      simulation states. */
+  float get_interpolation() const { return interpolation; }
+
+  FramePacer& get_frame_pacer() { return frame_pacer; }
+
   // Callbacks, FIXME: Could be moved to a seperate class
   void show_controller_debug(bool v);
   bool get_show_controller_debug() const;
@@ -89,6 +114,11 @@ public:
 private:
   void poll_events();
   void draw_fps();
+  void draw_profiler();
+
+  /** Writes the profiler trace to the user directory once a capture
+      is complete */
+  void write_pending_trace();
 
   ScreenManager (const ScreenManager&);
   ScreenManager& operator= (const ScreenManager&);
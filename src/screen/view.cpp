@@ -36,8 +36,10 @@ View::View()
 void
 View::draw(SceneContext& sc, Sector& sector)
 {
-  state.set_zoom(camera.get_zoom() + (m_debug_zoom - 1.0f));
-  state.set_pos(camera.get_pos() + m_debug_transform);
+  // the camera is drawn in between its last two steps, so that it
+  // moves smoothly when there are more frames than update steps
+  state.set_zoom(camera.get_interpolated_zoom(sc.get_interpolation()) + (m_debug_zoom - 1.0f));
+  state.set_pos(camera.get_interpolated_pos(sc.get_interpolation()) + m_debug_transform);
 
   state.push(sc);
 
@@ -42,6 +42,7 @@ public:
   View();
 
   GraphicContextState get_gc_state() { return state; }
+  Camera& get_camera() { return camera; }
 
   /** @return the rectangle which represents the currently visible
       area, everything outside of it doesn't have to be drawn */
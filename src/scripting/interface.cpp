@@ -22,7 +22,10 @@
 
 #include "lisp/lisp.hpp"
 #include "app/config.hpp"
+#include "display/framebuffer_pool.hpp"
 #include "display/opengl_window.hpp"
+#include "display/surface_manager.hpp"
+#include "display/texture_manager.hpp"
 #include "engine/camera.hpp"
 #include "engine/sector.hpp"
 #include "engine/squirrel_thread.hpp"
@@ -32,7 +35,9 @@
 #include "hud/pda.hpp"
 #include "hud/speech_manager.hpp"
 #include "screen/game_session.hpp"
+#include "screen/screen_manager.hpp"
 #include "sound/sound_manager.hpp"
+#include "util/profiler.hpp"
 #include "util/sexpr_file_reader.hpp"
 
 namespace Scripting
@@ -314,6 +319,51 @@ void show_config()
   config.debug_print(ConsoleLog);
 }
 
+void show_resource_cache_stats()
+{
+  ConsoleLog << "textures: " << TextureManager::current()->get_stats() << std::endl;
+  ConsoleLog << "surfaces: " << SurfaceManager::current()->get_stats() << std::endl;
+}
+
+void resource_cache_cleanup()
+{
+  SurfaceManager::current()->cleanup();
+  TextureManager::current()->cleanup();
+  FramebufferPool::current()->cleanup();
+}
+
+void show_framebuffer_pool_stats()
+{
+  ConsoleLog << "framebuffers: " << FramebufferPool::current()->get_stats() << std::endl;
+}
+
+void show_profiler(bool show)
+{
+  config.set_bool("show-profiler", show);
+}
+
+void profiler_capture(int frames)
+{
+  if (frames <= 0)
+  {
+    ConsoleLog << "profiler_capture: number of frames must be positive" << std::endl;
+  }
+  else
+  {
+    Profiler::start_capture(frames);
+    ConsoleLog << "Capturing " << frames << " frames" << std::endl;
+  }
+}
+
+void show_frame_times()
+{
+  const FramePacer& pacer = ScreenManager::current()->get_frame_pacer();
+  ConsoleLog << "frames: " << pacer.get_num_frames()
+             << "  p50: " << pacer.get_percentile(50.0f) << "ms"
+             << "  p95: " << pacer.get_percentile(95.0f) << "ms"
+             << "  p99: " << pacer.get_percentile(99.0f) << "ms" << std::endl;
+}
+
 void cutscene_begin()
 {
   GameSession::current()->set_cutscene_mode(true);
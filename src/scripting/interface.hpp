@@ -119,6 +119,27 @@ void set_gamma_rgb(float r, float g, float b);
 
 void show_config();
 
+/** Print hit/miss counters and memory usage of the texture and surface caches */
+void show_resource_cache_stats();
+
+/** Drop all cached textures, surfaces and render targets that are no
+    longer in use */
+void resource_cache_cleanup();
+
+/** Print the number and memory usage of live and idle render targets */
+void show_framebuffer_pool_stats();
+
+/** Show or hide the per frame timings of the profiler markers */
+void show_profiler(bool show);
+
+/** Record the profiler markers of the next \a frames frames and write
+    them as Chrome trace to the profile/ directory in the user
+    directory */
+void profiler_capture(int frames);
+
+/** Print the 50th, 95th and 99th percentile of the recent frame times */
+void show_frame_times();
+
 void cutscene_begin();
 void cutscene_end();
 
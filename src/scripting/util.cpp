@@ -440,6 +440,7 @@ void save_squirrel_table(HSQUIRRELVM v, int table_idx, const std::string& file)
   writer.start_list("squirrel-state");
   save_squirrel_table(v, table_idx, writer);
   writer.end_list("squirrel-state");
+  writer.commit();
 }
 
 } // namespace Scripting
@@ -1435,6 +1435,128 @@ static SQInteger show_config_wrapper(HSQUIRRELVM vm)
 
 }
 
+static SQInteger show_resource_cache_stats_wrapper(HSQUIRRELVM vm)
+{
+  (void) vm;
+
+  try {
+    Scripting::show_resource_cache_stats();
+
+    return 0;
+
+  } catch(std::exception& e) {
+    sq_throwerror(vm, e.what());
+    return SQ_ERROR;
+  } catch(...) {
+    sq_throwerror(vm, _SC("Unexpected exception while executing function 'show_resource_cache_stats'"));
+    return SQ_ERROR;
+  }
+
+}
+
+static SQInteger resource_cache_cleanup_wrapper(HSQUIRRELVM vm)
+{
+  (void) vm;
+
+  try {
+    Scripting::resource_cache_cleanup();
+
+    return 0;
+
+  } catch(std::exception& e) {
+    sq_throwerror(vm, e.what());
+    return SQ_ERROR;
+  } catch(...) {
+    sq_throwerror(vm, _SC("Unexpected exception while executing function 'resource_cache_cleanup'"));
+    return SQ_ERROR;
+  }
+
+}
+
+static SQInteger show_framebuffer_pool_stats_wrapper(HSQUIRRELVM vm)
+{
+  (void) vm;
+
+  try {
+    Scripting::show_framebuffer_pool_stats();
+
+    return 0;
+
+  } catch(std::exception& e) {
+    sq_throwerror(vm, e.what());
+    return SQ_ERROR;
+  } catch(...) {
+    sq_throwerror(vm, _SC("Unexpected exception while executing function 'show_framebuffer_pool_stats'"));
+    return SQ_ERROR;
+  }
+
+}
+
+static SQInteger show_profiler_wrapper(HSQUIRRELVM vm)
+{
+  SQBool arg0;
+  if(SQ_FAILED(sq_getbool(vm, 2, &arg0))) {
+    sq_throwerror(vm, _SC("Argument 1 not a bool"));
+    return SQ_ERROR;
+  }
+
+  try {
+    Scripting::show_profiler(arg0 == SQTrue);
+
+    return 0;
+
+  } catch(std::exception& e) {
+    sq_throwerror(vm, e.what());
+    return SQ_ERROR;
+  } catch(...) {
+    sq_throwerror(vm, _SC("Unexpected exception while executing function 'show_profiler'"));
+    return SQ_ERROR;
+  }
+
+}
+
+static SQInteger profiler_capture_wrapper(HSQUIRRELVM vm)
+{
+  SQInteger arg0;
+  if(SQ_FAILED(sq_getinteger(vm, 2, &arg0))) {
+    sq_throwerror(vm, _SC("Argument 1 not an integer"));
+    return SQ_ERROR;
+  }
+
+  try {
+    Scripting::profiler_capture(static_cast<int> (arg0));
+
+    return 0;
+
+  } catch(std::exception& e) {
+    sq_throwerror(vm, e.what());
+    return SQ_ERROR;
+  } catch(...) {
+    sq_throwerror(vm, _SC("Unexpected exception while executing function 'profiler_capture'"));
+    return SQ_ERROR;
+  }
+
+}
+
+static SQInteger show_frame_times_wrapper(HSQUIRRELVM vm)
+{
+  (void) vm;
+
+  try {
+    Scripting::show_frame_times();
+
+    return 0;
+
+  } catch(std::exception& e) {
+    sq_throwerror(vm, e.what());
+    return SQ_ERROR;
+  } catch(...) {
+    sq_throwerror(vm, _SC("Unexpected exception while executing function 'show_frame_times'"));
+    return SQ_ERROR;
+  }
+
+}
+
 static SQInteger cutscene_begin_wrapper(HSQUIRRELVM vm)
 {
   (void) vm;
@@ -2067,6 +2189,48 @@ void register_windstille_wrapper(HSQUIRRELVM v)
     throw SquirrelError(v, "Couldn't register function 'show_config'");
   }
 
+  sq_pushstring(v, "show_resource_cache_stats", -1);
+  sq_newclosure(v, &show_resource_cache_stats_wrapper, 0);
+  sq_setparamscheck(v, SQ_MATCHTYPEMASKSTRING, "x|t");
+  if(SQ_FAILED(sq_createslot(v, -3))) {
+    throw SquirrelError(v, "Couldn't register function 'show_resource_cache_stats'");
+  }
+
+  sq_pushstring(v, "resource_cache_cleanup", -1);
+  sq_newclosure(v, &resource_cache_cleanup_wrapper, 0);
+  sq_setparamscheck(v, SQ_MATCHTYPEMASKSTRING, "x|t");
+  if(SQ_FAILED(sq_createslot(v, -3))) {
+    throw SquirrelError(v, "Couldn't register function 'resource_cache_cleanup'");
+  }
+
+  sq_pushstring(v, "show_framebuffer_pool_stats", -1);
+  sq_newclosure(v, &show_framebuffer_pool_stats_wrapper, 0);
+  sq_setparamscheck(v, SQ_MATCHTYPEMASKSTRING, "x|t");
+  if(SQ_FAILED(sq_createslot(v, -3))) {
+    throw SquirrelError(v, "Couldn't register function 'show_framebuffer_pool_stats'");
+  }
+
+  sq_pushstring(v, "show_profiler", -1);
+  sq_newclosure(v, &show_profiler_wrapper, 0);
+  sq_setparamscheck(v, SQ_MATCHTYPEMASKSTRING, "x|tb");
+  if(SQ_FAILED(sq_createslot(v, -3))) {
+    throw SquirrelError(v, "Couldn't register function 'show_profiler'");
+  }
+
+  sq_pushstring(v, "profiler_capture", -1);
+  sq_newclosure(v, &profiler_capture_wrapper, 0);
+  sq_setparamscheck(v, SQ_MATCHTYPEMASKSTRING, "x|ti");
+  if(SQ_FAILED(sq_createslot(v, -3))) {
+    throw SquirrelError(v, "Couldn't register function 'profiler_capture'");
+  }
+
+  sq_pushstring(v, "show_frame_times", -1);
+  sq_newclosure(v, &show_frame_times_wrapper, 0);
+  sq_setparamscheck(v, SQ_MATCHTYPEMASKSTRING, "x|t");
+  if(SQ_FAILED(sq_createslot(v, -3))) {
+    throw SquirrelError(v, "Couldn't register function 'show_frame_times'");
+  }
+
   sq_pushstring(v, "cutscene_begin", -1);
   sq_newclosure(v, &cutscene_begin_wrapper, 0);
   sq_setparamscheck(v, SQ_MATCHTYPEMASKSTRING, "x|t");
@@ -26,9 +26,11 @@
 #include "sound/static_sound_source.hpp"
 #include "sound/sound_manager.hpp"
 #include "util/pathname.hpp"
+#include "util/profiler.hpp"
 
 
 SoundManager::SoundManager() :
+  m_streamer(),
   m_device(0), 
   m_context(0), 
   m_sound_enabled(false), 
@@ -306,6 +308,8 @@ SoundManager::set_gain(float gain)
 void
 SoundManager::update(float delta)
 {
+  ProfileScope profile_scope("SoundManager::update");
+
   m_voice_channel.update(delta);
   m_sound_channel.update(delta);
   m_music_channel.update(delta);
@@ -35,6 +35,7 @@
 
 #include "math/vector2f.hpp"
 #include "sound/sound_channel.hpp"
+#include "sound/sound_streamer.hpp"
 #include "util/currenton.hpp"
 #include "util/pathname.hpp"
 
@@ -95,6 +96,9 @@ private:
   void print_openal_version();
   void check_alc_error(const char* message);
 
+  /** decodes the StreamSoundSources, must outlive them */
+  SoundStreamer m_streamer;
+
   ALCdevice*  m_device;
   ALCcontext* m_context;
   bool m_sound_enabled;
@@ -0,0 +1,187 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "sound/sound_stream.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+#include "sound/sound_file.hpp"
+#include "sound/sound_manager.hpp"
+
+SoundStream::SoundStream(std::auto_ptr<SoundFile> sound_file) :
+  m_sound_file(sound_file),
+  m_decoded_generation(0),
+  m_at_end(false),
+  m_failed(false),
+  m_format(SoundManager::get_sample_format(m_sound_file.get())),
+  m_rate(m_sound_file->get_rate()),
+  m_channels(m_sound_file->get_channels()),
+  m_bits_per_sample(m_sound_file->get_bits_per_sample()),
+  m_size(m_sound_file->get_size()),
+  m_fragments(NUM_FRAGMENTS),
+  m_read(),
+  m_write(),
+  m_generation(),
+  m_seek_msec(),
+  m_looping(),
+  m_end()
+{
+  SDL_AtomicSet(&m_read, 0);
+  SDL_AtomicSet(&m_write, 0);
+  SDL_AtomicSet(&m_generation, 0);
+  SDL_AtomicSet(&m_seek_msec, 0);
+  SDL_AtomicSet(&m_looping, 0);
+  SDL_AtomicSet(&m_end, 0);
+}
+
+SoundStream::~SoundStream()
+{
+}
+
+bool
+SoundStream::decode()
+{
+  if (m_failed)
+  { // also ends the stream after a seek_to()
+    SDL_AtomicSet(&m_end, SDL_AtomicGet(&m_generation) + 1);
+    return false;
+  }
+
+  const int generation = SDL_AtomicGet(&m_generation);
+  if (generation != m_decoded_generation)
+  {
+    m_sound_file->seek_to(static_cast<float>(SDL_AtomicGet(&m_seek_msec)) / 1000.0f);
+    m_decoded_generation = generation;
+    m_at_end = false;
+  }
+
+  const bool looping = (SDL_AtomicGet(&m_looping) != 0);
+  if (m_at_end)
+  {
+    if (!looping)
+      return false;
+
+    // looping got switched on after the end was reached
+    m_at_end = false;
+    SDL_AtomicSet(&m_end, 0);
+  }
+
+  const int write = SDL_AtomicGet(&m_write);
+  if (static_cast<unsigned int>(write) - static_cast<unsigned int>(SDL_AtomicGet(&m_read)) >= NUM_FRAGMENTS)
+    return false; // ring is full
+
+  Fragment& fragment = m_fragments[static_cast<unsigned int>(write) % NUM_FRAGMENTS];
+
+  size_t bytesread = 0;
+  try
+  {
+    bool reset = false;
+    while(bytesread < FRAGMENT_SIZE)
+    {
+      const size_t len = m_sound_file->read(&fragment.data[bytesread], FRAGMENT_SIZE - bytesread);
+      bytesread += len;
+
+      if (len > 0)
+        reset = false;
+
+      // the end of the SoundFile is reached
+      if (bytesread < FRAGMENT_SIZE)
+      {
+        if (looping && !reset)
+        { // loop, unless the file is empty
+          m_sound_file->reset();
+          reset = true;
+        }
+        else
+        { // or end
+          m_at_end = true;
+          break;
+        }
+      }
+    }
+  }
+  catch(const std::exception& err)
+  { // end the stream with what was read so far
+    std::cout << "SoundStream: " << err.what() << std::endl;
+    m_failed = true;
+    m_at_end = true;
+  }
+
+  fragment.size       = bytesread;
+  fragment.generation = generation;
+
+  // publish the fragment before the end, so that is_finished() never
+  // misses the last one
+  if (bytesread > 0)
+    SDL_AtomicSet(&m_write, write + 1);
+
+  if (m_at_end && (!looping || m_failed))
+    SDL_AtomicSet(&m_end, generation + 1);
+
+  return bytesread > 0;
+}
+
+const SoundStream::Fragment*
+SoundStream::front()
+{
+  const int generation = SDL_AtomicGet(&m_generation);
+
+  while(true)
+  {
+    const int read = SDL_AtomicGet(&m_read);
+    if (read == SDL_AtomicGet(&m_write))
+      return 0;
+
+    const Fragment& fragment = m_fragments[static_cast<unsigned int>(read) % NUM_FRAGMENTS];
+    if (fragment.generation == generation)
+      return &fragment;
+
+    // decoded before the last seek_to()
+    SDL_AtomicSet(&m_read, read + 1);
+  }
+}
+
+void
+SoundStream::pop()
+{
+  SDL_AtomicAdd(&m_read, 1);
+}
+
+bool
+SoundStream::is_finished()
+{
+  const int end = SDL_AtomicGet(&m_end);
+  return end == SDL_AtomicGet(&m_generation) + 1 && !front();
+}
+
+void
+SoundStream::set_looping(bool looping)
+{
+  SDL_AtomicSet(&m_looping, looping ? 1 : 0);
+}
+
+void
+SoundStream::seek_to(float sec)
+{
+  SDL_AtomicSet(&m_seek_msec, static_cast<int>(sec * 1000.0f));
+  SDL_AtomicAdd(&m_generation, 1);
+}
+
+/* EOF */
@@ -0,0 +1,131 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef HEADER_WINDSTILLE_SOUND_SOUND_STREAM_HPP
+#define HEADER_WINDSTILLE_SOUND_SOUND_STREAM_HPP
+
+#include <SDL.h>
+#include <memory>
+#include <vector>
+
+#ifdef __APPLE__
+#  include <OpenAL/al.h>
+#else
+#  include <AL/al.h>
+#endif
+
+class SoundFile;
+
+/**
+ * The decoded PCM of a streamed SoundFile. The SoundStreamer thread
+ * decodes the file into a ring of fragments with decode(), the
+ * StreamSoundSource takes them out on the main thread with front()
+ * and pop(). Each side only writes its own end of the ring, so the
+ * two never wait on each other.
+ *
+ * Everything except decode() must only be called from the main
+ * thread, decode() only from one thread at a time.
+ */
+class SoundStream
+{
+public:
+  static const size_t FRAGMENT_SIZE = 65536;
+  static const unsigned int NUM_FRAGMENTS = 4;
+
+  struct Fragment
+  {
+    Fragment() : data(FRAGMENT_SIZE), size(0), generation(0) {}
+
+    std::vector<char> data;
+    size_t size;
+
+    /** the seek generation the fragment was decoded in */
+    int generation;
+  };
+
+private:
+  // only touched by the decoding thread
+  std::auto_ptr<SoundFile> m_sound_file;
+  int  m_decoded_generation;
+  bool m_at_end;
+  bool m_failed;
+
+  // the format is copied, so that the main thread never has to touch
+  // m_sound_file
+  ALenum m_format;
+  int    m_rate;
+  int    m_channels;
+  int    m_bits_per_sample;
+  size_t m_size;
+
+  std::vector<Fragment> m_fragments;
+
+  /** number of fragments taken out, written by the main thread */
+  SDL_atomic_t m_read;
+
+  /** number of fragments decoded, written by the decoding thread */
+  SDL_atomic_t m_write;
+
+  /** incremented by seek_to(), fragments of an older generation get
+      skipped */
+  SDL_atomic_t m_generation;
+  SDL_atomic_t m_seek_msec;
+
+  SDL_atomic_t m_looping;
+
+  /** generation + 1 of the last decoded fragment once the end of a
+      not looping file is reached, 0 otherwise */
+  SDL_atomic_t m_end;
+
+public:
+  SoundStream(std::auto_ptr<SoundFile> sound_file);
+  ~SoundStream();
+
+  /** Decodes the next fragment if there is room for it, returns
+      false if there was nothing to do */
+  bool decode();
+
+  /** Returns the next decoded fragment or 0 if none is ready */
+  const Fragment* front();
+  void pop();
+
+  /** True once the end of the file is reached and all fragments are
+      taken out, never true while looping */
+  bool is_finished();
+
+  void set_looping(bool looping);
+
+  /** Continues decoding at \a sec, fragments decoded so far are
+      dropped */
+  void seek_to(float sec);
+
+  ALenum get_format() const { return m_format; }
+  int    get_rate() const { return m_rate; }
+  int    get_channels() const { return m_channels; }
+  int    get_bits_per_sample() const { return m_bits_per_sample; }
+  size_t get_size() const { return m_size; }
+
+private:
+  SoundStream(const SoundStream&);
+  SoundStream& operator=(const SoundStream&);
+};
+
+#endif
+
+/* EOF */
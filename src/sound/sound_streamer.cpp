@@ -0,0 +1,128 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "sound/sound_streamer.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#include "sound/sound_stream.hpp"
+
+namespace {
+
+/** A fragment lasts around 370msec at 44.1kHz 16bit stereo, so this
+    keeps the streams far ahead of what OpenAL plays */
+const Uint32 poll_interval = 20;
+
+} // namespace
+
+SoundStreamer::SoundStreamer() :
+  m_mutex(SDL_CreateMutex()),
+  m_cond(SDL_CreateCond()),
+  m_thread(0),
+  m_quit(false),
+  m_streams()
+{
+  m_thread = SDL_CreateThread(&SoundStreamer::thread_main, "SoundStreamer", this);
+  if (!m_thread)
+  {
+    std::cout << "SoundStreamer: couldn't create thread: " << SDL_GetError() << std::endl;
+  }
+}
+
+SoundStreamer::~SoundStreamer()
+{
+  if (m_thread)
+  {
+    SDL_LockMutex(m_mutex);
+    m_quit = true;
+    SDL_CondSignal(m_cond);
+    SDL_UnlockMutex(m_mutex);
+
+    SDL_WaitThread(m_thread, 0);
+  }
+
+  SDL_DestroyCond(m_cond);
+  SDL_DestroyMutex(m_mutex);
+}
+
+void
+SoundStreamer::add(const boost::shared_ptr<SoundStream>& stream)
+{
+  SDL_LockMutex(m_mutex);
+  m_streams.push_back(stream);
+  SDL_CondSignal(m_cond);
+  SDL_UnlockMutex(m_mutex);
+}
+
+void
+SoundStreamer::remove(const boost::shared_ptr<SoundStream>& stream)
+{
+  SDL_LockMutex(m_mutex);
+  m_streams.erase(std::remove(m_streams.begin(), m_streams.end(), stream), m_streams.end());
+  SDL_UnlockMutex(m_mutex);
+}
+
+void
+SoundStreamer::wake()
+{
+  SDL_LockMutex(m_mutex);
+  SDL_CondSignal(m_cond);
+  SDL_UnlockMutex(m_mutex);
+}
+
+void
+SoundStreamer::run()
+{
+  std::vector<boost::shared_ptr<SoundStream> > streams;
+
+  SDL_LockMutex(m_mutex);
+  while(!m_quit)
+  {
+    // decode without holding the lock, a stream removed in the
+    // meantime stays alive until the copy is cleared
+    streams = m_streams;
+    SDL_UnlockMutex(m_mutex);
+
+    for(std::vector<boost::shared_ptr<SoundStream> >::iterator i = streams.begin(); i != streams.end(); ++i)
+    {
+      while((*i)->decode()) {}
+    }
+    streams.clear();
+
+    SDL_LockMutex(m_mutex);
+    if (!m_quit)
+    {
+      if (m_streams.empty())
+        SDL_CondWait(m_cond, m_mutex);
+      else
+        SDL_CondWaitTimeout(m_cond, m_mutex, poll_interval);
+    }
+  }
+  SDL_UnlockMutex(m_mutex);
+}
+
+int
+SoundStreamer::thread_main(void* data)
+{
+  static_cast<SoundStreamer*>(data)->run();
+  return 0;
+}
+
+/* EOF */
@@ -0,0 +1,76 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef HEADER_WINDSTILLE_SOUND_SOUND_STREAMER_HPP
+#define HEADER_WINDSTILLE_SOUND_SOUND_STREAMER_HPP
+
+#include <SDL.h>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+#include "util/currenton.hpp"
+
+class SoundStream;
+
+/**
+ * A thread that keeps the SoundStreams decoded ahead, so that the
+ * main thread only has to hand the decoded PCM to OpenAL. The thread
+ * sleeps while there are no streams and otherwise looks for free room
+ * in the streams every few milliseconds.
+ *
+ * add(), remove() and wake() must only be called from the main thread.
+ */
+class SoundStreamer : public Currenton<SoundStreamer>
+{
+private:
+  SDL_mutex*  m_mutex;
+  SDL_cond*   m_cond;
+  SDL_Thread* m_thread;
+  bool m_quit;
+
+  /** guarded by m_mutex */
+  std::vector<boost::shared_ptr<SoundStream> > m_streams;
+
+public:
+  SoundStreamer();
+  ~SoundStreamer();
+
+  /** False if the thread couldn't be started, the streams then have
+      to be decoded by their owners */
+  bool is_running() const { return m_thread != 0; }
+
+  void add(const boost::shared_ptr<SoundStream>& stream);
+  void remove(const boost::shared_ptr<SoundStream>& stream);
+
+  /** Makes the thread look at the streams right away, instead of
+      after the next timeout */
+  void wake();
+
+private:
+  void run();
+  static int thread_main(void* data);
+
+private:
+  SoundStreamer(const SoundStreamer&);
+  SoundStreamer& operator=(const SoundStreamer&);
+};
+
+#endif
+
+/* EOF */
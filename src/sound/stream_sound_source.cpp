@@ -22,12 +22,14 @@
 
 #include "sound/sound_manager.hpp"
 #include "sound/sound_file.hpp"
+#include "sound/sound_stream.hpp"
+#include "sound/sound_streamer.hpp"
 
 StreamSoundSource::StreamSoundSource(SoundChannel& channel, std::auto_ptr<SoundFile> sound_file) :
   OpenALSoundSource(channel),
-  m_sound_file(sound_file),
-  m_format(SoundManager::get_sample_format(m_sound_file.get())),
-  m_looping(false),
+  m_stream(new SoundStream(sound_file)),
+  m_free_buffers(),
+  m_playing(false),
   m_total_buffers_processed(0),
   m_fade_state(),
   m_fade_start_ticks(),
@@ -37,73 +39,112 @@ StreamSoundSource::StreamSoundSource(SoundChannel& channel, std::auto_ptr<SoundF
   alGenBuffers(STREAMFRAGMENTS, m_buffers);
   SoundManager::check_al_error("Couldn't allocate audio buffers: ");
 
-  try 
-  {
-    for(size_t i = 0; i < STREAMFRAGMENTS; ++i) 
-    {
-      fill_buffer_and_queue(m_buffers[i]);
-    }
-  }
-  catch(...) 
+  m_free_buffers.assign(m_buffers, m_buffers + STREAMFRAGMENTS);
+
+  if (SoundStreamer* streamer = SoundStreamer::current())
   {
-    alDeleteBuffers(STREAMFRAGMENTS, m_buffers);
-    throw;
+    streamer->add(m_stream);
   }
 }
 
 StreamSoundSource::~StreamSoundSource()
 {
+  if (SoundStreamer* streamer = SoundStreamer::current())
+  {
+    streamer->remove(m_stream);
+  }
+
   stop();
 
   alDeleteBuffers(STREAMFRAGMENTS, m_buffers);
   SoundManager::check_al_error("Couldn't delete audio buffers: ");
 }
 
+void
+StreamSoundSource::play()
+{
+  m_playing = true;
+
+  queue_fragments();
+
+  ALint queued = 0;
+  alGetSourcei(m_source, AL_BUFFERS_QUEUED, &queued);
+  if (queued > 0)
+  {
+    OpenALSoundSource::play();
+  }
+  // otherwise update() starts the source once the first fragment is
+  // decoded
+}
+
+void
+StreamSoundSource::stop()
+{
+  m_playing = false;
+
+  // unqueues all buffers
+  OpenALSoundSource::stop();
+  m_free_buffers.assign(m_buffers, m_buffers + STREAMFRAGMENTS);
+}
+
+bool
+StreamSoundSource::is_playing() const
+{
+  if (!m_playing)
+  {
+    return false;
+  }
+  else if (OpenALSoundSource::is_playing())
+  {
+    return true;
+  }
+  else
+  { // waiting for the decoder
+    return !m_stream->is_finished();
+  }
+}
+
 void
 StreamSoundSource::set_looping(bool looping)
 {
   // native OpenAL looping will result in the queue being looped, not
   // the whole song as provided by the SoundFile, so we do it manually
-  m_looping = looping;
+  m_stream->set_looping(looping);
 }
 
 void
 StreamSoundSource::seek_to(float sec)
 {
-  m_sound_file->seek_to(sec);
-
-  if (false)
-  { // FIXME: clear the buffer or not on seek? see ov_time_seek_lap()
-    // in OggSoundFile for possible reason why jumping might not be a good idea
-    alSourceUnqueueBuffers(m_source, STREAMFRAGMENTS, m_buffers);
-    SoundManager::check_al_error("Couldn't unqueue audio buffers: ");
+  // FIXME: the buffers already queued are still played, see
+  // ov_time_seek_lap() in OggSoundFile for possible reason why
+  // jumping might not be a good idea
+  m_stream->seek_to(sec);
 
-    for(size_t i = 0; i < STREAMFRAGMENTS; ++i) 
-    {
-      fill_buffer_and_queue(m_buffers[i]);
-    }
+  if (SoundStreamer* streamer = SoundStreamer::current())
+  {
+    streamer->wake();
   }
 }
 
 float
 StreamSoundSource::get_pos() const
 {
-  return static_cast<float>(get_sample_pos()) / static_cast<float>(m_sound_file->get_rate());
+  return static_cast<float>(get_sample_pos()) / static_cast<float>(m_stream->get_rate());
 }
 
 int
 StreamSoundSource::get_sample_pos() const
 {
-  int samples_total = m_total_buffers_processed * (STREAMFRAGMENTSIZE
-                                                   / m_sound_file->get_channels() 
-                                                   / (m_sound_file->get_bits_per_sample()/8));
+  int samples_total = m_total_buffers_processed * (SoundStream::FRAGMENT_SIZE
+                                                   / m_stream->get_channels() 
+                                                   / (m_stream->get_bits_per_sample()/8));
 
   ALint sample_pos;
   alGetSourcei(m_source, AL_SAMPLE_OFFSET, &sample_pos); 
 
-  return (samples_total + sample_pos) % (m_sound_file->get_size()
-                                         / m_sound_file->get_channels() 
-                                         / (m_sound_file->get_bits_per_sample()/8));
+  return (samples_total + sample_pos) % (m_stream->get_size()
+                                         / m_stream->get_channels() 
+                                         / (m_stream->get_bits_per_sample()/8));
 }
 
 void
@@ -111,34 +152,49 @@ StreamSoundSource::update(float delta)
 {
   m_total_time += delta;
 
+  SoundStreamer* streamer = SoundStreamer::current();
+  if (!streamer || !streamer->is_running())
+  { // no decoding thread, so do it here
+    while(m_stream->decode()) {}
+  }
+
   if (is_playing())
   {
-    // fill the buffer queue with new data
-    if (m_looping || !m_sound_file->eof())
-    {
-      ALint processed = 0;
-      alGetSourcei(m_source, AL_BUFFERS_PROCESSED, &processed);
+    // take back the buffers OpenAL is done with
+    ALint processed = 0;
+    alGetSourcei(m_source, AL_BUFFERS_PROCESSED, &processed);
 
-      while (processed > 0) 
-      {
-        processed--;
+    while (processed > 0) 
+    {
+      processed--;
 
-        m_total_buffers_processed += 1;
+      m_total_buffers_processed += 1;
     
-        ALuint buffer;
-        alSourceUnqueueBuffers(m_source, 1, &buffer);
-        SoundManager::check_al_error("Couldn't unqueue audio buffer: ");
+      ALuint buffer;
+      alSourceUnqueueBuffers(m_source, 1, &buffer);
+      SoundManager::check_al_error("Couldn't unqueue audio buffer: ");
 
-        fill_buffer_and_queue(buffer);
-      }
+      m_free_buffers.push_back(buffer);
     }
+
+    // fill the buffer queue with new data
+    queue_fragments();
   
-    // we might have to restart the source if we had a buffer underrun
-    if (!is_playing()) 
+    // start the source once there is data or restart it if we had a
+    // buffer underrun
+    ALint state = AL_PLAYING;
+    alGetSourcei(m_source, AL_SOURCE_STATE, &state);
+    if (state == AL_INITIAL || state == AL_STOPPED)
     {
-      std::cerr << "Restarting audio source because of buffer underrun.\n";
-      alSourcePlay(m_source);
-      SoundManager::check_al_error("Couldn't restart audio source: ");
+      ALint queued = 0;
+      alGetSourcei(m_source, AL_BUFFERS_QUEUED, &queued);
+      if (queued > 0)
+      {
+        if (state == AL_STOPPED)
+          std::cerr << "Restarting audio source because of buffer underrun.\n";
+        alSourcePlay(m_source);
+        SoundManager::check_al_error("Couldn't restart audio source: ");
+      }
     }
 
     // handle fade-in/out
@@ -180,37 +236,22 @@ StreamSoundSource::set_fading(FadeState fade_state, float fade_time)
 }
 
 void
-StreamSoundSource::fill_buffer_and_queue(ALuint buffer)
+StreamSoundSource::queue_fragments()
 {
-  char bufferdata[STREAMFRAGMENTSIZE];
-  size_t bytesread = 0;
-
-  // fill buffer with data from m_sound_file
-  do 
+  while(!m_free_buffers.empty())
   {
-    bytesread += m_sound_file->read(bufferdata + bytesread,
-                                    STREAMFRAGMENTSIZE - bytesread);
+    const SoundStream::Fragment* fragment = m_stream->front();
+    if (!fragment)
+      break;
+
+    const ALuint buffer = m_free_buffers.back();
+    m_free_buffers.pop_back();
 
-    // the end of the SoundFile is reached
-    if (bytesread < STREAMFRAGMENTSIZE) 
-    {
-      if (m_looping)
-      { // loop
-        m_sound_file->reset();
-      }
-      else
-      { // or end
-        break;
-      }
-    }
-  }
-  while(bytesread < STREAMFRAGMENTSIZE);
-  
-  if (bytesread > 0)
-  {  
     // upload data to the OpenAL buffer
-    alBufferData(buffer, m_format, bufferdata, bytesread, m_sound_file->get_rate());
+    alBufferData(buffer, m_stream->get_format(), &fragment->data[0],
+                 static_cast<ALsizei>(fragment->size), m_stream->get_rate());
     SoundManager::check_al_error("Couldn't refill audio buffer: ");
+    m_stream->pop();
 
     // add buffer to the queue of this source
     alSourceQueueBuffers(m_source, 1, &buffer);
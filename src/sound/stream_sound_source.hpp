@@ -19,14 +19,21 @@
 #ifndef HEADER_WINDSTILLE_SOUND_STREAM_SOUND_SOURCE_HPP
 #define HEADER_WINDSTILLE_SOUND_STREAM_SOUND_SOURCE_HPP
 
+#include <boost/shared_ptr.hpp>
 #include <memory>
-#include <stdio.h>
+#include <vector>
 
 #include "sound/openal_sound_source.hpp"
 
 class SoundFile;
 class SoundChannel;
+class SoundStream;
 
+/**
+ * Plays a SoundFile by streaming it through a few OpenAL buffers. The
+ * decoding happens in the SoundStreamer thread, update() only moves
+ * the decoded fragments into the buffers OpenAL is done with.
+ */
 class StreamSoundSource : public OpenALSoundSource
 {
 public:
@@ -36,6 +43,10 @@ public:
   StreamSoundSource(SoundChannel& channel, std::auto_ptr<SoundFile> sound_file);
   virtual ~StreamSoundSource();
 
+  void play();
+  void stop();
+  bool is_playing() const;
+
   void update(float delta);
   void seek_to(float sec);
   void set_looping(bool looping);
@@ -47,17 +58,20 @@ public:
   FadeState get_fade_state() const { return m_fade_state; }
 
 private:
-  void fill_buffer_and_queue(ALuint buffer);
+  /** Fills the free buffers with decoded fragments and queues them */
+  void queue_fragments();
 
 private:
-  static const size_t STREAMFRAGMENTS    = 4;
-  static const size_t STREAMFRAGMENTSIZE = 65536;
+  static const size_t STREAMFRAGMENTS = 4;
 
-  std::auto_ptr<SoundFile> m_sound_file;
+  boost::shared_ptr<SoundStream> m_stream;
   ALuint m_buffers[STREAMFRAGMENTS];
-  ALenum m_format;
 
-  bool m_looping;
+  /** the buffers not queued on the source */
+  std::vector<ALuint> m_free_buffers;
+
+  /** play() was called, the source itself might still wait for data */
+  bool m_playing;
   int  m_total_buffers_processed;
 
   FadeState m_fade_state;
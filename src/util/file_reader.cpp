@@ -19,34 +19,20 @@
 #include "util/file_reader.hpp"
 
 #include <sstream>
-#include <fstream>
 #include <stdexcept>
 
+#include "lisp/arena.hpp"
 #include "lisp/lisp.hpp"
 #include "lisp/parser.hpp"
 #include "util/file_reader_impl.hpp"
+#include "util/mapped_file.hpp"
+#include "util/sexpr_cache.hpp"
 #include "util/sexpr_file_reader.hpp"
 
-FileReader
-FileReader::parse(const Pathname& filename)
-{
-  std::ifstream in(filename.get_sys_path().c_str());
-  if (!in)
-  {
-    std::ostringstream str;
-    str << "Couldn't open file: " << filename;
-    throw std::runtime_error(str.str());
-  }
-  else
-  {
-    return FileReader::parse(in, filename.get_sys_path());
-  }
-}
+namespace {
 
-FileReader
-FileReader::parse(std::istream& stream, const std::string& filename)
+FileReader make_reader(boost::shared_ptr<lisp::Arena> arena, lisp::Lisp* root, const std::string& filename)
 {
-  lisp::Lisp* root = lisp::Parser::parse(stream, filename);
   if (!root)
   {
     std::ostringstream msg;
@@ -55,7 +41,7 @@ FileReader::parse(std::istream& stream, const std::string& filename)
   }
   else if (root && root->get_type() == lisp::Lisp::TYPE_LIST && root->get_list_size() >= 1)
   {
-    return SExprFileReader(root, root->get_list_elem(0));
+    return SExprFileReader(arena, root->get_list_elem(0));
   }
   else
   {
@@ -65,6 +51,45 @@ FileReader::parse(std::istream& stream, const std::string& filename)
   }  
 }
 
+} // namespace
+
+FileReader
+FileReader::parse(const Pathname& filename)
+{
+  // the file gets mapped into memory, which saves the stream overhead
+  // and lets the lexer work without copying, the tree goes into an
+  // Arena shared by the reader and its sections
+  const std::string sys_path = filename.get_sys_path();
+  boost::shared_ptr<lisp::Arena> arena(new lisp::Arena);
+
+  if (!SExprCache::is_enabled())
+  {
+    return make_reader(arena, lisp::Parser::parse(sys_path, *arena), sys_path);
+  }
+  else
+  {
+    MappedFilePtr file = MappedFile::open(sys_path);
+
+    lisp::Lisp* root = SExprCache::load(filename, file->get_data(), file->get_size(), *arena);
+    if (!root)
+    {
+      // start over, a broken cache entry might have left garbage behind
+      arena.reset(new lisp::Arena);
+      root = lisp::Parser::parse(file->get_data(), file->get_size(), *arena, sys_path);
+      SExprCache::store(filename, file->get_data(), file->get_size(), root);
+    }
+
+    return make_reader(arena, root, sys_path);
+  }
+}
+
+FileReader
+FileReader::parse(std::istream& stream, const std::string& filename)
+{
+  boost::shared_ptr<lisp::Arena> arena(new lisp::Arena);
+  return make_reader(arena, lisp::Parser::parse(stream, *arena, filename), filename);
+}
+
 FileReader::FileReader(boost::shared_ptr<FileReaderImpl> impl_)
   : impl(impl_)
 {
@@ -182,5 +207,43 @@ FileReader::get_sections() const
   else
     return std::vector<FileReader>();
 }
+
+void
+FileReader::collect_strings(std::vector<std::string>& out) const
+{
+  if (impl.get())
+    impl->collect_strings(out);
+}
+
+FileReader::SectionIterator::SectionIterator(const FileReader& parent)
+  : m_parent(parent.impl),
+    m_index(0),
+    m_size(parent.impl.get() ? parent.impl->get_num_sections() : 0),
+    m_section()
+{
+}
+
+bool
+FileReader::SectionIterator::next()
+{
+  if (m_index >= m_size)
+  {
+    m_section = FileReader();
+    return false;
+  }
+  else
+  {
+    if (m_section.impl.unique())
+    { // nobody kept a copy of the last section, so it can be reused
+      m_parent->reuse_section(*m_section.impl, m_index);
+    }
+    else
+    {
+      m_section.impl = m_parent->get_section(m_index);
+    }
+    m_index += 1;
+    return true;
+  }
+}
 
 /* EOF */
@@ -46,6 +46,12 @@ public:
   std::vector<std::string> get_section_names() const;
   std::vector<FileReader>  get_sections() const;
 
+  class SectionIterator;
+
+  /** Appends all string values found in this section and its
+      subsections to \a out, e.g. to find the files it refers to */
+  void collect_strings(std::vector<std::string>& out) const;
+
   /** Generic getter function for non-standard types, see getter.hpp */
   template<typename T>
   bool get(const char* name, T& v) const
@@ -81,8 +87,36 @@ public:
   bool read(const char* name, std::vector<std::string>& v) const;
 
 private:
+  friend class SectionIterator;
+
   boost::shared_ptr<FileReaderImpl> impl;
 };
+
+/** Walks over the sections without building a vector of them:
+
+    for(FileReader::SectionIterator it(reader); it.next(); )
+      it->read(...);
+
+    The FileReader handed out is reused for the next section where
+    possible, copy it to keep a section beyond the next call to
+    next(). */
+class FileReader::SectionIterator
+{
+public:
+  SectionIterator(const FileReader& parent);
+
+  /** Moves to the next section, returns false when there is none */
+  bool next();
+
+  const FileReader& operator*()  const { return m_section; }
+  const FileReader* operator->() const { return &m_section; }
+
+private:
+  boost::shared_ptr<FileReaderImpl> m_parent;
+  size_t m_index;
+  size_t m_size;
+  FileReader m_section;
+};
 
 #endif
 
@@ -19,6 +19,7 @@
 #ifndef HEADER_WINDSTILLE_UTIL_FILE_READER_IMPL_HPP
 #define HEADER_WINDSTILLE_UTIL_FILE_READER_IMPL_HPP
 
+#include <boost/shared_ptr.hpp>
 #include <vector>
 #include <string>
 
@@ -50,6 +51,16 @@ public:
   virtual bool read_section(const char* name, FileReader&)   const =0;
   virtual std::vector<FileReader> get_sections() const =0;
   virtual std::vector<std::string> get_section_names() const =0;
+
+  /** Access to single sections, used by FileReader::SectionIterator */
+  virtual size_t get_num_sections() const =0;
+  virtual boost::shared_ptr<FileReaderImpl> get_section(size_t i) const =0;
+
+  /** Points \a reader, which was returned by get_section() of this
+      reader, to section \a i, which saves allocating a new one */
+  virtual void reuse_section(FileReaderImpl& reader, size_t i) const =0;
+
+  virtual void collect_strings(std::vector<std::string>& out) const =0;
 };
 
 #endif
@@ -16,8 +16,6 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <sstream>
-
 #include "display/color.hpp"
 #include "math/vector2f.hpp"
 #include "util/file_writer.hpp"
@@ -28,22 +26,47 @@ FileWriter::FileWriter(std::ostream& out_)
 {
 }
 
+FileWriter::FileWriter(const std::string& filename)
+  : out(filename),
+    indent_count(0)
+{
+}
+
 FileWriter::~FileWriter()
 {
 }
 
+void
+FileWriter::commit()
+{
+  out.commit();
+}
+
 void
 FileWriter::indent()
 {
-  out << '\n';
+  out.put('\n');
   for(int i = 0; i < indent_count; ++i)
-    out << "  ";
+    out.write("  ", 2);
+}
+
+void
+FileWriter::write_escaped(const char* str)
+{
+  out.put('"');
+  for(const char* p = str; *p; ++p)
+  {
+    if (*p == '"' || *p == '\\')
+      out.put('\\');
+    out.put(*p);
+  }
+  out.put('"');
 }
 
 FileWriter&
 FileWriter::write_raw(const std::string& value)
 {
-  out << value;
+  out.write(value);
   return *this;
 }
 
@@ -51,7 +74,8 @@ FileWriter&
 FileWriter::start_section(const std::string& name)
 {
   indent();
-  out << "(" << name;
+  out.put('(');
+  out.write(name);
   indent_count += 1;
   return *this;
 }
@@ -59,7 +83,7 @@ FileWriter::start_section(const std::string& name)
 FileWriter&
 FileWriter::end_section()
 {
-  out << ")";
+  out.put(')');
   indent_count -= 1;
   return *this;
 }
@@ -68,7 +92,9 @@ FileWriter&
 FileWriter::write(const std::string& name, bool value)
 {
   indent();
-  out << "(" << name << " " << (value?"#t":"#f") << ")";
+  out.put('(');
+  out.write(name);
+  out.write(value ? " #t)" : " #f)", 4);
   return *this;
 }
 
@@ -76,7 +102,11 @@ FileWriter&
 FileWriter::write(const std::string& name, int value)
 {
   indent();
-  out << "(" << name << " " << value << ")";
+  out.put('(');
+  out.write(name);
+  out.put(' ');
+  out.write_int(value);
+  out.put(')');
   return *this;
 }
 
@@ -84,55 +114,91 @@ FileWriter&
 FileWriter::write(const std::string& name, float value)
 {
   indent();
-  out << "(" << name << " " << value << ")";
+  out.put('(');
+  out.write(name);
+  out.put(' ');
+  out.write_float(value);
+  out.put(')');
   return *this;
 }
 
-static
-std::string escape_string(const std::string& in)
+FileWriter&
+FileWriter::write(const std::string& name, const char* value)
 {
-  std::ostringstream str;
-  for(std::string::const_iterator i = in.begin(); i != in.end(); ++i)
-  {
-    if (*i == '"')
-      str << "\\\"";
-    else if (*i == '\\')
-      str << "\\\\";
-    else
-      str << *i;
-  }
-  return str.str();
+  indent();
+  out.put('(');
+  out.write(name);
+  out.put(' ');
+  write_escaped(value);
+  out.put(')');
+  return *this;
 }
 
 FileWriter&
-FileWriter::write(const std::string& name, const char* value)
+FileWriter::write(const std::string& name, const std::string& value)
+{
+  return write(name, value.c_str());
+}
+
+FileWriter&
+FileWriter::write(const std::string& name, const Color& value)
 {
   indent();
-  out << "(" << name << " \"" << escape_string(value) << "\")";
+  out.put('(');
+  out.write(name);
+  out.put(' ');
+  out.write_float(value.r);
+  out.put(' ');
+  out.write_float(value.g);
+  out.put(' ');
+  out.write_float(value.b);
+  out.put(' ');
+  out.write_float(value.a);
+  out.put(')');
   return *this;
 }
 
 FileWriter&
-FileWriter::write(const std::string& name, const std::string& value)
+FileWriter::write(const std::string& name, const Vector2f& value)
 {
   indent();
-  out << "(" << name << " \"" << escape_string(value) << "\")";
+  out.put('(');
+  out.write(name);
+  out.put(' ');
+  out.write_float(value.x);
+  out.put(' ');
+  out.write_float(value.y);
+  out.put(')');
   return *this;
 }
 
 FileWriter&
-FileWriter::write(const std::string& name, const Color& value)
+FileWriter::write(const std::string& name, const std::vector<int>& value)
 {
   indent();
-  out << "(" << name << " " << value.r << " " << value.g << " " << value.b << " " << value.a << ")";
+  out.put('(');
+  out.write(name);
+  for(std::vector<int>::const_iterator i = value.begin(); i != value.end(); ++i)
+  {
+    out.put(' ');
+    out.write_int(*i);
+  }
+  out.put(')');
   return *this;
 }
 
 FileWriter&
-FileWriter::write(const std::string& name, const Vector2f& value)
+FileWriter::write(const std::string& name, const std::vector<float>& value)
 {
   indent();
-  out << "(" << name << " " << value.x << " " << value.y << ")";
+  out.put('(');
+  out.write(name);
+  for(std::vector<float>::const_iterator i = value.begin(); i != value.end(); ++i)
+  {
+    out.put(' ');
+    out.write_float(*i);
+  }
+  out.put(')');
   return *this;
 }
 
@@ -19,21 +19,35 @@
 #ifndef HEADER_WINDSTILLE_UTIL_FILE_WRITER_HPP
 #define HEADER_WINDSTILLE_UTIL_FILE_WRITER_HPP
 
-class Color;
+#include <string>
+#include <vector>
+
 #include "math/vector2f.hpp"
+#include "util/output_buffer.hpp"
+
+class Color;
 
 class FileWriter
 {
 private:
-  std::ostream& out;
+  OutputBuffer out;
   int indent_count;
 
   void indent();
+  void write_escaped(const char* str);
 
 public:
   FileWriter(std::ostream& out);
+
+  /** Writes to a temporary file, \a filename only gets replaced by
+      commit(), throws std::runtime_error if it can't be created */
+  explicit FileWriter(const std::string& filename);
   ~FileWriter();
 
+  /** Flushes the output and moves the file into place, throws
+      std::runtime_error on failure */
+  void commit();
+
   FileWriter& write_raw(const std::string& value);
 
   FileWriter& start_section(const std::string& name);
@@ -46,6 +60,8 @@ public:
   FileWriter& write(const std::string& name, const char* value);
   FileWriter& write(const std::string& name, const Color& value);
   FileWriter& write(const std::string& name, const Vector2f& value);
+  FileWriter& write(const std::string& name, const std::vector<int>& value);
+  FileWriter& write(const std::string& name, const std::vector<float>& value);
 
 private:
   FileWriter(const FileWriter&);
@@ -23,17 +23,30 @@
 
 template<typename Data> class HandleManager;
 
+/**
+ * Refers to an object owned by a HandleManager. Unlike a plain
+ * pointer a Handle notices when the object is gone: each slot of the
+ * manager carries a magic number that changes when the object in it
+ * is released, so a stale Handle dereferences to 0.
+ */
 template<typename Data>
 class Handle
 {
 private:
-  HandleManager<Data>* manager;
+  const HandleManager<Data>* manager;
 
   unsigned int index;
   unsigned int magic;
 
 public:
-  Handle(HandleManager<Data>* manager_, 
+  Handle()
+    : manager(0),
+      index(0),
+      magic(0)
+  {
+  }
+
+  Handle(const HandleManager<Data>* manager_, 
          unsigned int index_,
          unsigned int magic_)
     : manager(manager_),
@@ -42,91 +55,193 @@ public:
   {
   }
 
-  bool is_null() {
-    return manager->dereference(index, magic) != 0;
+  unsigned int get_index() const { return index; }
+  unsigned int get_magic() const { return magic; }
+
+  /** Returns the object or 0 if the handle is null or stale */
+  Data* get() const {
+    return manager ? manager->dereference(*this) : 0;
+  }
+
+  Data* operator->() const {
+    return get();
+  }
+
+  Data& operator*() const {
+    return *get();
+  }
+
+  operator bool() const {
+    return get() != 0;
+  }
+
+  bool operator==(const Handle<Data>& rhs) const {
+    return manager == rhs.manager && index == rhs.index && magic == rhs.magic;
   }
 
-  Data* operator->() {
-    return manager->dereference(index, magic);
+  bool operator!=(const Handle<Data>& rhs) const {
+    return !(*this == rhs);
   }
 
-  Data& operator*() {
-    return manager->dereference(index, magic);
+  bool operator<(const Handle<Data>& rhs) const {
+    if (index != rhs.index)
+      return index < rhs.index;
+    else
+      return magic < rhs.magic;
   }
 };
 
+/**
+ * Owns objects of type \a Data and hands out Handles to them. Objects
+ * live in slots that are reused after release(), acquire(), release()
+ * and the validity check are all O(1). The live objects are also kept
+ * packed in get_data() for fast iteration, the order of that list
+ * changes when objects are released.
+ */
 template<typename Data>
 class HandleManager
 {
 private:
-  std::vector<Data>        data_lst;
-  std::vector<unsigned int> magic_lst;
+  struct Slot
+  {
+    Slot() : data(0), magic(0), packed(0) {}
 
-  /** List of indexes in \a data_lst and \a magic_lst that aren't
-      used */
-  std::vector<unsigned int>  free_list;
-  
-  unsigned int next_magic;
+    Data* data;
+    unsigned int magic;
+
+    /** position of the object in data_lst */
+    unsigned int packed;
+  };
+
+  std::vector<Slot> slot_lst;
+
+  /** Live objects and the slots they are in */
+  std::vector<Data*> data_lst;
+  std::vector<unsigned int> data_slot_lst;
+
+  /** List of indexes in \a slot_lst that aren't used */
+  std::vector<unsigned int> free_list;
 
 public:
-  HandleManager() 
-    : next_magic(0)
+  HandleManager()
+    : slot_lst(),
+      data_lst(),
+      data_slot_lst(),
+      free_list()
+  {
+  }
+
+  ~HandleManager()
   {
+    clear();
   }
   
-  Handle<Data> aquire(const Data& data)
+  /** Takes ownership of \a data */
+  Handle<Data> acquire(Data* data)
   {
+    unsigned int index;
     if (free_list.empty()) 
     {
-      data_lst.push_back(data);
-      magic_lst.push_back(next_magic);
-
-      return Handle<Data>(this, next_magic++);
+      index = static_cast<unsigned int>(slot_lst.size());
+      slot_lst.push_back(Slot());
     }
     else
     {
-      unsigned int index = free_list.back();
+      index = free_list.back();
       free_list.pop_back();
+    }
 
-      data_lst[index]  = data;
-      magic_lst[index] = next_magic;
+    Slot& slot = slot_lst[index];
+    slot.data   = data;
+    slot.packed = static_cast<unsigned int>(data_lst.size());
 
-      return Handle<Data>(this, next_magic++);
-    }
+    data_lst.push_back(data);
+    data_slot_lst.push_back(index);
+
+    return Handle<Data>(this, index, slot.magic);
   }
 
+  /** Deletes the object, all Handles to it become stale */
   void release(const Handle<Data>& handle)
   {
     if (valid(handle))
     {
-      delete data_lst[handle.index];
-      data_lst[handle.index] = 0;
+      Slot& slot = slot_lst[handle.get_index()];
+
+      // fill the gap in the packed list with its last entry
+      data_lst[slot.packed]      = data_lst.back();
+      data_slot_lst[slot.packed] = data_slot_lst.back();
+      slot_lst[data_slot_lst[slot.packed]].packed = slot.packed;
+      data_lst.pop_back();
+      data_slot_lst.pop_back();
+
+      delete slot.data;
+      slot.data   = 0;
+      slot.magic += 1;
 
-      free_list.push_back(handle.index);
+      free_list.push_back(handle.get_index());
     }
     else
     {
       // invalid handle
     }
   }
+
+  /** Deletes all objects */
+  void clear()
+  {
+    for(unsigned int i = 0; i < slot_lst.size(); ++i)
+    {
+      if (slot_lst[i].data)
+      {
+        delete slot_lst[i].data;
+        slot_lst[i].data   = 0;
+        slot_lst[i].magic += 1;
+        free_list.push_back(i);
+      }
+    }
+
+    data_lst.clear();
+    data_slot_lst.clear();
+  }
   
-  bool valid(const Handle<Data>& handle)
+  bool valid(const Handle<Data>& handle) const
   {
-    return (handle.index < data_lst.size() &&
-            magic_lst[handle.index] == handle.magic);
+    return (handle.get_index() < slot_lst.size() &&
+            slot_lst[handle.get_index()].data != 0 &&
+            slot_lst[handle.get_index()].magic == handle.get_magic());
   }
 
-  Data& dereference(const Handle<Data>& handle)
+  Data* dereference(const Handle<Data>& handle) const
   {
-    if (valid)
+    if (valid(handle))
     {
-      return data_lst[handle.index];
+      return slot_lst[handle.get_index()].data;
     }
     else
     {
-      // invalid handle
+      return 0;
     }
   }
+
+  /** Returns a Handle to the object in slot \a index, which is null
+      if the slot is unused */
+  Handle<Data> get_handle(unsigned int index) const
+  {
+    if (index < slot_lst.size() && slot_lst[index].data)
+      return Handle<Data>(this, index, slot_lst[index].magic);
+    else
+      return Handle<Data>();
+  }
+
+  /** Number of slots, used or not, slot indexes are below this */
+  unsigned int get_num_slots() const { return static_cast<unsigned int>(slot_lst.size()); }
+
+  const std::vector<Data*>& get_data() const { return data_lst; }
+
+private:
+  HandleManager(const HandleManager&);
+  HandleManager& operator=(const HandleManager&);
 };
 
 #endif
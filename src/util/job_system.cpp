@@ -0,0 +1,218 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "util/job_system.hpp"
+
+#include <iostream>
+
+JobSystem::Queue::Queue() :
+  mutex(SDL_CreateMutex()),
+  jobs()
+{
+}
+
+JobSystem::Queue::~Queue()
+{
+  SDL_DestroyMutex(mutex);
+}
+
+JobSystem::JobSystem(int num_threads) :
+  m_queues(),
+  m_workers(),
+  m_sleep_mutex(SDL_CreateMutex()),
+  m_sleep_cond(SDL_CreateCond()),
+  m_quit(false),
+  m_queued(),
+  m_pending(),
+  m_next_queue(0)
+{
+  SDL_AtomicSet(&m_queued, 0);
+  SDL_AtomicSet(&m_pending, 0);
+
+  if (num_threads < 0)
+  {
+    num_threads = SDL_GetCPUCount() - 1;
+  }
+
+  m_queues.push_back(boost::shared_ptr<Queue>(new Queue));
+
+  // the workers get pointers into m_workers, so it must not be
+  // resized once the threads are running
+  m_workers.reserve(static_cast<size_t>(num_threads));
+  for(int i = 0; i < num_threads; ++i)
+  {
+    m_queues.push_back(boost::shared_ptr<Queue>(new Queue));
+
+    Worker worker;
+    worker.system = this;
+    worker.index  = i + 1;
+    m_workers.push_back(worker);
+  }
+
+  for(std::vector<Worker>::iterator i = m_workers.begin(); i != m_workers.end(); ++i)
+  {
+    i->thread = SDL_CreateThread(&JobSystem::worker_main, "JobSystem", &*i);
+    if (!i->thread)
+    {
+      std::cout << "JobSystem: couldn't create worker thread: " << SDL_GetError() << std::endl;
+    }
+  }
+}
+
+JobSystem::~JobSystem()
+{
+  SDL_LockMutex(m_sleep_mutex);
+  m_quit = true;
+  SDL_CondBroadcast(m_sleep_cond);
+  SDL_UnlockMutex(m_sleep_mutex);
+
+  for(std::vector<Worker>::iterator i = m_workers.begin(); i != m_workers.end(); ++i)
+  {
+    if (i->thread)
+    {
+      SDL_WaitThread(i->thread, 0);
+    }
+  }
+
+  SDL_DestroyCond(m_sleep_cond);
+  SDL_DestroyMutex(m_sleep_mutex);
+}
+
+void
+JobSystem::push(Job* job)
+{
+  SDL_AtomicAdd(&m_pending, 1);
+
+  Queue& queue = *m_queues[static_cast<size_t>(m_next_queue)];
+  m_next_queue = (m_next_queue + 1) % static_cast<int>(m_queues.size());
+
+  SDL_LockMutex(queue.mutex);
+  queue.jobs.push_back(job);
+  SDL_UnlockMutex(queue.mutex);
+
+  // m_queued is raised while holding the sleep mutex, so a worker
+  // can't miss the wakeup between checking it and going to sleep
+  SDL_LockMutex(m_sleep_mutex);
+  SDL_AtomicAdd(&m_queued, 1);
+  SDL_CondSignal(m_sleep_cond);
+  SDL_UnlockMutex(m_sleep_mutex);
+}
+
+void
+JobSystem::wait()
+{
+  while(SDL_AtomicGet(&m_pending) > 0)
+  {
+    // once the queues are empty the remaining jobs are already being
+    // worked on, so just spin until the workers are done with them
+    run_one(0);
+  }
+}
+
+bool
+JobSystem::run_one(int index)
+{
+  Job* job = pop(index);
+  if (!job)
+  {
+    job = steal(index);
+  }
+
+  if (!job)
+  {
+    return false;
+  }
+  else
+  {
+    SDL_AtomicAdd(&m_queued, -1);
+    job->run();
+    SDL_AtomicAdd(&m_pending, -1);
+    return true;
+  }
+}
+
+Job*
+JobSystem::pop(int index)
+{
+  Queue& queue = *m_queues[static_cast<size_t>(index)];
+  Job* job = 0;
+
+  SDL_LockMutex(queue.mutex);
+  if (!queue.jobs.empty())
+  {
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+  }
+  SDL_UnlockMutex(queue.mutex);
+
+  return job;
+}
+
+Job*
+JobSystem::steal(int index)
+{
+  const int num_queues = static_cast<int>(m_queues.size());
+  for(int i = 1; i < num_queues; ++i)
+  {
+    Queue& queue = *m_queues[static_cast<size_t>((index + i) % num_queues)];
+    Job* job = 0;
+
+    SDL_LockMutex(queue.mutex);
+    if (!queue.jobs.empty())
+    {
+      job = queue.jobs.front();
+      queue.jobs.pop_front();
+    }
+    SDL_UnlockMutex(queue.mutex);
+
+    if (job)
+    {
+      return job;
+    }
+  }
+
+  return 0;
+}
+
+int
+JobSystem::worker_main(void* data)
+{
+  Worker& worker = *static_cast<Worker*>(data);
+  JobSystem& system = *worker.system;
+
+  while(true)
+  {
+    if (!system.run_one(worker.index))
+    {
+      SDL_LockMutex(system.m_sleep_mutex);
+      while(!system.m_quit && SDL_AtomicGet(&system.m_queued) <= 0)
+      {
+        SDL_CondWait(system.m_sleep_cond, system.m_sleep_mutex);
+      }
+      const bool quit = system.m_quit;
+      SDL_UnlockMutex(system.m_sleep_mutex);
+
+      if (quit)
+      {
+        return 0;
+      }
+    }
+  }
+}
+
+/* EOF */
@@ -0,0 +1,124 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_UTIL_JOB_SYSTEM_HPP
+#define HEADER_WINDSTILLE_UTIL_JOB_SYSTEM_HPP
+
+#include <SDL.h>
+#include <boost/shared_ptr.hpp>
+#include <deque>
+#include <vector>
+
+#include "util/currenton.hpp"
+
+/** A unit of work for the JobSystem, run() is called from an
+    arbitrary thread and must not throw */
+class Job
+{
+public:
+  virtual ~Job() {}
+  virtual void run() =0;
+};
+
+/**
+ * A pool of worker threads with one job queue per thread. Jobs are
+ * distributed over the queues round robin, each worker takes jobs
+ * from the back of its own queue and steals from the front of the
+ * others once it runs dry. The thread calling wait() works on its
+ * own queue as well, so with zero worker threads everything simply
+ * runs serially in wait().
+ *
+ * push() and wait() must only be called from the main thread.
+ */
+class JobSystem : public Currenton<JobSystem>
+{
+private:
+  struct Queue
+  {
+    Queue();
+    ~Queue();
+
+    SDL_mutex* mutex;
+    std::deque<Job*> jobs;
+
+  private:
+    Queue(const Queue&);
+    Queue& operator=(const Queue&);
+  };
+
+  struct Worker
+  {
+    Worker() : system(0), index(0), thread(0) {}
+
+    JobSystem* system;
+    int index;
+    SDL_Thread* thread;
+  };
+
+  /** queue 0 belongs to the thread calling wait(), the others to the
+      workers */
+  std::vector<boost::shared_ptr<Queue> > m_queues;
+  std::vector<Worker> m_workers;
+
+  /** idle workers sleep on this until new jobs get pushed */
+  SDL_mutex* m_sleep_mutex;
+  SDL_cond*  m_sleep_cond;
+  bool m_quit;
+
+  /** number of jobs sitting in the queues */
+  SDL_atomic_t m_queued;
+
+  /** number of jobs pushed but not yet finished */
+  SDL_atomic_t m_pending;
+
+  int m_next_queue;
+
+public:
+  /** Starts \a num_threads worker threads, a negative value starts
+      one less than there are CPUs, as the main thread helps out in
+      wait() */
+  JobSystem(int num_threads = -1);
+  ~JobSystem();
+
+  int get_num_threads() const { return static_cast<int>(m_workers.size()); }
+
+  /** Queues \a job for execution, the job is not owned by the
+      JobSystem and has to stay alive until wait() returns */
+  void push(Job* job);
+
+  /** Runs jobs until all pushed jobs are finished */
+  void wait();
+
+private:
+  /** Takes a job from queue \a index or steals one from another queue
+      and runs it, returns false if there was nothing to do */
+  bool run_one(int index);
+
+  Job* pop(int index);
+  Job* steal(int index);
+
+  static int worker_main(void* data);
+
+private:
+  JobSystem(const JobSystem&);
+  JobSystem& operator=(const JobSystem&);
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,140 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "util/mapped_file.hpp"
+
+#include <errno.h>
+#include <string.h>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#  include <fstream>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+MappedFilePtr
+MappedFile::open(const std::string& filename)
+{
+  return MappedFilePtr(new MappedFile(filename));
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filename) :
+  m_data(0),
+  m_size(0),
+  m_buffer()
+{
+  std::ifstream in(filename.c_str(), std::ios::binary);
+  if (!in)
+  {
+    throw std::runtime_error("MappedFile: couldn't open " + filename);
+  }
+  else
+  {
+    in.seekg(0, std::ios::end);
+    m_size = static_cast<size_t>(in.tellg());
+    in.seekg(0, std::ios::beg);
+
+    // always allocate at least one byte so that get_data() is never 0
+    m_buffer.reset(new char[m_size + 1]);
+    m_data = m_buffer.get();
+    m_data[m_size] = '\0';
+
+    if (!in.read(m_data, static_cast<std::streamsize>(m_size)))
+    {
+      throw std::runtime_error("MappedFile: couldn't read " + filename);
+    }
+  }
+}
+
+MappedFile::~MappedFile()
+{
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename) :
+  m_data(0),
+  m_size(0),
+  m_buffer()
+{
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    std::ostringstream str;
+    str << "MappedFile: couldn't open " << filename << ": " << strerror(errno);
+    throw std::runtime_error(str.str());
+  }
+  else
+  {
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+      std::ostringstream str;
+      str << "MappedFile: couldn't stat " << filename << ": " << strerror(errno);
+      close(fd);
+      throw std::runtime_error(str.str());
+    }
+    else
+    {
+      m_size = static_cast<size_t>(st.st_size);
+
+      if (m_size == 0)
+      { // mmap() refuses zero sized mappings
+        m_buffer.reset(new char[1]);
+        m_data = m_buffer.get();
+        m_data[0] = '\0';
+        close(fd);
+      }
+      else
+      {
+        void* data = mmap(0, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (data == MAP_FAILED)
+        {
+          std::ostringstream str;
+          str << "MappedFile: couldn't mmap " << filename << ": " << strerror(errno);
+          throw std::runtime_error(str.str());
+        }
+        else
+        {
+          m_data = static_cast<char*>(data);
+        }
+      }
+    }
+  }
+}
+
+MappedFile::~MappedFile()
+{
+  if (!m_buffer)
+  {
+    munmap(m_data, m_size);
+  }
+}
+
+#endif
+
+/* EOF */
@@ -0,0 +1,63 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_UTIL_MAPPED_FILE_HPP
+#define HEADER_WINDSTILLE_UTIL_MAPPED_FILE_HPP
+
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_array.hpp>
+#include <string>
+
+class MappedFile;
+typedef boost::shared_ptr<MappedFile> MappedFilePtr;
+
+/**
+ * Maps the complete content of a file into memory. Writes to the
+ * memory are private to the process and never reach the file. On
+ * platforms without mmap() the file is read into a buffer instead.
+ */
+class MappedFile
+{
+public:
+  /** Throws std::runtime_error when the file can't be opened */
+  static MappedFilePtr open(const std::string& filename);
+
+private:
+  MappedFile(const std::string& filename);
+
+public:
+  ~MappedFile();
+
+  char*  get_data() const { return m_data; }
+  size_t get_size() const { return m_size; }
+
+private:
+  char*  m_data;
+  size_t m_size;
+
+  /** only used when mmap() isn't available */
+  boost::scoped_array<char> m_buffer;
+
+private:
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+};
+
+#endif
+
+/* EOF */
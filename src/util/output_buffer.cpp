@@ -0,0 +1,339 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "util/output_buffer.hpp"
+
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <ostream>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/system.hpp"
+
+namespace {
+
+const size_t buffer_size = 64 * 1024;
+
+// exactly representable, same as in Lexer::getReal()
+const float powers_of_ten[] = {
+  1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+size_t format_uint(unsigned int value, char* out)
+{
+  char digits[16];
+  size_t len = 0;
+  do
+  {
+    digits[len++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  while(value != 0);
+
+  for(size_t i = 0; i < len; ++i)
+    out[i] = digits[len - 1 - i];
+  return len;
+}
+
+/** Writes \a mantissa / 10^\a decimals in fixed notation */
+size_t format_fixed(unsigned int mantissa, int decimals, char* out)
+{
+  char digits[16];
+  int len = 0;
+  do
+  {
+    digits[len++] = static_cast<char>('0' + mantissa % 10);
+    mantissa /= 10;
+  }
+  while(mantissa != 0 || len <= decimals);
+
+  char* p = out;
+  for(int i = len - 1; i >= 0; --i)
+  {
+    if (i == decimals - 1)
+      *p++ = '.';
+    *p++ = digits[i];
+  }
+  return static_cast<size_t>(p - out);
+}
+
+} // namespace
+
+OutputBuffer::OutputBuffer(std::ostream& out) :
+  m_stream(&out),
+  m_file(0),
+  m_filename(),
+  m_tmp_filename(),
+  m_failed(false),
+  m_buffer(buffer_size),
+  m_used(0)
+{
+}
+
+OutputBuffer::OutputBuffer(const std::string& filename) :
+  m_stream(0),
+  m_file(0),
+  m_filename(filename),
+  m_tmp_filename(),
+  m_failed(false),
+  m_buffer(buffer_size),
+  m_used(0)
+{
+  // a unique name, so that two writers of the same file don't share
+  // one temporary file
+  m_file = System::create_temp_file(filename, m_tmp_filename);
+  if (!m_file)
+  {
+    throw std::runtime_error("OutputBuffer: couldn't create a temporary file for " + filename + ": " + strerror(errno));
+  }
+}
+
+OutputBuffer::~OutputBuffer()
+{
+  if (m_stream)
+  {
+    flush_buffer();
+  }
+  else
+  {
+    discard();
+  }
+}
+
+void
+OutputBuffer::write(const char* data, size_t len)
+{
+  if (len > m_buffer.size() - m_used)
+  {
+    flush_buffer();
+    if (len > m_buffer.size())
+    { // too big to be worth copying
+      if (m_stream)
+        m_stream->write(data, static_cast<std::streamsize>(len));
+      else if (m_file && fwrite(data, 1, len, m_file) != len)
+        m_failed = true;
+      return;
+    }
+  }
+
+  memcpy(&m_buffer[m_used], data, len);
+  m_used += len;
+}
+
+void
+OutputBuffer::write_int(int value)
+{
+  if (value < 0)
+  {
+    put('-');
+    // negated as unsigned, so that INT_MIN doesn't overflow
+    write_uint(0u - static_cast<unsigned int>(value));
+  }
+  else
+  {
+    write_uint(static_cast<unsigned int>(value));
+  }
+}
+
+void
+OutputBuffer::write_uint(unsigned int value)
+{
+  if (m_buffer.size() - m_used < 16)
+    flush_buffer();
+  m_used += format_uint(value, &m_buffer[m_used]);
+}
+
+void
+OutputBuffer::write_float(float value)
+{
+  if (m_buffer.size() - m_used < 64)
+    flush_buffer();
+  m_used += format_float(value, &m_buffer[m_used]);
+}
+
+size_t
+OutputBuffer::format_float(float value, char* out)
+{
+  char* p = out;
+
+  if (value != value || value > FLT_MAX || value < -FLT_MAX || value == 0.0f)
+  { // nan and inf can't be read back, write them as zero
+    *p++ = '0';
+    return 1;
+  }
+
+  if (value < 0.0f)
+  {
+    *p++ = '-';
+    value = -value;
+  }
+
+  if (value < 2147483648.0f && value == floorf(value))
+  {
+    p += format_uint(static_cast<unsigned int>(value), p);
+    return static_cast<size_t>(p - out);
+  }
+
+  // As long as the digits fit into 24 bits the lexer reads the number
+  // back with a single float division, so the same division tells
+  // whether a given number of decimals is enough.
+  for(int decimals = 1; decimals <= 10; ++decimals)
+  {
+    const double scaled = static_cast<double>(value) * static_cast<double>(powers_of_ten[decimals]);
+    if (scaled >= 16777216.0)
+      break;
+
+    const double mantissa = floor(scaled + 0.5);
+    if (static_cast<float>(mantissa) / powers_of_ten[decimals] == value)
+    {
+      p += format_fixed(static_cast<unsigned int>(mantissa), decimals, p);
+      return static_cast<size_t>(p - out);
+    }
+  }
+
+  // very small or very large numbers, the lexer uses sscanf() for
+  // these, so find the fewest significant digits that sscanf() reads
+  // back correctly, nine are always enough for a float
+  char scientific[32];
+  for(int precision = 0; precision <= 8; ++precision)
+  {
+    sprintf(scientific, "%.*e", precision, static_cast<double>(value));
+
+    float check = 0.0f;
+    if (sscanf(scientific, "%f", &check) == 1 && check == value)
+      break;
+  }
+
+  // and spell them out in fixed notation
+  char digits[16];
+  int num_digits = 0;
+  const char* s = scientific;
+  for(; *s != 'e'; ++s)
+  {
+    if (*s != '.')
+      digits[num_digits++] = *s;
+  }
+  const int exponent = atoi(s + 1);
+
+  if (exponent < 0)
+  {
+    *p++ = '0';
+    *p++ = '.';
+    for(int i = exponent + 1; i < 0; ++i)
+      *p++ = '0';
+    for(int i = 0; i < num_digits; ++i)
+      *p++ = digits[i];
+  }
+  else
+  {
+    for(int i = 0; i <= exponent; ++i)
+      *p++ = (i < num_digits) ? digits[i] : '0';
+    *p++ = '.';
+    if (exponent + 1 < num_digits)
+    {
+      for(int i = exponent + 1; i < num_digits; ++i)
+        *p++ = digits[i];
+    }
+    else
+    { // keep it a float for the lexer
+      *p++ = '0';
+    }
+  }
+
+  return static_cast<size_t>(p - out);
+}
+
+void
+OutputBuffer::flush_buffer()
+{
+  if (m_used == 0)
+    return;
+
+  if (m_stream)
+  {
+    m_stream->write(&m_buffer[0], static_cast<std::streamsize>(m_used));
+  }
+  else if (m_file)
+  {
+    if (fwrite(&m_buffer[0], 1, m_used, m_file) != m_used)
+      m_failed = true;
+  }
+
+  m_used = 0;
+}
+
+void
+OutputBuffer::flush()
+{
+  flush_buffer();
+
+  if (m_stream)
+    m_stream->flush();
+  else if (m_file && fflush(m_file) != 0)
+    m_failed = true;
+}
+
+void
+OutputBuffer::commit()
+{
+  flush_buffer();
+
+  if (m_stream)
+  {
+    m_stream->flush();
+  }
+  else if (m_file)
+  {
+    bool success = !m_failed;
+    success = (fclose(m_file) == 0) && success;
+    m_file = 0;
+
+    if (success)
+    {
+#ifdef _WIN32
+      // rename() doesn't replace existing files on Windows
+      remove(m_filename.c_str());
+#endif
+      success = (rename(m_tmp_filename.c_str(), m_filename.c_str()) == 0);
+    }
+
+    if (!success)
+    {
+      const std::string error = strerror(errno);
+      remove(m_tmp_filename.c_str());
+      throw std::runtime_error("OutputBuffer: couldn't write " + m_filename + ": " + error);
+    }
+  }
+}
+
+void
+OutputBuffer::discard()
+{
+  if (m_file)
+  {
+    fclose(m_file);
+    m_file = 0;
+    remove(m_tmp_filename.c_str());
+  }
+}
+
+/* EOF */
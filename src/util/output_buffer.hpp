@@ -0,0 +1,100 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef HEADER_WINDSTILLE_UTIL_OUTPUT_BUFFER_HPP
+#define HEADER_WINDSTILLE_UTIL_OUTPUT_BUFFER_HPP
+
+#include <iosfwd>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/**
+ * Buffered text output for the s-expression writers, numbers are
+ * formatted by hand instead of going through iostreams.
+ *
+ * Floats are written with the fewest decimals that read back to the
+ * same value and never in exponent notation, which the lexer would
+ * take for a symbol.
+ *
+ * When constructed with a filename the output goes to a temporary file
+ * next to it, commit() then replaces the file in one step, so a crash
+ * while writing never leaves a truncated file behind. Without commit()
+ * the temporary file is thrown away.
+ */
+class OutputBuffer
+{
+private:
+  std::ostream* m_stream;
+  FILE* m_file;
+  std::string m_filename;
+  std::string m_tmp_filename;
+  bool m_failed;
+
+  std::vector<char> m_buffer;
+  size_t m_used;
+
+public:
+  /** Writes to \a out, commit() and flush() only flush the buffer */
+  explicit OutputBuffer(std::ostream& out);
+
+  /** Writes to a temporary file that replaces \a filename on commit(),
+      throws std::runtime_error if the file can't be created */
+  explicit OutputBuffer(const std::string& filename);
+
+  ~OutputBuffer();
+
+  void put(char c)
+  {
+    if (m_used == m_buffer.size())
+      flush_buffer();
+    m_buffer[m_used++] = c;
+  }
+
+  void write(const char* data, size_t len);
+  void write(const std::string& str) { write(str.data(), str.size()); }
+
+  void write_int(int value);
+  void write_uint(unsigned int value);
+  void write_float(float value);
+
+  /** Passes the buffered data on to the stream or file */
+  void flush();
+
+  /** Flushes and, when writing to a file, moves the temporary file
+      into place, throws std::runtime_error on failure */
+  void commit();
+
+  /** Writes the shortest representation of \a value that reads back
+      the same into \a out, which must hold at least 64 chars, returns
+      the length */
+  static size_t format_float(float value, char* out);
+
+private:
+  void flush_buffer();
+  void discard();
+
+private:
+  OutputBuffer(const OutputBuffer&);
+  OutputBuffer& operator=(const OutputBuffer&);
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,385 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "util/profiler.hpp"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <time.h>
+#endif
+
+#include "util/pathname.hpp"
+
+namespace {
+
+const int kMaxEvents = 4096;
+const int kMaxDepth  = 64;
+
+struct Event
+{
+  const char* name;
+  int64_t begin;
+  int64_t end;
+  int depth;
+};
+
+struct OpenScope
+{
+  const char* name;
+  int64_t begin;
+};
+
+/** Owned and written by a single thread, read by frame_end() */
+struct ThreadLog
+{
+  ThreadLog() :
+    tid(0),
+    generation(0),
+    count(0),
+    depth(0),
+    next(0)
+  {}
+
+  int tid;
+  unsigned int generation;
+
+  /** number of completed events, only grows within a generation */
+  volatile int count;
+  Event events[kMaxEvents];
+
+  int depth;
+  OpenScope stack[kMaxDepth];
+
+  ThreadLog* next;
+
+private:
+  ThreadLog(const ThreadLog&);
+  ThreadLog& operator=(const ThreadLog&);
+};
+
+struct TraceEvent
+{
+  const char* name;
+  int tid;
+  int64_t begin;
+  int64_t end;
+};
+
+bool less_begin(const Event& lhs, const Event& rhs)
+{
+  if (lhs.begin != rhs.begin)
+    return lhs.begin < rhs.begin;
+  else
+    return lhs.depth < rhs.depth;
+}
+
+/** Every thread that ever recorded a marker, new logs are pushed to
+    the front and never removed */
+ThreadLog* volatile s_logs = 0;
+volatile int s_next_tid = 0;
+
+/** Increases with every frame_end(), logs from an older generation
+    are reset by their thread before recording */
+volatile unsigned int s_generation = 1;
+
+__thread ThreadLog* t_log = 0;
+
+bool s_overlay_enabled = false;
+int  s_capture_frames  = 0;
+bool s_capture_complete = false;
+std::vector<TraceEvent> s_trace;
+
+std::vector<ProfilerNode> s_nodes;
+std::map<std::string, float> s_smoothed;
+
+ThreadLog* get_log()
+{
+  if (!t_log)
+  {
+    t_log = new ThreadLog;
+    t_log->tid = __sync_fetch_and_add(&s_next_tid, 1);
+
+    ThreadLog* head;
+    do
+    {
+      head = s_logs;
+      t_log->next = head;
+    }
+    while(!__sync_bool_compare_and_swap(&s_logs, head, t_log));
+  }
+
+  if (t_log->generation != s_generation)
+  {
+    // scopes still open stay on the stack, only finished events are dropped
+    t_log->count = 0;
+    t_log->generation = s_generation;
+  }
+
+  return t_log;
+}
+
+void write_json_string(std::ostream& out, const char* str)
+{
+  out << '"';
+  for(const char* c = str; *c; ++c)
+  {
+    if (*c == '"' || *c == '\\')
+      out << '\\';
+    out << *c;
+  }
+  out << '"';
+}
+
+} // namespace
+
+bool Profiler::s_enabled = false;
+
+void
+Profiler::set_overlay_enabled(bool enabled)
+{
+  s_overlay_enabled = enabled;
+  update_enabled();
+}
+
+void
+Profiler::update_enabled()
+{
+  s_enabled = s_overlay_enabled || s_capture_frames > 0;
+}
+
+int64_t
+Profiler::get_time()
+{
+#ifdef _WIN32
+  LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return static_cast<int64_t>(static_cast<double>(counter.QuadPart) * 1.0e9 /
+                              static_cast<double>(frequency.QuadPart));
+#else
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+void
+Profiler::begin(const char* name)
+{
+  ThreadLog* log = get_log();
+
+  if (log->depth < kMaxDepth)
+  {
+    log->stack[log->depth].name  = name;
+    log->stack[log->depth].begin = get_time();
+  }
+
+  log->depth += 1;
+}
+
+void
+Profiler::end()
+{
+  ThreadLog* log = get_log();
+
+  log->depth -= 1;
+
+  if (log->depth < kMaxDepth && log->count < kMaxEvents)
+  {
+    Event& event = log->events[log->count];
+    event.name  = log->stack[log->depth].name;
+    event.begin = log->stack[log->depth].begin;
+    event.end   = get_time();
+    event.depth = log->depth;
+
+    // make the event visible to frame_end() only once it is complete
+    __sync_synchronize();
+    log->count = log->count + 1;
+  }
+}
+
+void
+Profiler::frame_end()
+{
+  ThreadLog* main_log = get_log();
+  std::vector<Event> frame;
+
+  for(ThreadLog* log = s_logs; log; log = log->next)
+  {
+    if (log->generation == s_generation)
+    {
+      const int count = log->count;
+      __sync_synchronize();
+
+      if (log == main_log && s_overlay_enabled)
+      {
+        frame.assign(log->events, log->events + count);
+      }
+
+      if (s_capture_frames > 0)
+      {
+        for(int i = 0; i < count; ++i)
+        {
+          TraceEvent event;
+          event.name  = log->events[i].name;
+          event.tid   = log->tid;
+          event.begin = log->events[i].begin;
+          event.end   = log->events[i].end;
+          s_trace.push_back(event);
+        }
+      }
+    }
+  }
+
+  __sync_fetch_and_add(&s_generation, 1);
+
+  if (s_capture_frames > 0)
+  {
+    s_capture_frames -= 1;
+    if (s_capture_frames == 0)
+    {
+      s_capture_complete = true;
+    }
+  }
+
+  update_enabled();
+
+  // Turn the events into a list of nodes in the order they were
+  // entered, markers entered multiple times under the same parent are
+  // merged into a single node
+  std::stable_sort(frame.begin(), frame.end(), less_begin);
+
+  std::vector<ProfilerNode> nodes;
+  std::map<std::string, size_t> node_index;
+  std::vector<std::string> path(kMaxDepth);
+
+  for(std::vector<Event>::iterator i = frame.begin(); i != frame.end(); ++i)
+  {
+    path[i->depth] = (i->depth > 0 ? path[i->depth - 1] + "/" : std::string()) + i->name;
+
+    const float msec = static_cast<float>(i->end - i->begin) / 1.0e6f;
+
+    std::map<std::string, size_t>::iterator it = node_index.find(path[i->depth]);
+    if (it == node_index.end())
+    {
+      ProfilerNode node;
+      node.name  = i->name;
+      node.depth = i->depth;
+      node.msec  = msec;
+      node.calls = 1;
+
+      node_index[path[i->depth]] = nodes.size();
+      nodes.push_back(node);
+    }
+    else
+    {
+      nodes[it->second].msec  += msec;
+      nodes[it->second].calls += 1;
+    }
+  }
+
+  std::map<std::string, float> smoothed;
+  for(std::map<std::string, size_t>::iterator i = node_index.begin(); i != node_index.end(); ++i)
+  {
+    ProfilerNode& node = nodes[i->second];
+
+    std::map<std::string, float>::iterator old = s_smoothed.find(i->first);
+    if (old != s_smoothed.end())
+    {
+      node.msec = 0.9f * old->second + 0.1f * node.msec;
+    }
+
+    smoothed[i->first] = node.msec;
+  }
+
+  s_smoothed.swap(smoothed);
+  s_nodes.swap(nodes);
+}
+
+const std::vector<ProfilerNode>&
+Profiler::get_nodes()
+{
+  return s_nodes;
+}
+
+void
+Profiler::start_capture(int frames)
+{
+  s_trace.clear();
+  s_capture_frames   = frames;
+  s_capture_complete = false;
+  update_enabled();
+}
+
+bool
+Profiler::is_capture_complete()
+{
+  return s_capture_complete;
+}
+
+void
+Profiler::write_trace(const Pathname& filename)
+{
+  boost::filesystem::create_directories(boost::filesystem::path(filename.get_sys_path()).parent_path());
+
+  std::ofstream out(filename.get_sys_path().c_str());
+  if (!out)
+  {
+    throw std::runtime_error("Profiler::write_trace(): couldn't open " + filename.get_sys_path());
+  }
+  else
+  {
+    int64_t start = s_trace.empty() ? 0 : s_trace.front().begin;
+    for(std::vector<TraceEvent>::iterator i = s_trace.begin(); i != s_trace.end(); ++i)
+    {
+      start = std::min(start, i->begin);
+    }
+
+    out.setf(std::ios::fixed);
+    out.precision(3);
+
+    out << "{\"traceEvents\":[\n";
+    for(std::vector<TraceEvent>::iterator i = s_trace.begin(); i != s_trace.end(); ++i)
+    {
+      if (i != s_trace.begin())
+        out << ",\n";
+
+      // timestamps are in microseconds
+      out << "{\"name\":";
+      write_json_string(out, i->name);
+      out << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" << i->tid
+          << ",\"ts\":" << static_cast<double>(i->begin - start) / 1000.0
+          << ",\"dur\":" << static_cast<double>(i->end - i->begin) / 1000.0
+          << "}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    s_trace.clear();
+    s_capture_complete = false;
+  }
+}
+
+/* EOF */
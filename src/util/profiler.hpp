@@ -0,0 +1,121 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEADER_WINDSTILLE_UTIL_PROFILER_HPP
+#define HEADER_WINDSTILLE_UTIL_PROFILER_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class Pathname;
+
+struct ProfilerNode
+{
+  ProfilerNode() :
+    name(), depth(0), msec(0.0f), calls(0)
+  {}
+
+  std::string name;
+
+  /** nesting level, 0 for top level markers */
+  int depth;
+
+  /** time spent in the marker per frame, smoothed over several frames */
+  float msec;
+
+  /** number of times the marker was entered in the last frame */
+  int calls;
+};
+
+/**
+ * Collects nested CPU timings marked with ProfileScope. Each thread
+ * records into its own buffer without locking, the main loop calls
+ * frame_end() once per frame to gather the markers of the frame for
+ * the overlay and, while a capture is running, for a Chrome trace
+ * ("chrome://tracing") written by write_trace(). Markers are only
+ * recorded while the overlay is enabled or a capture is running.
+ */
+class Profiler
+{
+private:
+  static bool s_enabled;
+
+public:
+  static bool is_enabled() { return s_enabled; }
+
+  /** Start or stop collecting the per frame statistics returned by
+      get_nodes() */
+  static void set_overlay_enabled(bool enabled);
+
+  /** \a name must stay valid for the lifetime of the program,
+      i.e. be a string literal */
+  static void begin(const char* name);
+  static void end();
+
+  /** Gathers the markers recorded since the last call, must be
+      called from the main thread outside of any ProfileScope */
+  static void frame_end();
+
+  /** Markers of the main thread in the order they were entered in
+      the last frame */
+  static const std::vector<ProfilerNode>& get_nodes();
+
+  /** Records all markers of all threads for the next \a frames frames */
+  static void start_capture(int frames);
+  static bool is_capture_complete();
+
+  /** Writes the captured markers as Chrome trace JSON and discards
+      them, throws std::runtime_error on failure */
+  static void write_trace(const Pathname& filename);
+
+  /** Monotonic time in nanoseconds */
+  static int64_t get_time();
+
+private:
+  static void update_enabled();
+};
+
+/** Records the time between its construction and destruction */
+class ProfileScope
+{
+private:
+  bool m_active;
+
+public:
+  ProfileScope(const char* name) :
+    m_active(Profiler::is_enabled())
+  {
+    if (m_active)
+      Profiler::begin(name);
+  }
+
+  ~ProfileScope()
+  {
+    if (m_active)
+      Profiler::end();
+  }
+
+private:
+  ProfileScope(const ProfileScope&);
+  ProfileScope& operator=(const ProfileScope&);
+};
+
+#endif
+
+/* EOF */
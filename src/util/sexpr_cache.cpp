@@ -0,0 +1,211 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "util/sexpr_cache.hpp"
+
+#include <boost/filesystem.hpp>
+#include <errno.h>
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "lisp/binary_format.hpp"
+#include "util/mapped_file.hpp"
+#include "util/system.hpp"
+
+namespace {
+
+const char     cache_magic[8]    = { 'W', 'S', 'T', 'S', 'E', 'X', 'P', '\0' };
+const uint32_t cache_version     = 1;
+const uint32_t cache_byte_order  = 0x01020304;
+
+struct CacheHeader
+{
+  char     magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+
+  uint32_t source_hash;
+  uint32_t source_size;
+
+  /** length of the source path that follows the header */
+  uint32_t path_length;
+
+  /** size of the tree that follows the path */
+  uint32_t data_size;
+};
+
+/** FNV-1a, hashing the text is still far cheaper than parsing it */
+uint32_t hash_source(const char* data, size_t size)
+{
+  uint32_t hash = 2166136261U;
+  for(size_t i = 0; i < size; ++i)
+  {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+} // namespace
+
+bool SExprCache::s_enabled = false;
+
+void
+SExprCache::set_enabled(bool enabled)
+{
+  s_enabled = enabled;
+}
+
+bool
+SExprCache::is_enabled()
+{
+  return s_enabled;
+}
+
+Pathname
+SExprCache::get_cache_filename(const Pathname& filename)
+{
+  std::string name;
+  switch(filename.get_type())
+  {
+    case Pathname::kDataPath: name = "data"; break;
+    case Pathname::kUserPath: name = "user"; break;
+    default:                  name = "sys";  break;
+  }
+
+  name += System::flatten_path(filename.get_raw_path());
+
+  return Pathname("cache/sexpr/" + name + ".bin", Pathname::kUserPath);
+}
+
+lisp::Lisp*
+SExprCache::load(const Pathname& filename, const char* data, size_t size,
+                 lisp::Arena& arena)
+{
+  const Pathname cache_filename = get_cache_filename(filename);
+  if (!cache_filename.exists())
+  {
+    return 0;
+  }
+  else
+  {
+    MappedFilePtr mapping;
+    try
+    {
+      mapping = MappedFile::open(cache_filename.get_sys_path());
+    }
+    catch(const std::exception& err)
+    {
+      std::cout << "SExprCache: " << err.what() << std::endl;
+      return 0;
+    }
+
+    if (mapping->get_size() < sizeof(CacheHeader))
+    {
+      return 0;
+    }
+    else
+    {
+      CacheHeader header;
+      memcpy(&header, mapping->get_data(), sizeof(header));
+
+      const std::string source_path = filename.get_sys_path();
+
+      if (memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 ||
+          header.version     != cache_version ||
+          header.byte_order  != cache_byte_order ||
+          header.source_size != size ||
+          mapping->get_size() != sizeof(header) + header.path_length + header.data_size ||
+          source_path.compare(0, std::string::npos,
+                              mapping->get_data() + sizeof(header), header.path_length) != 0 ||
+          header.source_hash != hash_source(data, size))
+      { // stale or foreign cache entry
+        return 0;
+      }
+      else
+      {
+        return lisp::BinaryFormat::read(mapping->get_data() + sizeof(header) + header.path_length,
+                                        header.data_size, arena);
+      }
+    }
+  }
+}
+
+void
+SExprCache::store(const Pathname& filename, const char* data, size_t size,
+                  const lisp::Lisp* root)
+{
+  const std::string source_path = filename.get_sys_path();
+
+  std::string tree;
+  lisp::BinaryFormat::write(root, tree);
+
+  CacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, cache_magic, sizeof(cache_magic));
+  header.version     = cache_version;
+  header.byte_order  = cache_byte_order;
+  header.source_hash = hash_source(data, size);
+  header.source_size = static_cast<uint32_t>(size);
+  header.path_length = static_cast<uint32_t>(source_path.size());
+  header.data_size   = static_cast<uint32_t>(tree.size());
+
+  const std::string cache_path = get_cache_filename(filename).get_sys_path();
+  std::string tmp_path;
+
+  try
+  {
+    boost::filesystem::create_directories(boost::filesystem::path(cache_path).parent_path());
+  }
+  catch(const std::exception& err)
+  {
+    std::cout << "SExprCache: " << err.what() << std::endl;
+    return;
+  }
+
+  // writers of the same entry each get their own temp file, the
+  // last rename() wins
+  FILE* fp = System::create_temp_file(cache_path, tmp_path);
+  if (!fp)
+  {
+    std::cout << "SExprCache: couldn't write " << cache_path << ": " << strerror(errno) << std::endl;
+  }
+  else
+  {
+    bool success = 
+      fwrite(&header, sizeof(header), 1, fp) == 1 &&
+      fwrite(source_path.data(), 1, source_path.size(), fp) == source_path.size() &&
+      fwrite(tree.data(), 1, tree.size(), fp) == tree.size();
+
+    success = (fclose(fp) == 0) && success;
+
+#ifdef _WIN32
+    remove(cache_path.c_str());
+#endif
+    if (!success || rename(tmp_path.c_str(), cache_path.c_str()) != 0)
+    {
+      std::cout << "SExprCache: couldn't write " << cache_path << std::endl;
+      remove(tmp_path.c_str());
+    }
+  }
+}
+
+/* EOF */
@@ -0,0 +1,69 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef HEADER_WINDSTILLE_UTIL_SEXPR_CACHE_HPP
+#define HEADER_WINDSTILLE_UTIL_SEXPR_CACHE_HPP
+
+#include <stddef.h>
+
+#include "util/pathname.hpp"
+
+namespace lisp {
+class Arena;
+class Lisp;
+} // namespace lisp
+
+/**
+ * Keeps parsed s-expression files in the user directory in the
+ * lisp::BinaryFormat, so that later runs can skip lexing and parsing
+ * the text. A cache entry is only used when the hash and size of the
+ * source text still match, the text stays the format that gets
+ * edited.
+ */
+class SExprCache
+{
+public:
+  static void set_enabled(bool enabled);
+  static bool is_enabled();
+
+  /** Returns the tree cached for \a filename, allocated in \a arena,
+      or 0 when there is no valid cache entry for the text \a data */
+  static lisp::Lisp* load(const Pathname& filename, const char* data, size_t size,
+                          lisp::Arena& arena);
+
+  /** Writes \a root, parsed from the text \a data, to the cache,
+      errors are reported but not thrown as the cache is only an
+      optimization */
+  static void store(const Pathname& filename, const char* data, size_t size,
+                    const lisp::Lisp* root);
+
+private:
+  static bool s_enabled;
+
+  static Pathname get_cache_filename(const Pathname& filename);
+
+private:
+  SExprCache();
+  SExprCache(const SExprCache&);
+  SExprCache& operator=(const SExprCache&);
+};
+
+#endif
+
+/* EOF */
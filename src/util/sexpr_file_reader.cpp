@@ -16,9 +16,12 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <functional>
 #include <string.h>
 #include <stdint.h>
 
+#include "lisp/arena.hpp"
 #include "lisp/getters.hpp"
 #include "util/file_reader_impl.hpp"
 #include "util/sexpr_file_reader.hpp"
@@ -32,10 +35,22 @@ public:
   const lisp::Lisp* sexpr;
   bool  delete_sexpr;
 
+  /** Owner of the whole tree, shared by the sections read from it */
+  boost::shared_ptr<lisp::Arena> arena;
+
+  /** Subsections sorted by their interned name, built on the first
+      lookup in a large section of an Arena tree */
+  typedef std::vector<std::pair<const char*, size_t> > Index;
+  mutable Index index;
+  mutable bool  indexed;
+
   SExprFileReaderImpl(const lisp::Lisp* root_, const lisp::Lisp* sexpr_)
     : root(root_),
       sexpr(sexpr_), 
-      delete_sexpr(false)
+      delete_sexpr(false),
+      arena(),
+      index(),
+      indexed(false)
   {
     assert(sexpr && 
            sexpr->get_type() == lisp::Lisp::TYPE_LIST &&
@@ -45,7 +60,23 @@ public:
   SExprFileReaderImpl(const lisp::Lisp* sexpr_, bool delete_sexpr_) 
     : root(0),
       sexpr(sexpr_), 
-      delete_sexpr(delete_sexpr_)
+      delete_sexpr(delete_sexpr_),
+      arena(),
+      index(),
+      indexed(false)
+  {
+    assert(sexpr && 
+           sexpr->get_type() == lisp::Lisp::TYPE_LIST &&
+           sexpr->get_list_size() >= 1);
+  }
+
+  SExprFileReaderImpl(boost::shared_ptr<lisp::Arena> arena_, const lisp::Lisp* sexpr_) 
+    : root(0),
+      sexpr(sexpr_), 
+      delete_sexpr(false),
+      arena(arena_),
+      index(),
+      indexed(false)
   {
     assert(sexpr && 
            sexpr->get_type() == lisp::Lisp::TYPE_LIST &&
@@ -187,7 +218,7 @@ public:
     lisp::Lisp* cur = get_subsection(name);
     if (cur)
     {
-      v = SExprFileReader(cur);
+      v = make_section(cur);
       return true;
     }
     return false;
@@ -196,13 +227,40 @@ public:
   std::vector<FileReader> get_sections() const 
   {
     std::vector<FileReader> lst;
+    lst.reserve(get_num_sections());
     for(size_t i = 1; i < sexpr->get_list_size(); ++i)
     { // iterate over subsections
-      lst.push_back(SExprFileReader(sexpr->get_list_elem(i)));
+      lst.push_back(make_section(sexpr->get_list_elem(i)));
     }
     return lst;
   }
 
+  size_t get_num_sections() const
+  {
+    return sexpr->get_list_size() - 1;
+  }
+
+  boost::shared_ptr<FileReaderImpl> get_section(size_t i) const
+  {
+    return boost::shared_ptr<FileReaderImpl>(new SExprFileReaderImpl(arena, sexpr->get_list_elem(i + 1)));
+  }
+
+  void reuse_section(FileReaderImpl& reader, size_t i) const
+  {
+    SExprFileReaderImpl& section = static_cast<SExprFileReaderImpl&>(reader);
+    assert(!section.root && !section.delete_sexpr);
+
+    section.sexpr = sexpr->get_list_elem(i + 1);
+    section.arena = arena;
+    section.index.clear();
+    section.indexed = false;
+  }
+
+  void collect_strings(std::vector<std::string>& out) const
+  {
+    collect_strings(sexpr, out);
+  }
+
   std::vector<std::string> get_section_names() const 
   {
     std::vector<std::string> lst;
@@ -217,6 +275,14 @@ public:
   }
 
 private:
+  FileReader make_section(const lisp::Lisp* section) const
+  {
+    if (arena)
+      return SExprFileReader(arena, section);
+    else
+      return SExprFileReader(section);
+  }
+
   lisp::Lisp* get_subsection_item(const char* name) const
   {
     lisp::Lisp* sub = get_subsection(name);
@@ -229,15 +295,89 @@ private:
 
   lisp::Lisp* get_subsection(const char* name) const
   {
-    for(size_t i = 1; i < sexpr->get_list_size(); ++i)
-    { // iterate over subsections
-      lisp::Lisp* sub = sexpr->get_list_elem(i);
-      if (strcmp(sub->get_list_elem(0)->get_symbol(), name) == 0)
-        return sub;
+    if (arena)
+    {
+      // symbols of an Arena tree are interned, so a name that isn't
+      // interned doesn't occur at all and the others can be compared
+      // by pointer
+      const char* symbol = arena->find_symbol(name);
+      if (!symbol)
+      {
+        return 0;
+      }
+      else if (sexpr->get_list_size() <= 8)
+      {
+        for(size_t i = 1; i < sexpr->get_list_size(); ++i)
+        {
+          lisp::Lisp* sub = sexpr->get_list_elem(i);
+          if (sub->get_list_elem(0)->get_symbol() == symbol)
+            return sub;
+        }
+        return 0;
+      }
+      else
+      {
+        if (!indexed)
+          build_index();
+
+        // the index is sorted by position as well, so this finds the
+        // first subsection of that name, like the linear search
+        Index::const_iterator it = std::lower_bound(index.begin(), index.end(),
+                                                    std::make_pair(symbol, static_cast<size_t>(0)),
+                                                    IndexLess());
+        if (it != index.end() && it->first == symbol)
+          return sexpr->get_list_elem(it->second);
+        else
+          return 0;
+      }
+    }
+    else
+    {
+      for(size_t i = 1; i < sexpr->get_list_size(); ++i)
+      { // iterate over subsections
+        lisp::Lisp* sub = sexpr->get_list_elem(i);
+        if (strcmp(sub->get_list_elem(0)->get_symbol(), name) == 0)
+          return sub;
+      }
+      return 0;
     }
-    return 0;
   } 
 
+  static void collect_strings(const lisp::Lisp* lisp, std::vector<std::string>& out)
+  {
+    if (lisp->get_type() == lisp::Lisp::TYPE_STRING)
+    {
+      out.push_back(lisp->get_string());
+    }
+    else if (lisp->get_type() == lisp::Lisp::TYPE_LIST)
+    {
+      for(size_t i = 0; i < lisp->get_list_size(); ++i)
+        collect_strings(lisp->get_list_elem(i), out);
+    }
+  }
+
+  struct IndexLess
+  {
+    bool operator()(const Index::value_type& lhs, const Index::value_type& rhs) const
+    {
+      if (lhs.first != rhs.first)
+        return std::less<const char*>()(lhs.first, rhs.first);
+      else
+        return lhs.second < rhs.second;
+    }
+  };
+
+  void build_index() const
+  {
+    index.reserve(sexpr->get_list_size() - 1);
+    for(size_t i = 1; i < sexpr->get_list_size(); ++i)
+    {
+      index.push_back(std::make_pair(sexpr->get_list_elem(i)->get_list_elem(0)->get_symbol(), i));
+    }
+    std::sort(index.begin(), index.end(), IndexLess());
+    indexed = true;
+  }
+
 private:
   SExprFileReaderImpl(const SExprFileReaderImpl&);
   SExprFileReaderImpl& operator=(const SExprFileReaderImpl&);
@@ -248,6 +388,11 @@ SExprFileReader::SExprFileReader(const lisp::Lisp* sexpr, bool delete_sexpr)
 {
 }
 
+SExprFileReader::SExprFileReader(boost::shared_ptr<lisp::Arena> arena, const lisp::Lisp* sexpr)
+  : FileReader(boost::shared_ptr<FileReaderImpl>(new SExprFileReaderImpl(arena, sexpr)))
+{
+}
+
 SExprFileReader::SExprFileReader(const lisp::Lisp* root, const lisp::Lisp* sexpr)
   : FileReader(boost::shared_ptr<FileReaderImpl>(new SExprFileReaderImpl(root, sexpr)))
 {
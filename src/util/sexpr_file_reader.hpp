@@ -19,9 +19,12 @@
 #ifndef HEADER_WINDSTILLE_UTIL_SEXPR_FILE_READER_HPP
 #define HEADER_WINDSTILLE_UTIL_SEXPR_FILE_READER_HPP
 
+#include <boost/shared_ptr.hpp>
+
 #include "util/file_reader.hpp"
 
 namespace lisp {
+class Arena;
 class Lisp;
 } // namespace lisp
 
@@ -31,6 +34,10 @@ private:
 public:
   SExprFileReader(const lisp::Lisp* root, const lisp::Lisp* lisp);
   SExprFileReader(const lisp::Lisp* lisp, bool delete_sexpr = false);
+
+  /** \a lisp is allocated from \a arena, which is kept alive by the
+      reader and all sections read from it */
+  SExprFileReader(boost::shared_ptr<lisp::Arena> arena, const lisp::Lisp* lisp);
 };
 
 #endif
@@ -21,6 +21,14 @@
 #include <stdexcept>
 #include <sstream>
 #include <stdlib.h>
+#include <vector>
+#ifdef _WIN32
+#  include <fcntl.h>
+#  include <io.h>
+#  include <sys/stat.h>
+#else
+#  include <unistd.h>
+#endif
 #ifdef HAVE_BINRELOC
 #  include <binreloc.h>
 #endif
@@ -99,3 +107,56 @@ std::string System::find_default_userdir()
   }
 #endif
 }
+
+FILE*
+System::create_temp_file(const std::string& filename, std::string& tmp_filename)
+{
+  const std::string pattern = filename + ".XXXXXX";
+  std::vector<char> name(pattern.begin(), pattern.end());
+  name.push_back('\0');
+
+#ifdef _WIN32
+  // _mktemp_s() only picks the name, _O_EXCL makes sure that nobody
+  // else created the file in the meantime
+  if (_mktemp_s(&name[0], name.size()) != 0)
+    return 0;
+
+  const int fd = _open(&name[0], _O_CREAT | _O_EXCL | _O_WRONLY | _O_BINARY, _S_IREAD | _S_IWRITE);
+  if (fd < 0)
+    return 0;
+
+  FILE* fp = _fdopen(fd, "wb");
+  if (!fp)
+  {
+    _close(fd);
+    remove(&name[0]);
+  }
+#else
+  const int fd = mkstemp(&name[0]);
+  if (fd < 0)
+    return 0;
+
+  FILE* fp = fdopen(fd, "wb");
+  if (!fp)
+  {
+    close(fd);
+    remove(&name[0]);
+  }
+#endif
+
+  if (fp)
+    tmp_filename = &name[0];
+  return fp;
+}
+
+std::string
+System::flatten_path(const std::string& path)
+{
+  std::string name(path);
+  for(std::string::iterator i = name.begin(); i != name.end(); ++i)
+  {
+    if (*i == '/' || *i == '\\' || *i == ':')
+      *i = '_';
+  }
+  return name;
+}
@@ -19,6 +19,7 @@
 #ifndef HEADER_WINDSTILLE_UTIL_SYSTEM_HPP
 #define HEADER_WINDSTILLE_UTIL_SYSTEM_HPP
 
+#include <stdio.h>
 #include <string>
 
 /** 
@@ -29,6 +30,16 @@ class System
 public:
   static std::string find_default_datadir();
   static std::string find_default_userdir();
+
+  /** Creates and opens a new file next to \a filename for writing,
+      its name is unique, so that several threads or processes can
+      write a replacement for the same file at once. Returns 0 on
+      failure, the name is stored in \a tmp_filename. */
+  static FILE* create_temp_file(const std::string& filename, std::string& tmp_filename);
+
+  /** Replaces the directory separators and drive colons in \a path
+      with '_', so that the whole path can serve as a single file name */
+  static std::string flatten_path(const std::string& path);
 };
 
 #endif 
@@ -0,0 +1,235 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Round trip test for lisp::BinaryFormat: parses the given
+// s-expression files, or all of them below data/ when no file is
+// given, writes them in the binary format, reads them back and
+// compares the trees. Every truncation of the data must be rejected
+// and randomly corrupted data must not crash the reader.
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "lisp/arena.hpp"
+#include "lisp/binary_format.hpp"
+#include "lisp/lisp.hpp"
+#include "lisp/parser.hpp"
+#include "math/random.hpp"
+
+namespace {
+
+bool is_sexpr_file(const boost::filesystem::path& path)
+{
+  const std::string ext = path.extension().string();
+  return
+    ext == ".wst"       ||
+    ext == ".sprite"    ||
+    ext == ".particles" ||
+    ext == ".nav"       ||
+    ext == ".scm";
+}
+
+bool equal(const lisp::Lisp* lhs, const lisp::Lisp* rhs)
+{
+  if (lhs->get_type() != rhs->get_type())
+    return false;
+
+  switch(lhs->get_type())
+  {
+    case lisp::Lisp::TYPE_LIST:
+      if (lhs->get_list_size() != rhs->get_list_size())
+        return false;
+      for(size_t i = 0; i < lhs->get_list_size(); ++i)
+      {
+        if (!equal(lhs->get_list_elem(i), rhs->get_list_elem(i)))
+          return false;
+      }
+      return true;
+
+    case lisp::Lisp::TYPE_SYMBOL:
+      return strcmp(lhs->get_symbol(), rhs->get_symbol()) == 0;
+
+    case lisp::Lisp::TYPE_STRING:
+      return strcmp(lhs->get_string(), rhs->get_string()) == 0;
+
+    case lisp::Lisp::TYPE_INT:
+      return lhs->get_int() == rhs->get_int();
+
+    case lisp::Lisp::TYPE_FLOAT:
+      {
+        // bit for bit, the binary format must not round anything
+        const float lhs_value = lhs->get_float();
+        const float rhs_value = rhs->get_float();
+        return memcmp(&lhs_value, &rhs_value, sizeof(float)) == 0;
+      }
+
+    case lisp::Lisp::TYPE_BOOL:
+      return lhs->get_bool() == rhs->get_bool();
+
+    default:
+      return false;
+  }
+}
+
+/** Returns the number of nodes plus the length of all strings,
+    visiting the whole tree, so that a broken one shows up in valgrind
+    or the address sanitizer */
+size_t get_tree_size(const lisp::Lisp* lisp)
+{
+  switch(lisp->get_type())
+  {
+    case lisp::Lisp::TYPE_LIST:
+      {
+        size_t size = 1;
+        for(size_t i = 0; i < lisp->get_list_size(); ++i)
+          size += get_tree_size(lisp->get_list_elem(i));
+        return size;
+      }
+
+    case lisp::Lisp::TYPE_SYMBOL:
+      return 1 + strlen(lisp->get_symbol());
+
+    case lisp::Lisp::TYPE_STRING:
+      return 1 + strlen(lisp->get_string());
+
+    default:
+      return 1;
+  }
+}
+
+bool read_fails(const std::string& data, size_t size)
+{
+  lisp::Arena arena;
+  return lisp::BinaryFormat::read(data.data(), size, arena) == 0;
+}
+
+/** Returns the number of failed checks */
+int test_file(const std::string& filename, Random& random)
+{
+  lisp::Arena arena;
+  lisp::Lisp* root;
+  try
+  {
+    root = lisp::Parser::parse(filename, arena);
+  }
+  catch(std::exception& err)
+  {
+    std::cout << filename << ": skipped, " << err.what() << std::endl;
+    return 0;
+  }
+
+  std::string data;
+  lisp::BinaryFormat::write(root, data);
+
+  int errors = 0;
+
+  lisp::Arena read_arena;
+  const lisp::Lisp* read_root = lisp::BinaryFormat::read(data.data(), data.size(), read_arena);
+  if (!read_root)
+  {
+    std::cout << filename << ": reading the written data failed" << std::endl;
+    errors += 1;
+  }
+  else if (!equal(root, read_root))
+  {
+    std::cout << filename << ": tree differs after the round trip" << std::endl;
+    errors += 1;
+  }
+
+  // all prefixes of small files, evenly spaced ones of large files
+  const size_t step = std::max(static_cast<size_t>(1), data.size() / 1024);
+  for(size_t size = 0; size < data.size(); size += step)
+  {
+    if (!read_fails(data, size))
+    {
+      std::cout << filename << ": data truncated to " << size << " of "
+                << data.size() << " bytes was accepted" << std::endl;
+      errors += 1;
+      break;
+    }
+  }
+
+  if (!read_fails(data + '\0', data.size() + 1))
+  {
+    std::cout << filename << ": data with trailing garbage was accepted" << std::endl;
+    errors += 1;
+  }
+
+  size_t corrupt_size = 0;
+  for(int i = 0; i < 256; ++i)
+  {
+    std::string corrupt = data;
+    const int num_bytes = static_cast<int>(random.rand(1, 4));
+    for(int j = 0; j < num_bytes; ++j)
+    {
+      corrupt[static_cast<size_t>(random.rand(static_cast<long>(corrupt.size())))] = static_cast<char>(random.rand(256L));
+    }
+
+    lisp::Arena corrupt_arena;
+    const lisp::Lisp* corrupt_root = lisp::BinaryFormat::read(corrupt.data(), corrupt.size(), corrupt_arena);
+    if (corrupt_root)
+      corrupt_size += get_tree_size(corrupt_root);
+  }
+
+  std::cout << filename << ": " << data.size() << " bytes, "
+            << get_tree_size(root) << " tree size, "
+            << corrupt_size << " tree size from corrupted data" << std::endl;
+
+  return errors;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> files;
+  for(int i = 1; i < argc; ++i)
+  {
+    files.push_back(argv[i]);
+  }
+
+  if (files.empty())
+  {
+    for(boost::filesystem::recursive_directory_iterator i("data"), end; i != end; ++i)
+    {
+      if (is_regular_file(i->status()) && is_sexpr_file(i->path()))
+        files.push_back(i->path().string());
+    }
+  }
+
+  // the corruptions are the same on each run
+  Random random(5489UL);
+
+  int errors = 0;
+  for(std::vector<std::string>::iterator i = files.begin(); i != files.end(); ++i)
+  {
+    errors += test_file(*i, random);
+  }
+
+  std::cout << files.size() << " files, " << errors << " errors" << std::endl;
+  return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* EOF */
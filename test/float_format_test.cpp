@@ -0,0 +1,113 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Regression test for OutputBuffer::format_float(): every float
+// written by it has to be read back by the lisp::Lexer as exactly the
+// same float. Checks a sample of all bit patterns and the kind of
+// values that show up in data files.
+
+#include <iostream>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lisp/lexer.hpp"
+#include "util/output_buffer.hpp"
+
+namespace {
+
+int num_checked = 0;
+int num_errors  = 0;
+
+void check(float value)
+{
+  if (value != value || value > 3.4028235e38f || value < -3.4028235e38f)
+    return; // NaN and infinity are written as 0
+
+  char buffer[64];
+  const size_t length = OutputBuffer::format_float(value, buffer);
+
+  float result;
+  lisp::Lexer lexer(buffer, length);
+  switch(lexer.getNextToken())
+  {
+    case lisp::Lexer::TOKEN_INTEGER:
+      result = static_cast<float>(lexer.getInteger());
+      break;
+
+    case lisp::Lexer::TOKEN_REAL:
+      result = lexer.getReal();
+      break;
+
+    default:
+      result = value + 1.0f; // not a number at all, an error below
+      break;
+  }
+
+  num_checked += 1;
+
+  // -0 is written as 0, so compare values and not bits
+  if (result != value || lexer.getNextToken() != lisp::Lexer::TOKEN_EOF)
+  {
+    if (num_errors < 20)
+    {
+      std::cout << std::string(buffer, length) << ": read back as " << result
+                << " instead of " << value << std::endl;
+    }
+    num_errors += 1;
+  }
+}
+
+} // namespace
+
+int main()
+{
+  const float samples[] = {
+    0.0f, -0.0f, 0.1f, 0.5f, 1.25f, 3.14159f, -2.5f, 100.0f, 0.3f, 1.0f / 3.0f,
+    1.0e-7f, 1.0e-38f, 1.4e-45f, 123456.789f, 16777216.0f, 16777217.0f,
+    2147483520.0f, 2147483648.0f, 1.0e20f, 3.4028235e38f, -3.4028235e38f
+  };
+  for(size_t i = 0; i < sizeof(samples) / sizeof(*samples); ++i)
+  {
+    check(samples[i]);
+  }
+
+  // a spread over all bit patterns, the step is prime so that all
+  // mantissa bits vary
+  for(uint64_t bits = 0; bits <= 0xffffffffu; bits += 16411)
+  {
+    const uint32_t pattern = static_cast<uint32_t>(bits);
+    float value;
+    memcpy(&value, &pattern, sizeof(value));
+    check(value);
+  }
+
+  // coordinates, angles and colors as found in the data files
+  for(int i = -200000; i <= 200000; ++i)
+  {
+    check(static_cast<float>(i) * 0.01f);
+    check(static_cast<float>(i) / 64.0f);
+    check(static_cast<float>(i) / 1000.0f);
+  }
+
+  std::cout << num_checked << " floats, " << num_errors << " errors" << std::endl;
+  return num_errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* EOF */
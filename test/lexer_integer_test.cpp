@@ -0,0 +1,88 @@
+/*
+**  Windstille - A Sci-Fi Action-Adventure Game
+**  Copyright (C) 2011 Ingo Ruhnke <grumbel@gmx.de>
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Regression test for lisp::Lexer::getInteger(): the limits of int
+// are read back exactly, anything beyond them is a parse error
+// instead of wrapping around.
+
+#include <iostream>
+#include <limits.h>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lisp/lexer.hpp"
+
+namespace {
+
+int num_errors = 0;
+
+void check(const char* text, int expected)
+{
+  lisp::Lexer lexer(text, strlen(text));
+  if (lexer.getNextToken() != lisp::Lexer::TOKEN_INTEGER)
+  {
+    std::cout << text << ": not read as an integer" << std::endl;
+    num_errors += 1;
+  }
+  else if (lexer.getInteger() != expected)
+  {
+    std::cout << text << ": read back as " << lexer.getInteger()
+              << " instead of " << expected << std::endl;
+    num_errors += 1;
+  }
+}
+
+void check_out_of_range(const char* text)
+{
+  lisp::Lexer lexer(text, strlen(text));
+  try
+  {
+    lexer.getNextToken();
+    const int value = lexer.getInteger();
+    std::cout << text << ": read back as " << value << " instead of an error" << std::endl;
+    num_errors += 1;
+  }
+  catch(const std::runtime_error&)
+  {
+  }
+}
+
+} // namespace
+
+int main()
+{
+  check("0", 0);
+  check("-0", 0);
+  check("42", 42);
+  check("-42", -42);
+  check("2147483647", INT_MAX);
+  check("-2147483647", -INT_MAX);
+  check("-2147483648", INT_MIN);
+
+  check_out_of_range("2147483648");
+  check_out_of_range("-2147483649");
+  check_out_of_range("4294967296");
+  check_out_of_range("99999999999999999999");
+
+  std::cout << num_errors << " errors" << std::endl;
+  return num_errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* EOF */